@@ -0,0 +1,59 @@
+// Headless rendering throughput: creates a gui without windows or a GL context and renders a
+// dashboard (~100 cards) into framebuffers of several sizes with the software rasteriser.
+// Prints csv (one line per size) for CI to collect, exits non-zero if rendering fails.
+// Usage (from the repository root): bench_headless [frames]
+#include "z_nodus.c"
+
+#define BENCH_ROWS 12
+#define BENCH_CARDS_PER_ROW 8
+
+static double Bench_Ms(Uint64 start, Uint64 end)
+{
+    return (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 50;
+    if (frames <= 0) frames = 50;
+    if (!NU_Create_Gui_Headless("bench/assets/dashboard.xml", "bench/assets/dashboard.css", 1280, 720)) {
+        fprintf(stderr, "bench_headless: could not create the gui\n");
+        return 1;
+    }
+
+    // Fill the grid: clone the card along its row, then clone the row
+    Node* grid = NU_Get_Node_By_Id("grid");
+    Node* row = NU_CHILD(grid, 0);
+    NU_Begin_Update();
+    for (int i=1; i<BENCH_CARDS_PER_ROW; i++) NU_Clone_Node(NU_CHILD(row, 0), row, 1);
+    for (int i=1; i<BENCH_ROWS; i++) NU_Clone_Node(row, grid, 1);
+    NU_End_Update();
+    Node* window = NU_Get_Node_By_Id("window");
+
+    int sizes[][2] = { { 640, 360 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+    printf("bench,width,height,frames,first_frame_ms,ms_per_frame,mpix_per_s\n");
+    for (int s=0; s<4; s++)
+    {
+        int width = sizes[s][0], height = sizes[s][1];
+        NU_Framebuffer* fb = NU_Create_Framebuffer(width, height);
+
+        // First frame at a new size lays out again
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (fb == NULL || !NU_Render_To_Framebuffer(window, fb)) {
+            fprintf(stderr, "bench_headless: rendering %dx%d failed\n", width, height);
+            NU_Free_Framebuffer(fb);
+            NU_Quit();
+            return 1;
+        }
+        double firstMs = Bench_Ms(start, SDL_GetPerformanceCounter());
+
+        start = SDL_GetPerformanceCounter();
+        for (int f=0; f<frames; f++) NU_Render_To_Framebuffer(window, fb);
+        double frameMs = Bench_Ms(start, SDL_GetPerformanceCounter()) / frames;
+        printf("headless,%d,%d,%d,%.3f,%.3f,%.1f\n", width, height, frames, firstMs, frameMs, (double)width * height / (frameMs * 1000.0));
+        NU_Free_Framebuffer(fb);
+    }
+
+    NU_Quit();
+    return 0;
+}
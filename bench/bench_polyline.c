@@ -0,0 +1,91 @@
+// Dense polyline cost: draws a 1M-point series (non-decreasing x) into canvases of several
+// widths, with and without M4 decimation, and rasterises them with the software renderer.
+// Reports the line segments recorded (each one a quad, 6 vertices), the time the polyline
+// call takes and the time per rendered frame. Prints csv (one line per width and mode).
+// Usage (from the repository root): bench_polyline [frames]
+#include "z_nodus.c"
+
+#define BENCH_POINTS 1000000
+#define BENCH_HEIGHT 400
+
+static double Bench_Ms(Uint64 start, Uint64 end)
+{
+    return (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Random walk across the canvas, so every pixel column holds many points
+static void Bench_Fill_Series(float* xy, int width)
+{
+    float y = BENCH_HEIGHT * 0.5f;
+    u32 seed = 12345;
+    for (u32 i=0; i<BENCH_POINTS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        y += ((float)(seed >> 8) / (float)(1 << 24) - 0.5f) * 8.0f;
+        y = y < 10.0f ? 10.0f : (y > BENCH_HEIGHT - 10.0f ? BENCH_HEIGHT - 10.0f : y);
+        xy[i * 2] = (float)i * (float)width / (float)BENCH_POINTS;
+        xy[i * 2 + 1] = y;
+    }
+}
+
+static u32 Bench_Segments(int ctxID)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Acquire(ctxID);
+    if (ctx == NULL) return 0;
+    u32 segments = NU_Canvas_Front(ctx)->shapeLayer.primitives.size;
+    NU_Canvas_Release(ctx);
+    return segments;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 3;
+    if (frames <= 0) frames = 3;
+    if (!NU_Create_Gui_Headless("bench/assets/plot.xml", "bench/assets/plot.css", 1000, BENCH_HEIGHT)) {
+        fprintf(stderr, "bench_polyline: could not create the gui\n");
+        return 1;
+    }
+    Node* window = NU_Get_Node_By_Id("window");
+    int ctxID = NU_Get_Canvas_Ctx(NU_Get_Node_By_Id("plot"));
+    float* xy = malloc(sizeof(float) * 2 * BENCH_POINTS);
+    NU_RGB col = NU_RGB_From_Hex("#4fc3f7");
+
+    int widths[] = { 400, 1000, 2500 };
+    printf("bench,width,points,decimation,segments,vertices,polyline_ms,ms_per_frame\n");
+    for (int w=0; w<3; w++)
+    {
+        int width = widths[w];
+        NU_Framebuffer* fb = NU_Create_Framebuffer(width, BENCH_HEIGHT);
+
+        // First frame lays the canvas out at the new width, which decimation depends on
+        NU_Clear_Canvas(ctxID);
+        if (fb == NULL || !NU_Render_To_Framebuffer(window, fb)) {
+            fprintf(stderr, "bench_polyline: rendering at width %d failed\n", width);
+            NU_Free_Framebuffer(fb);
+            free(xy);
+            NU_Quit();
+            return 1;
+        }
+        Bench_Fill_Series(xy, width);
+
+        for (int decimate=1; decimate>=0; decimate--)
+        {
+            NU_Clear_Canvas(ctxID);
+            NU_Set_Canvas_Decimation(ctxID, decimate);
+            Uint64 start = SDL_GetPerformanceCounter();
+            NU_Polyline(ctxID, xy, BENCH_POINTS, 1.5f, col);
+            double polylineMs = Bench_Ms(start, SDL_GetPerformanceCounter());
+            u32 segments = Bench_Segments(ctxID);
+
+            start = SDL_GetPerformanceCounter();
+            for (int f=0; f<frames; f++) NU_Render_To_Framebuffer(window, fb);
+            double frameMs = Bench_Ms(start, SDL_GetPerformanceCounter()) / frames;
+            printf("polyline,%d,%d,%s,%u,%u,%.3f,%.3f\n", width, BENCH_POINTS, decimate ? "m4" : "off",
+                segments, segments * 6, polylineMs, frameMs);
+        }
+        NU_Free_Framebuffer(fb);
+    }
+
+    free(xy);
+    NU_Quit();
+    return 0;
+}
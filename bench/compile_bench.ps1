@@ -0,0 +1,22 @@
+# Builds every bench\*.c as a standalone console program in bench\bin (unity build of src\z_nodus.c, no dll)
+# Run from the repository root, then e.g. bench\bin\bench_headless.exe
+$srcInclude = "src"
+$sdlLib = "src\libraries\SDL3\lib" 
+$sdlInclude = "src\libraries\SDL3\include"
+$glewInclude = "src\libraries\glew\include"
+$glewLib = "src\libraries\glew\lib"
+$freetypeInclude = "src\libraries\freetype\include"
+$freetypeLib = "src\libraries\freetype\lib"
+New-Item -ItemType Directory -Force -Path "bench\bin" | Out-Null
+Get-ChildItem "bench\*.c" | ForEach-Object {
+    clang -std=c99 -O3 -fopenmp $_.FullName `
+    -I"$srcInclude" `
+    -I"$glewInclude" `
+    -I"$sdlInclude" `
+    -I"$freetypeInclude" `
+    -L"$glewLib" `
+    -L"$sdlLib" `
+    -L"$freetypeLib" `
+    -lglew32 -lSDL3 -lopengl32 -lgdi32 -lfreetype -ladvapi32 `
+    -o "bench\bin\$($_.BaseName).exe" -Wno-deprecated-declarations
+}
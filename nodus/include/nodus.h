@@ -14,6 +14,7 @@ extern "C" {
 
 // Opaque structs
 typedef struct NU_Stylesheet NU_Stylesheet;
+typedef struct NU_Framebuffer NU_Framebuffer;
 
 // Visible structs
 typedef enum NodeType
@@ -46,10 +47,29 @@ typedef struct NU_Nodelist
     Node** nodes;
 } NU_Nodelist;
 
+// Generational node reference (see NU_Get_Handle), a zeroed handle never resolves
+typedef struct NU_Handle
+{
+    uint32_t index;
+    uint32_t generation;
+} NU_Handle;
+
+// Live query results (see NU_Watch_Class)
+typedef struct NU_Query
+{
+    Node** nodes;
+    uint32_t count;
+    uint32_t generation; // changes whenever the matches do
+} NU_Query;
+
 typedef struct {
     float r, g, b;
 } NU_RGB;
 
+typedef struct {
+    float x, y, w, h;
+} NU_Rect;
+
 enum NU_Event_Type
 {
     NU_EVENT_ON_CLICK,
@@ -286,9 +306,20 @@ struct NU_Callback_Info
 
 // UI functions
 __declspec(dllimport) int NU_Create_Gui(const char* xml_filepath, const char* css_filepath);
+// No windows, GL context or event loop (NU_Running returns 0). The root window is width x height,
+// windows are drawn with NU_Render_To_Framebuffer
+__declspec(dllimport) int NU_Create_Gui_Headless(const char* xml_filepath, const char* css_filepath, int width, int height);
 __declspec(dllimport) void NU_Quit(void);
 __declspec(dllimport) int NU_Running(void);
 
+// CPU rendering. A framebuffer sized 0 x 0 follows the window's size, a sized one resizes headless
+// windows to its size (other windows always render at their own size). Pixels are RGBA8, row-major.
+// Inside NU_Begin_Update / NU_End_Update the framebuffer keeps its last frame (returns 0 if it has none)
+__declspec(dllimport) NU_Framebuffer* NU_Create_Framebuffer(int width, int height);
+__declspec(dllimport) int NU_Render_To_Framebuffer(Node* windowNode, NU_Framebuffer* framebuffer);
+__declspec(dllimport) const uint32_t* NU_Framebuffer_Pixels(NU_Framebuffer* framebuffer, int* width, int* height);
+__declspec(dllimport) void NU_Free_Framebuffer(NU_Framebuffer* framebuffer);
+
 // Error functions
 __declspec(dllimport) inline void NU_ClearErrors(void);
 __declspec(dllimport) const char* NU_GetNextError(void);
@@ -315,8 +346,21 @@ __declspec(dllimport) inline Node* NU_CHILD(Node* node, uint32_t childIndex);
 __declspec(dllimport) inline int NU_CHILD_COUNT(Node* node);
 __declspec(dllimport) inline Node* NU_CREATE_NODE(Node* parent, NodeType type);
 __declspec(dllimport) inline void NU_DELETE_NODE(Node* node);
+// Copies src (with its descendants if deep) as the last child of newParent, keeping its resolved style.
+// Canvases get their own context holding a copy of the source's drawing. Ids and events are not copied
+__declspec(dllimport) Node* NU_Clone_Node(Node* src, Node* newParent, int deep);
 __declspec(dllimport) inline void NU_SHIFT_NODE_IN_PARENT(Node* node, int index);
 __declspec(dllimport) inline void NU_REPARENT_NODE(Node* node, Node* newParent);
+// Reorders all children at once: child i becomes the child previously at permutation[i].
+// permutation must hold each index in [0, child count) once, returns 0 (unchanged) otherwise
+__declspec(dllimport) int NU_Reorder_Children(Node* parent, const int* permutation);
+// Stable references to nodes. A handle resolves to NULL once its node is deleted
+__declspec(dllimport) NU_Handle NU_Get_Handle(Node* node);
+__declspec(dllimport) Node* NU_Resolve_Handle(NU_Handle handle);
+// Frees deleted nodes and repacks node storage level by level, returning unused memory.
+// Moves every node, so Node* pointers and nodelists must be re-fetched (handles stay valid).
+// Do not call from an event callback
+__declspec(dllimport) void NU_Compact_Nodes(void);
 __declspec(dllimport) float NU_NODE_SCROLL(Node* node);
 __declspec(dllimport) inline const char* NU_INPUT_TEXT_CONTENT(Node* node);
 __declspec(dllimport) void NU_FOCUS_ON_INPUT(Node* node);
@@ -333,8 +377,44 @@ __declspec(dllimport) NU_Nodelist NU_Get_Children(Node* node);
 __declspec(dllimport) Node* NU_Get_First_Descendent_With_Class(Node* node, const char* class);
 __declspec(dllimport) int NU_Descends_From(Node* node, Node* ancestor);
 __declspec(dllimport) void NU_Nodelist_Free(NU_Nodelist* nodelist);
+// Live queries, updated as nodes are created, deleted or change class. Iterating one needs no
+// traversal or allocation. nodes is unordered and may move when generation changes, so re-read
+// it after any tree change. Watching the same class or tag twice shares one query, and each
+// watch needs its own NU_Unwatch
+__declspec(dllimport) NU_Query* NU_Watch_Class(const char* class);
+__declspec(dllimport) NU_Query* NU_Watch_Tag(NodeType type);
+__declspec(dllimport) void NU_Unwatch(NU_Query* query);
 __declspec(dllimport) void NU_Set_Class(Node* node, const char* class);
 
+// Batched updates (nestable). Between begin and end, restyles from NU_CREATE_NODE and NU_Set_Class
+// are deferred and applied once per node, and layout, hover and drawing are paused until the outermost end
+__declspec(dllimport) void NU_Begin_Update(void);
+__declspec(dllimport) void NU_End_Update(void);
+
+// Text content (NULL clears it). NU_Set_Text_Len copies len bytes, text needn't be terminated.
+// Only the changed node is measured again, setting identical text does nothing
+__declspec(dllimport) void NU_Set_Text(Node* node, const char* text);
+__declspec(dllimport) void NU_Set_Text_Len(Node* node, const char* text, uint32_t len);
+
+// Virtual rows. A vertical scroll container (a table or a vertical list) holding one row
+// (after an optional thead) stands in for rowCount rows. The row is the template for a small
+// pool of clones covering the viewport, bindCB fills a pooled row whenever it is given a new
+// row index. heightCB estimates each row's height up front and sizes the scrollbar.
+// Clones don't copy event registrations and table columns are sized from the pooled rows only.
+// A NULL bindCB ends virtual mode, deleting the container's row does too
+typedef float (*NU_Row_Height_Callback)(uint32_t rowIndex, void* args);
+typedef void (*NU_Row_Bind_Callback)(Node* row, uint32_t rowIndex, void* args);
+__declspec(dllimport) int NU_Set_Virtual_Rows(Node* container, uint32_t rowCount, NU_Row_Height_Callback heightCB, NU_Row_Bind_Callback bindCB, void* args);
+// Only new rows are estimated, so appending to a log is cheap. A container scrolled to the end stays there
+__declspec(dllimport) int NU_Set_Virtual_Row_Count(Node* container, uint32_t rowCount);
+// Binds the visible rows again (after the row data changed), optionally estimating every height again
+__declspec(dllimport) int NU_Refresh_Virtual_Rows(Node* container, int reestimateHeights);
+
+// Image functions (NU_Load_Image returns a handle holding one reference, nodes hold their own)
+__declspec(dllimport) int NU_Load_Image(const char* filepath);
+__declspec(dllimport) void NU_Release_Image(int imageHandle);
+__declspec(dllimport) void NU_Set_Node_Image(Node* node, int imageHandle);
+
 // Event functions
 __declspec(dllimport) void NU_Register_Event(
   Node* node, 
@@ -348,6 +428,27 @@ __declspec(dllimport) int NU_Get_Canvas_Ctx(Node* canvasNode);
 
 __declspec(dllimport) void NU_Clear_Canvas(int contextID);
 
+// Double buffered contexts record into a back buffer that is only shown once
+// NU_Canvas_Commit swaps it in, so a worker thread can build the next frame
+// while the UI thread keeps rendering the last committed one
+__declspec(dllimport) void NU_Set_Canvas_Double_Buffered(int contextID, int enabled);
+
+// A recording session: NU_Canvas_Begin holds the context for the calling thread until
+// NU_Canvas_Commit, so draw calls in between skip the context lookup and its global lock.
+// One session per thread, beginning another ends the current one
+__declspec(dllimport) void NU_Canvas_Begin(int contextID);
+
+__declspec(dllimport) void NU_Canvas_Commit(int contextID);
+
+// 2D affine transforms (x' = a*x + c*y + e, y' = b*x + d*y + f) apply to everything
+// drawn until the matching pop. Push returns an ID that NU_Canvas_Set_Transform can
+// later update to pan or zoom without redrawing the canvas
+__declspec(dllimport) int NU_Canvas_Push_Transform(int contextID, float a, float b, float c, float d, float e, float f);
+
+__declspec(dllimport) void NU_Canvas_Pop_Transform(int contextID);
+
+__declspec(dllimport) void NU_Canvas_Set_Transform(int contextID, int transformID, float a, float b, float c, float d, float e, float f);
+
 __declspec(dllimport) void NU_Render();
 
 __declspec(dllimport) NU_RGB NU_RGB_From_Hex(const char* hex);
@@ -400,6 +501,33 @@ __declspec(dllimport) void NU_Dashed_Line(
     NU_RGB col
 );
 
+// Bulk canvas functions (xy holds count interleaved x, y pairs)
+__declspec(dllimport) void NU_Polyline(
+    int contextID,
+    const float* xy, uint32_t count,
+    float thickness,
+    NU_RGB col
+);
+
+// Polylines with far more points than pixel columns and non-decreasing x are
+// reduced to the first, last, min and max point per column (enabled by default)
+__declspec(dllimport) void NU_Set_Canvas_Decimation(int contextID, int enabled);
+
+__declspec(dllimport) void NU_Points(
+    int contextID,
+    const float* xy, uint32_t count,
+    float radius,
+    NU_RGB col
+);
+
+__declspec(dllimport) void NU_Rects(
+    int contextID,
+    const NU_Rect* rects, uint32_t count,
+    float thickness,
+    NU_RGB border_col,
+    NU_RGB fill_col
+);
+
 __declspec(dllimport) void NU_Set_Canvas_Font(int contextID, const char* font_name);
 
 __declspec(dllimport) void NU_Text(
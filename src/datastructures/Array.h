@@ -68,6 +68,16 @@ void* Array_PushEmpty(Array* array)
     return dst;
 }
 
+// Grows capacity so that `additional` elements can be written past size without reallocating
+void Array_Reserve(Array* array, size_t additional)
+{
+    size_t required = array->size + additional;
+    if (required <= array->capacity) return;
+    if (array->capacity == 0) array->capacity = 1;
+    while (array->capacity < required) array->capacity *= 2;
+    array->data = realloc(array->data, array->capacity * array->elementSize);
+}
+
 void Array_DeleteBackfill(Array* array, size_t index)
 {
     if (index == array->size - 1) {
@@ -338,6 +338,24 @@ void Hashmap_Clear(Hashmap* hmap)
     hmap->maxProbes = 0;
 }
 
+// Rekeys every entry whose key is found in remap (old key -> new key, both keySize bytes).
+// Entries with keys missing from remap keep their key
+void Hashmap_RemapKeys(Hashmap* hmap, Hashmap* remap)
+{
+    if (hmap->itemCount == 0) return;
+    Hashmap rekeyed;
+    Hashmap_Init(&rekeyed, hmap->keySize, hmap->itemSize, hmap->capacity);
+    HashmapIterator it = Hashmap_CreateIterator(hmap);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        void* newKey = Hashmap_Get(remap, key);
+        Hashmap_Set(&rekeyed, newKey ? newKey : key, value);
+    }
+    free(hmap->occupancy);
+    free(hmap->data);
+    *hmap = rekeyed;
+}
+
 void Hashmap_Free(Hashmap* hmap)
 {
     free(hmap->occupancy);
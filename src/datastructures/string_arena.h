@@ -89,9 +89,10 @@ void StringArena_Free(StringArena* arena)
     free(arena->freelist);
 }
 
-char* StringArena_Add(StringArena* arena, const char* string)
+// Stores the first len bytes of string plus a terminator
+char* StringArena_AddLen(StringArena* arena, const char* string, uint32_t len)
 {
-    uint32_t string_len = (uint32_t)strlen(string) + 1;
+    uint32_t string_len = len + 1;
 
     // Search the freelist for space
     int space_index = -1;
@@ -156,18 +157,23 @@ char* StringArena_Add(StringArena* arena, const char* string)
     // Copy string into underlying char buffer
     char* chunk = arena->buffer_chunks[chunk_index];
     char* result = chunk + space_index;
-    memcpy(result, string, string_len);
+    memmove(result, string, len); // string may be a just released arena string
+    result[len] = '\0';
     arena->string_count++;
 
     // Return underlying string
     return result;
 }
 
-void StringArena_Delete(StringArena* arena, const char* string)
+char* StringArena_Add(StringArena* arena, const char* string)
+{
+    return StringArena_AddLen(arena, string, (uint32_t)strlen(string));
+}
+
+// Finds the chunk and offset of a string stored in the arena. Returns 0 if it isn't in the arena
+static int StringArena_Locate(StringArena* arena, const char* string, uint32_t* chunk_out, uint32_t* index_out)
 {
     uint32_t string_len = (uint32_t)strlen(string);
-    uint32_t string_index = UINT32_MAX;
-    uint32_t chunk_index = UINT32_MAX;
     for (uint32_t i=0; i<arena->chunks_used; i++) {
         char* chunk = arena->buffer_chunks[i];
 
@@ -177,41 +183,58 @@ void StringArena_Delete(StringArena* arena, const char* string)
             : (uint64_t)arena->first_chunk_size << (i - 1);
 
         // Check if string is inside chunk
-        if (string >= chunk && string + string_len <= chunk + chunk_size) {
-            string_index = (uint32_t)(string - chunk);
-            chunk_index = i;
-            break; 
+        if (string >= chunk && string + string_len < chunk + chunk_size) {
+            *index_out = (uint32_t)(string - chunk);
+            *chunk_out = i;
+            return 1;
         }
     }
+    return 0;
+}
 
-    if (string_index == UINT32_MAX) return; // String is not in the arena buffers
+// Index of the free element starting exactly at (chunk, index), or -1 (freelist is kept sorted)
+static int StringArena_FindFree(StringArena* arena, uint32_t chunk, uint32_t index)
+{
+    int lo = 0, hi = (int)arena->freelist_size - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        StringArenaFree* f = &arena->freelist[mid];
+        if (f->chunk == chunk && f->index == index) return mid;
+        if (f->chunk < chunk || (f->chunk == chunk && f->index < index)) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
 
+// Returns size bytes at (chunk, index) to the freelist, merging with adjacent free elements
+static void StringArena_Release(StringArena* arena, uint32_t chunk_index, uint32_t string_index, uint32_t size)
+{
     // Create new free struct
     StringArenaFree new_free;
     new_free.chunk = chunk_index;
     new_free.index = string_index;
-    new_free.size = string_len;
+    new_free.size = size;
+
+    // Update the freelist (sorted by chunk, then index): find the first entry after new_free
+    uint32_t insert_idx = 0;
+    uint32_t hi = arena->freelist_size;
+    while (insert_idx < hi) {
+        uint32_t mid = (insert_idx + hi) / 2;
+        StringArenaFree* f = &arena->freelist[mid];
+        if (f->chunk < new_free.chunk || (f->chunk == new_free.chunk && f->index < new_free.index)) insert_idx = mid + 1;
+        else hi = mid;
+    }
 
-    // Update the freelist
+    // Neighbors it touches
     int left_adjacent_touch_idx = -1;
     int right_adjacent_touch_idx = -1;
-    uint32_t insert_idx = 0;
-    for (uint32_t i=0; i<arena->freelist_size; i++) {
-        StringArenaFree* f = &arena->freelist[i];
-        if (f->chunk != new_free.chunk) continue;
-
-        // Touches left neighbor
-        if (f->index + f->size == new_free.index) left_adjacent_touch_idx = (int)i;
-        
-        // Touches right neighbor
-        if (new_free.index + new_free.size == f->index && new_free.chunk == f->chunk) right_adjacent_touch_idx = (int)i;
-
-        // For Case 4: first entry greater than new_free
-        if (new_free.chunk < f->chunk || (new_free.chunk == f->chunk && new_free.index < f->index)) {
-            insert_idx = i;
-            break;
-        }
-        insert_idx = i + 1; // if we reach the end, insert at the end
+    if (insert_idx > 0) {
+        StringArenaFree* f = &arena->freelist[insert_idx - 1];
+        if (f->chunk == new_free.chunk && f->index + f->size == new_free.index) left_adjacent_touch_idx = (int)insert_idx - 1;
+    }
+    if (insert_idx < arena->freelist_size) {
+        StringArenaFree* f = &arena->freelist[insert_idx];
+        if (f->chunk == new_free.chunk && new_free.index + new_free.size == f->index) right_adjacent_touch_idx = (int)insert_idx;
     }
 
     // Case 1: Free item touches two adjacent free items -> merge with left & remove right
@@ -249,4 +272,50 @@ void StringArena_Delete(StringArena* arena, const char* string)
         arena->freelist[insert_idx] = new_free;
         arena->freelist_size++;
     }
+}
+
+void StringArena_Delete(StringArena* arena, const char* string)
+{
+    uint32_t chunk_index, string_index;
+    if (!StringArena_Locate(arena, string, &chunk_index, &string_index)) return; // String is not in the arena buffers
+    StringArena_Release(arena, chunk_index, string_index, (uint32_t)strlen(string) + 1);
+    arena->string_count--;
+}
+
+// Replaces old (NULL or an arena string) with the first len bytes of string. The old slot is
+// reused when the new string fits or the free space right after it can be taken, otherwise it
+// is released and the string is added from the freelist. Returns the stored string
+char* StringArena_Replace(StringArena* arena, char* old, const char* string, uint32_t len)
+{
+    uint32_t chunk_index, string_index;
+    if (old == NULL || !StringArena_Locate(arena, old, &chunk_index, &string_index)) {
+        return StringArena_AddLen(arena, string, len);
+    }
+
+    uint32_t old_size = (uint32_t)strlen(old) + 1;
+    uint32_t new_size = len + 1;
+    if (new_size > old_size) {
+        // Grow into the free element that follows the slot
+        int free_index = StringArena_FindFree(arena, chunk_index, string_index + old_size);
+        uint32_t extra = new_size - old_size;
+        if (free_index == -1 || arena->freelist[free_index].size < extra) {
+            StringArena_Release(arena, chunk_index, string_index, old_size);
+            arena->string_count--;
+            return StringArena_AddLen(arena, string, len);
+        }
+        StringArenaFree* f = &arena->freelist[free_index];
+        f->index += extra;
+        f->size -= extra;
+        if (f->size == 0) {
+            arena->freelist_size--;
+            memmove(&arena->freelist[free_index], &arena->freelist[free_index + 1],
+                    (arena->freelist_size - free_index) * sizeof(StringArenaFree));
+        }
+    }
+    else if (new_size < old_size) {
+        StringArena_Release(arena, chunk_index, string_index + new_size, old_size - new_size);
+    }
+    memmove(old, string, len);
+    old[len] = '\0';
+    return old;
 }
\ No newline at end of file
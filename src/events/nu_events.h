@@ -44,6 +44,41 @@ void EventSystem_Free()
     Hashmap_Free(&GUI.eventSystem.on_key_up_events);
 }
 
+// Rekeys all event maps after node records moved (see TreeCompact)
+void EventSystem_Remap_Nodes(Hashmap* remap)
+{
+    Hashmap* callbackMaps[] = {
+        &GUI.eventSystem.on_click_events,
+        &GUI.eventSystem.on_input_changed_events,
+        &GUI.eventSystem.on_scroll_events,
+        &GUI.eventSystem.on_released_events,
+        &GUI.eventSystem.on_resize_events,
+        &GUI.eventSystem.on_mouse_down_events,
+        &GUI.eventSystem.on_mouse_up_events,
+        &GUI.eventSystem.on_mouse_down_outside_events,
+        &GUI.eventSystem.on_mouse_move_events,
+        &GUI.eventSystem.on_mouse_in_events,
+        &GUI.eventSystem.on_mouse_out_events,
+        &GUI.eventSystem.on_mouse_wheel_events,
+        &GUI.eventSystem.on_input_focus_events,
+        &GUI.eventSystem.on_input_defocus_events,
+        &GUI.eventSystem.on_key_down_events,
+        &GUI.eventSystem.on_key_up_events
+    };
+    for (u32 i=0; i<sizeof(callbackMaps) / sizeof(callbackMaps[0]); i++) {
+        Hashmap_RemapKeys(callbackMaps[i], remap);
+
+        // Callback infos carry the node handed to the callback
+        HashmapIterator it = Hashmap_CreateIterator(callbackMaps[i]);
+        void* key; void* value;
+        while (Hashmap_IteratorNext(&it, &key, &value)) {
+            struct NU_Callback_Info* info = value;
+            info->event.node = *(Node**)key;
+        }
+    }
+    Hashmap_RemapKeys(&GUI.eventSystem.node_resize_tracking, remap);
+}
+
 
 
 void NU_Internal_Register_Event(Node* node, void* args, NU_Callback callback, enum NU_Event_Type event_type)
@@ -176,10 +211,10 @@ void NU_Unregister_All_Iterated_Events(NodeP* node)
         Hashmap_Delete(&GUI.eventSystem.on_mouse_wheel_events, &node->node);
     }
     if (node->eventFlags & NU_EVENT_FLAG_ON_KEY_DOWN) {
-        Hashmap_Delete(&GUI.eventSystem.on_input_defocus_events, &node->node);
+        Hashmap_Delete(&GUI.eventSystem.on_key_down_events, &node->node);
     }
     if (node->eventFlags & NU_EVENT_FLAG_ON_KEY_UP) {
-        Hashmap_Delete(&GUI.eventSystem.on_input_defocus_events, &node->node);
+        Hashmap_Delete(&GUI.eventSystem.on_key_up_events, &node->node);
     }
 }
 
@@ -321,7 +356,7 @@ void CheckForResizeEvents()
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Get current dimensions
             void* dims_get = Hashmap_Get(resizeTrackingHmap, &node);
@@ -360,7 +395,7 @@ void TriggerAllMouseupEvents(float mouseX, float mouseY, int mouseBtn)
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Set calback event values and trigger
             cb_info->event.mouse.mouseBtn = mouseBtn;
@@ -390,7 +425,7 @@ void TriggerAllMouseMoveEvents(float mouseX, float mouseY, float mouseDeltaX, fl
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Set callback event values and trigger
             cb_info->event.mouse.mouseBtn = -1;
@@ -420,7 +455,7 @@ void TriggerAllMouseWheelEvents(float wheelDelta)
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Set calback event values and trigger
             cb_info->event.mouse.wheelDelta = wheelDelta;
@@ -445,7 +480,7 @@ void TriggerAllMouseDownOutsideEvents(float mouseX, float mouseY, int mouseBtn)
 
             // Skip if node was recently deleted OR node is hovered
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP) || node == &GUI.hovered_node->node) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP) || node == &GUI.hovered_node->node) continue;
 
             // Set calback event values and trigger
             cb_info->event.mouse.mouseBtn = mouseBtn;
@@ -475,7 +510,7 @@ void TriggerAllOnKeyDownEvents(SDL_Keycode keycode, bool repeat)
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Set calback event values and trigger
             cb_info->event.keypress.keycode = keycode;
@@ -501,7 +536,7 @@ void TriggerAllOnKeyUpEvents(SDL_Keycode keycode, bool repeat)
 
             // Skip if node was recently deleted
             NodeP* nodeP = NODEP_OF(node);
-            if (NodeStateDeleted(nodeP)) continue;
+            if (TreeNodeDetached(&GUI.tree, nodeP)) continue;
 
             // Set calback event values and trigger
             cb_info->event.keypress.keycode = keycode;
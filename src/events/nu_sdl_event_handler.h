@@ -19,14 +19,18 @@ bool EventWatcher(void* data, SDL_Event* event)
     // --- Resized window -> redraw -------------------------------------------------------
     // ------------------------------------------------------------------------------------
     if (event->type == SDL_EVENT_WINDOW_RESIZED) {
-        NU_Layout();
-        CheckForResizeEvents();
-        NU_Draw();
+        if (GUI.updateDepth > 0) GUI.awaiting_redraw = true;
+        else {
+            NU_Layout();
+            CheckForResizeEvents();
+            NU_Draw();
+        }
     }
     // ------------------------------------------------------------------------------------
     // --- App render event called -> redraw ----------------------------------------------
     // ------------------------------------------------------------------------------------
     else if (event->type == GUI.SDL_CUSTOM_RENDER_EVENT) {
+        if (event->user.code == NU_RENDER_EVENT_NODES_CHANGED) NU_Scroll_Caches_Invalidate_All();
         GUI.awaiting_redraw = true;
     }
     // ------------------------------------------------------------------------------------
@@ -169,13 +173,14 @@ bool EventWatcher(void* data, SDL_Event* event)
             float thumbY = trackY + scrollbarStyle->trackPadTop + node->scrollV * scrollTravel;
             float trackTop = trackY + scrollbarStyle->trackPadTop;
             float dragDist = (mouseY - GUI.v_scroll_thumb_grab_offset) - trackTop;
+            float prevScrollOffset = NU_Vertical_Scroll_Offset(node);
             node->scrollV = dragDist / (usableTrackHeight - thumbHeight);
             node->scrollV = min(max(node->scrollV, 0.0f), 1.0f); // Clamp to range [0,1]
 
             TriggerOnScrollEvent(node);
 
-            // must redraw later
-            GUI.awaiting_redraw = true;
+            // must redraw later (cached content only needs compositing)
+            if (!NU_Scroll_Cached(node, prevScrollOffset)) GUI.awaiting_redraw = true;
         }
 
         // check for mouse move events
@@ -374,10 +379,11 @@ bool EventWatcher(void* data, SDL_Event* event)
             Node* n = &node->node;
             float trackHeight = n->height - n->borderTop - n->borderBottom;
             float usableTrackHeight = trackHeight - scrollbarStyle->trackPadTop - scrollbarStyle->trackPadBottom;
+            float prevScrollOffset = NU_Vertical_Scroll_Offset(node);
             node->scrollV -= event->wheel.y * (usableTrackHeight / node->node.contentHeight) * 0.2f;
             node->scrollV = min(max(node->scrollV, 0.0f), 1.0f); // Clamp to range [0,1]
             TriggerOnScrollEvent(node);
-            GUI.awaiting_redraw = true;
+            if (!NU_Scroll_Cached(node, prevScrollOffset)) GUI.awaiting_redraw = true;
         }
 
         // Triggger mouse wheel events
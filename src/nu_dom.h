@@ -1,8 +1,10 @@
 #pragma once
 
+// Releases everything a deleted node holds, called by the sweep
 void NU_DissociateNode(NodeP* node)
 {
     NU_Unregister_All_Non_Iterated_Events(node);
+    NU_Unregister_All_Iterated_Events(node);
 
     switch(node->type) {
         case NU_WINDOW:
@@ -17,8 +19,30 @@ void NU_DissociateNode(NodeP* node)
             Container_Remove(&GUI.textInputs,node->typeData.input.textInputHandle);
             break;
         default:
+            ImageResourceManager_SetNodeImage(&GUI.imageResourceManager, node, 0);
             break;
     }
+    if (GUI.scrollCaches.itemCount > 0) {
+        NU_Scroll_Cache_Delete(node);
+    }
+    if (GUI.layerCaches.itemCount > 0) {
+        NU_Layer_Cache_Delete(node);
+    }
+    if (node->layoutFlags & VIRTUAL_ROWS) {
+        VirtualRows_Delete(node);
+    }
+    NodeIndex_Remove(&GUI.nodeIndex, node);
+    NodeHandles_Release(&GUI.nodeHandles, node);
+    NU_Invalidate_Text_Metrics(node);
+    if (node->node.textContent != NULL) {
+        StringArena_Delete(&GUI.nodeTextArena, node->node.textContent);
+    }
+    if (node->stateFlags & STATE_FLAG_STYLE_PENDING) {
+        Set_Delete(&GUI.pendingStyleNodes, &node);
+    }
+    if (GUI.layoutDirtyRoots.itemCount > 0) {
+        Set_Delete(&GUI.layoutDirtyRoots, &node);
+    }
     if (node->id != NULL) {
         Stringmap_Delete(&GUI.id_node_map, node->id);
     }
@@ -37,4 +61,237 @@ void NU_DissociateNode(NodeP* node)
     if (node == GUI.focused_node) {
         GUI.focused_node = NULL;
     }
-}
\ No newline at end of file
+}
+
+// Applies the node's stylesheet style plus the pseudo style of its current mouse state
+void NU_Restyle_Node(NodeP* node)
+{
+    NU_Apply_Stylesheet_To_Node(node, &GUI.stylesheet);
+    if (node == GUI.scroll_mouse_down_node) {
+        NU_Apply_Pseudo_Style_To_Node(node, &GUI.stylesheet, PSEUDO_PRESS);
+    } else if (node == GUI.hovered_node) {
+        NU_Apply_Pseudo_Style_To_Node(node, &GUI.stylesheet, PSEUDO_HOVER);
+    }
+}
+
+// Restyles the node now, or once at the end of the current update
+void NU_Request_Restyle(NodeP* node)
+{
+    if (GUI.updateDepth == 0) {
+        NU_Restyle_Node(node);
+        return;
+    }
+    if (node->stateFlags & STATE_FLAG_STYLE_PENDING) return;
+    node->stateFlags |= STATE_FLAG_STYLE_PENDING;
+    Set_Insert(&GUI.pendingStyleNodes, &node);
+}
+
+// Gives a node copied by TreeCloneNode its own resources (text, image reference, input buffer,
+// canvas context with a copy of the source's drawing). Ids stay unique, so they aren't copied
+void NU_Clone_Node_Resources(NodeP* clone, NodeP* src)
+{
+    NodeIndex_Add(&GUI.nodeIndex, clone);
+    clone->id = NULL;
+    clone->stateFlags = 0;
+    clone->eventFlags = 0;
+    clone->scrollX = 0.0f;
+    clone->scrollV = 0.0f;
+    clone->layoutFlags &= ~VIRTUAL_ROWS; // the pool belongs to the source
+    if (src->node.textContent != NULL) {
+        clone->node.textContent = StringArena_Add(&GUI.nodeTextArena, src->node.textContent);
+    }
+
+    switch(clone->type) {
+        case NU_CANVAS:
+            NU_Canvas_Clone_Context(clone, src);
+            break;
+        case NU_INPUT: {
+            InputText inputText;
+            InputText_Init(&inputText);
+            clone->typeData.input.textInputHandle = Container_Add(&GUI.textInputs, &inputText);
+            InputText* srcText = Container_Get(&GUI.textInputs, src->typeData.input.textInputHandle);
+            InputText* cloneText = Container_Get(&GUI.textInputs, clone->typeData.input.textInputHandle);
+            cloneText->type = srcText->type;
+            if (srcText->numBytes > 0) {
+                InputText_SetText(cloneText, clone, Stylesheet_Get_Font(&GUI.stylesheet, clone->fontId), srcText->buffer);
+            }
+            break;
+        }
+        default:
+            clone->typeData.image.imageHandle = 0;
+            ImageResourceManager_SetNodeImage(&GUI.imageResourceManager, clone, src->typeData.image.imageHandle);
+            break;
+    }
+
+    // Copied styles may include the source's pseudo styles or a restyle still pending
+    if (src == GUI.hovered_node || src == GUI.mouse_down_node || src == GUI.focused_node || 
+        src == GUI.scroll_mouse_down_node || src->stateFlags & STATE_FLAG_STYLE_PENDING) {
+        NU_Request_Restyle(clone);
+    }
+}
+
+void NU_Internal_Begin_Update()
+{
+    GUI.updateDepth++;
+}
+
+void NU_Internal_End_Update()
+{
+    if (GUI.updateDepth == 0) return;
+    if (--GUI.updateDepth > 0) return;
+
+    // Apply each deferred restyle once
+    SetIterator it = Set_CreateIterator(&GUI.pendingStyleNodes);
+    void* key;
+    while (Set_IteratorNext(&it, &key)) {
+        NodeP* node = *(NodeP**)key;
+        node->stateFlags &= ~STATE_FLAG_STYLE_PENDING;
+        NU_Restyle_Node(node);
+    }
+    Set_Clear(&GUI.pendingStyleNodes);
+
+    // Layout, hover and resize events run once on the next frame
+    GUI.awaiting_redraw = true;
+}
+
+static bool NU_Node_In_Subtree(NodeP* node, NodeP* subtreeRoot)
+{
+    for (; node != NULL; node = node->parent) {
+        if (node == subtreeRoot) return true;
+    }
+    return false;
+}
+
+// Detaches node's subtree in O(depth), its nodes are torn down later by NU_Sweep_Deleted_Nodes
+void NU_Internal_Delete_Node(NodeP* node)
+{
+    if (node->parent == NULL || NodeStateDeleted(node)) return;
+
+    // Rows of a virtual container are its pool, deleting one ends virtual mode
+    if (node->parent->layoutFlags & VIRTUAL_ROWS && node->type != NU_THEAD) {
+        VirtualRows_End(node->parent);
+        if (node->parent == NULL) return; // a pooled clone, deleted with the pool
+    }
+
+    // Pseudo nodes must not point into the detached subtree
+    NodeP** pseudoNodes[] = {
+        &GUI.hovered_node, &GUI.prev_hovered_node, &GUI.mouse_down_node, &GUI.prev_mouse_down_node,
+        &GUI.focused_node, &GUI.prev_focused_node, &GUI.scroll_hovered_node, &GUI.scroll_mouse_down_node
+    };
+    for (int i=0; i<8; i++) {
+        if (NU_Node_In_Subtree(*pseudoNodes[i], node)) *pseudoNodes[i] = NULL;
+    }
+
+    NU_Scroll_Cache_Invalidate(node->parent);
+    NodeIndex_Detach(&GUI.nodeIndex, node);
+    TreeDeleteNode(&GUI.tree, node);
+    GUI.awaiting_redraw = true;
+}
+
+// Replaces a node's text (NULL clears it). The node's arena slot is reused when possible and
+// only this node is measured again on the next layout
+void NU_Internal_Set_Text(NodeP* node, const char* text, u32 len)
+{
+    char* current = node->node.textContent;
+    if (text == NULL) {
+        if (current == NULL) return;
+        StringArena_Delete(&GUI.nodeTextArena, current);
+        node->node.textContent = NULL;
+    }
+    else {
+        const char* nul = memchr(text, 0, len); // the arena slot is measured with strlen, stop at an embedded NUL
+        if (nul != NULL) len = (u32)(nul - text);
+        if (current != NULL && strncmp(current, text, len) == 0 && current[len] == '\0') return; // unchanged
+        node->node.textContent = StringArena_Replace(&GUI.nodeTextArena, current, text, len);
+    }
+    NU_Invalidate_Text_Metrics(node);
+    NU_Request_Layout(node);
+}
+
+#define NU_SWEEP_BUDGET 8192 // deleted nodes torn down per frame
+
+// Tears down and frees up to budget deleted nodes (0 = all). Must not run while event maps are iterated
+void NU_Sweep_Deleted_Nodes(u32 budget)
+{
+    if (GUI.tree.deleteStack.size == 0) return;
+    TreeSweepDeleted(&GUI.tree, budget, NU_DissociateNode);
+}
+
+// Frees deleted nodes now and moves all live nodes into compact level ordered storage.
+// Every reference the GUI holds is fixed up, raw Node* held by the application are not
+void NU_Internal_Compact_Nodes()
+{
+    NU_Sweep_Deleted_Nodes(0);
+
+    Hashmap remap;
+    Hashmap_Init(&remap, sizeof(NodeP*), sizeof(NodeP*), GUI.tree.nodeCount * 2);
+    SDL_LockMutex(GUI.canvasMutex); // canvas workers look up contexts (and their nodes)
+    TreeCompact(&GUI.tree, &remap);
+
+    // Pseudo nodes
+    GUI.hovered_node = TreeRemapNode(&remap, GUI.hovered_node);
+    GUI.prev_hovered_node = TreeRemapNode(&remap, GUI.prev_hovered_node);
+    GUI.mouse_down_node = TreeRemapNode(&remap, GUI.mouse_down_node);
+    GUI.prev_mouse_down_node = TreeRemapNode(&remap, GUI.prev_mouse_down_node);
+    GUI.focused_node = TreeRemapNode(&remap, GUI.focused_node);
+    GUI.prev_focused_node = TreeRemapNode(&remap, GUI.prev_focused_node);
+    GUI.scroll_hovered_node = TreeRemapNode(&remap, GUI.scroll_hovered_node);
+    GUI.scroll_mouse_down_node = TreeRemapNode(&remap, GUI.scroll_mouse_down_node);
+
+    // Node keyed maps
+    Hashmap_RemapKeys(&GUI.scrollCaches, &remap);
+    Hashmap_RemapKeys(&GUI.layerCaches, &remap);
+    Hashmap_RemapKeys(&GUI.winManager.clipMap, &remap);
+    Hashmap_RemapKeys(&GUI.textMetrics, &remap);
+    VirtualRows_Remap(&remap);
+    EventSystem_Remap_Nodes(&remap);
+    NodeHandles_Remap(&GUI.nodeHandles, &remap);
+    if (GUI.pendingStyleNodes.itemCount > 0) {
+        Set pending; Set_Init(&pending, sizeof(NodeP*), GUI.pendingStyleNodes.capacity);
+        SetIterator it = Set_CreateIterator(&GUI.pendingStyleNodes);
+        void* key;
+        while (Set_IteratorNext(&it, &key)) {
+            NodeP* node = TreeRemapNode(&remap, *(NodeP**)key);
+            Set_Insert(&pending, &node);
+        }
+        Set_Free(&GUI.pendingStyleNodes);
+        GUI.pendingStyleNodes = pending;
+    }
+
+    // Ids and the class/type index
+    NodeIndex_Rebuild(&GUI.nodeIndex, GUI.tree.root);
+    DepthFirstSearch dfs = DepthFirstSearch_Create(GUI.tree.root);
+    NodeP* node;
+    while (DepthFirstSearch_Next(&dfs, &node)) {
+        if (node->id != NULL) Stringmap_Set(&GUI.id_node_map, node->id, &node);
+    }
+    DepthFirstSearch_Free(&dfs);
+
+    // Window node lists, drawlists are regenerated on the next frame
+    Array* nodeArrays[] = { &GUI.winManager.windowNodes, &GUI.winManager.absoluteRootNodes };
+    for (int a=0; a<2; a++) {
+        for (u32 i=0; i<nodeArrays[a]->size; i++) {
+            NodeP** entry = Array_Get(nodeArrays[a], i);
+            *entry = TreeRemapNode(&remap, *entry);
+        }
+    }
+    for (int i=0; i<GUI.winManager.windows.size; i++) {
+        NU_Window* window = Container_GetAt(&GUI.winManager.windows, i);
+        Array_Clear(&window->drawlist.drawNodes);
+        Array_Clear(&window->drawlist.clippedDrawNodes);
+        Array_Clear(&window->drawlist.scrollCacheNodes);
+        Array_Clear(&window->drawlist.layerNodes);
+    }
+    Array_Clear(&GUI.layoutScrollAutoNodes);
+    Set_Clear(&GUI.layoutDirtyRoots); // covered by the full layout requested below
+
+    // Canvas contexts
+    for (int i=0; i<GUI.canvasContexts.size; i++) {
+        NU_Canvas_Context* ctx = *(NU_Canvas_Context**)Container_GetAt(&GUI.canvasContexts, i);
+        ctx->node = TreeRemapNode(&remap, ctx->node);
+    }
+    SDL_UnlockMutex(GUI.canvasMutex);
+
+    Hashmap_Free(&remap);
+    GUI.awaiting_redraw = true;
+}
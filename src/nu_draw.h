@@ -118,7 +118,7 @@ void NU_DrawInputNodeContent(NodeP* node, float z, float winWidth, float winHeig
 
 void NU_DrawCanvasContent(NodeP* canvas_node, float winW, float winH, NU_ClipBounds* clip)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, canvas_node->typeData.canvas.ctxHandle);  
+    NU_Canvas_Context* ctx = NU_Canvas_Get(canvas_node->typeData.canvas.ctxHandle);  
     if (ctx == NULL) return;
     
     float offsetX = roundf(canvas_node->node.x + canvas_node->node.borderLeft + canvas_node->node.padLeft);
@@ -127,35 +127,70 @@ void NU_DrawCanvasContent(NodeP* canvas_node, float winW, float winH, NU_ClipBou
     float bottom = canvas_node->node.y + canvas_node->node.height - canvas_node->node.borderBottom - canvas_node->node.padBottom;
     float left   = canvas_node->node.x + canvas_node->node.borderLeft + canvas_node->node.padLeft;
     float right  = canvas_node->node.x + canvas_node->node.width - canvas_node->node.borderRight - canvas_node->node.padRight;
+    int cacheW = (int)ceilf(right - left);
+    int cacheH = (int)ceilf(bottom - top);
+    if (cacheW <= 0 || cacheH <= 0) return;
     if (clip) {
         top    = fmax_fast(top, clip->top);
-        bottom = fmax_fast(bottom, clip->bottom);
+        bottom = fmin_fast(bottom, clip->bottom);
         left   = fmax_fast(left, clip->left);
-        right  = fmax_fast(right, clip->right);
+        right  = fmin_fast(right, clip->right);
     }
     ctx->canvasWidth = canvas_node->node.width;
     ctx->canvasHeight = canvas_node->node.height;
 
-    // Draw canvas shape layer
-    Draw_Clipped_Vertex_RGB_List(
-        &ctx->shapeLayer.vertices, &ctx->shapeLayer.indices,
-        winW, winH, 
-        offsetX, offsetY,
-        top, bottom, left, right 
-    );
-
-    // Draw each canvas text layer
-    for (int l=0; l<ctx->textLayerIndex+1; l++) {
-        CanvasTextLayer* layer = Array_Get(&ctx->textLayers, l);
-        NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, layer->fontID);
-        NU_Render_Text(
-            &layer->vertices, &layer->indices, 
-            font, 
-            winW, winH, 
-            offsetX, offsetY,
-            top, bottom, left, right
+    // Re-render the cached content box only if the content or its size changed
+    SDL_LockMutex(ctx->swapMutex);
+    if (CanvasRenderCache_Resize(&ctx->cache, cacheW, cacheH) || SDL_GetAtomicInt(&ctx->dirty)) 
+    {
+        SDL_SetAtomicInt(&ctx->dirty, 0);
+        CanvasDrawBuffer* buf = NU_Canvas_Front(ctx);
+        float cacheWf = (float)cacheW;
+        float cacheHf = (float)cacheH;
+        float* transforms = malloc(sizeof(float) * 6 * buf->transforms.size);
+        NU_Canvas_Resolve_Transforms(buf, transforms);
+        GLint prevFramebuffer = CanvasRenderCache_Begin(&ctx->cache);
+
+        // Draw canvas shape layer (1 draw call per transform range)
+        Draw_Canvas_Mesh(
+            &buf->shapeLayer.vertices, &buf->shapeLayer.indices,
+            &buf->shapeLayer.meshRanges, transforms,
+            cacheWf, cacheHf, 
+            0.0f, 0.0f,
+            0.0f, cacheHf, 0.0f, cacheWf 
+        );
+
+        // Draw canvas SDF rects and lines (1 draw call per transform range)
+        Draw_Canvas_Primitives(
+            &buf->shapeLayer.primitives,
+            &buf->shapeLayer.primitiveRanges, transforms,
+            cacheWf, cacheHf, 
+            0.0f, 0.0f,
+            0.0f, cacheHf, 0.0f, cacheWf 
         );
+
+        // Draw each canvas text layer
+        for (int l=0; l<buf->textLayerCount; l++) {
+            CanvasTextLayer* layer = Array_Get(&buf->textLayers, l);
+            NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, layer->fontID);
+            Draw_Canvas_Text(
+                &layer->vertices, &layer->indices, 
+                &layer->ranges, transforms,
+                font, 
+                cacheWf, cacheHf, 
+                0.0f, 0.0f,
+                0.0f, cacheHf, 0.0f, cacheWf
+            );
+        }
+        free(transforms);
+
+        CanvasRenderCache_End(&ctx->cache, prevFramebuffer, winW, winH);
     }
+    SDL_UnlockMutex(ctx->swapMutex);
+
+    // Composite the cached content (1 draw call)
+    float z = (float)(canvas_node->layer) + 0.005f;
+    NU_Draw_Canvas_Cache(&ctx->cache, offsetX, offsetY, z, winW, winH, top, bottom, left, right);
 }
 
 inline int NodeNotVisibleInWindow(NodeP* node, int winW, int winH) 
@@ -165,7 +200,570 @@ inline int NodeNotVisibleInWindow(NodeP* node, int winW, int winH)
     return (right < 0 || bottom < 0 || node->node.x > winW || node->node.y > winH);
 }
 
-void NU_GenerateDrawlists()
+// ------------------------------
+// --- Scroll content caching ---
+// ------------------------------
+static ScrollRenderCache* NU_Scroll_Cache_Get(NodeP* node)
+{
+    ScrollRenderCache** found = Hashmap_Get(&GUI.scrollCaches, &node);
+    return found ? *found : NULL;
+}
+
+static void ScrollRenderCache_Free(ScrollRenderCache* cache)
+{
+    for (u32 i=0; i<cache->tiles.size; i++) {
+        ScrollTile* tile = Array_Get(&cache->tiles, i);
+        CanvasRenderCache_Free(&tile->target);
+    }
+    Array_Free(&cache->tiles);
+    free(cache);
+}
+
+void NU_Scroll_Cache_Delete(NodeP* node)
+{
+    ScrollRenderCache* cache = NU_Scroll_Cache_Get(node);
+    if (cache == NULL) return;
+    ScrollRenderCache_Free(cache);
+    Hashmap_Delete(&GUI.scrollCaches, &node);
+}
+
+void NU_Scroll_Caches_Free()
+{
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.scrollCaches);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        ScrollRenderCache_Free(*(ScrollRenderCache**)value);
+    }
+    Hashmap_Free(&GUI.scrollCaches);
+}
+
+// Marks the tiles of every scroll cache containing node (or of node itself) for redrawing.
+// Call when a node's style, content or children change
+void NU_Scroll_Cache_Invalidate(NodeP* node)
+{
+    if (GUI.scrollCaches.itemCount == 0) return;
+    for (; node != NULL; node = node->parent) {
+        if (!(node->layoutFlags & OVERFLOW_VERTICAL_SCROLL)) continue;
+        ScrollRenderCache* cache = NU_Scroll_Cache_Get(node);
+        if (cache != NULL) cache->dirty = true;
+    }
+}
+
+// user.code of the render event pushed by NU_Render, canvas commits push 0
+#define NU_RENDER_EVENT_NODES_CHANGED 1
+
+// For changes made without telling the GUI which nodes they touched (see NU_Render)
+void NU_Scroll_Caches_Invalidate_All()
+{
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.scrollCaches);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        (*(ScrollRenderCache**)value)->dirty = true;
+    }
+}
+
+// Nodes with their own clipping, focus state, canvas cache or out of flow position
+// can't be drawn into a cached texture with the rest of their subtree
+static inline bool NU_Node_Cacheable(NodeP* node)
+{
+    return node->type != NU_INPUT && node->type != NU_CANVAS && node->type != NU_WINDOW &&
+        !(node->layoutFlags & (OVERFLOW_VERTICAL_SCROLL | OVERFLOW_HORIZONTAL_SCROLL | POSITION_ABSOLUTE));
+}
+
+static bool NU_Scroll_Subtree_Cacheable(NodeP* scrollNode)
+{
+    if (scrollNode->layoutFlags & (OVERFLOW_HORIZONTAL_SCROLL | VIRTUAL_ROWS)) return false; // virtual rows rebind as they scroll
+    if (scrollNode->firstChild->type == NU_THEAD) return false;
+
+    bool cacheable = true;
+    Array stack; Array_Init(&stack, sizeof(NodeP*), 32);
+    Array_Push(&stack, &scrollNode);
+    while (stack.size > 0 && cacheable) {
+        NodeP* node = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        stack.size -= 1;
+        NodeP* child = node->firstChild;
+        while (child != NULL) {
+            if (!NU_Node_Cacheable(child)) { cacheable = false; break; }
+            Array_Push(&stack, &child);
+            child = child->nextSibling;
+        }
+    }
+    Array_Free(&stack);
+    return cacheable;
+}
+
+// Decides whether an overflowing scroll node is drawn from its tile cache
+static bool NU_Scroll_Cache_Use(NodeP* node)
+{
+    float innerHeight = node->node.height - node->node.borderTop - node->node.borderBottom - node->node.padTop - node->node.padBottom;
+    ScrollRenderCache* cache = NU_Scroll_Cache_Get(node);
+    if (node->childCount == 0 || node->node.contentHeight <= innerHeight) {
+        if (cache) cache->active = false;
+        return false;
+    }
+
+    // Create cache
+    if (cache == NULL) {
+        cache = malloc(sizeof(ScrollRenderCache));
+        Array_Init(&cache->tiles, sizeof(ScrollTile), 4);
+        cache->subpixelX = 0.0f;
+        cache->dirty = false;
+        cache->cacheable = NU_Scroll_Subtree_Cacheable(node);
+        Hashmap_Set(&GUI.scrollCaches, &node, &cache);
+    }
+
+    // A node inside changed -> redraw every tile
+    if (cache->dirty) {
+        cache->dirty = false;
+        cache->cacheable = NU_Scroll_Subtree_Cacheable(node);
+        for (u32 i=0; i<cache->tiles.size; i++) {
+            ((ScrollTile*)Array_Get(&cache->tiles, i))->dirty = true;
+        }
+    }
+    cache->active = cache->cacheable;
+    return cache->active;
+}
+
+// Moves a cached scroll node's content to its new scroll offset without a layout pass.
+// Returns false if the node isn't drawn from a cache, in which case it needs a full redraw
+bool NU_Scroll_Cached(NodeP* node, float prevScrollOffset)
+{
+    ScrollRenderCache* cache = NU_Scroll_Cache_Get(node);
+    if (cache == NULL || !cache->active || GUI.awaiting_redraw) return false;
+
+    float dy = NU_Vertical_Scroll_Offset(node) - prevScrollOffset;
+    if (dy == 0.0f) return true;
+
+    Array stack; Array_Init(&stack, sizeof(NodeP*), 32);
+    Array_Push(&stack, &node);
+    while (stack.size > 0) {
+        NodeP* current = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        stack.size -= 1;
+        NodeP* child = current->firstChild;
+        while (child != NULL) {
+            child->node.y += dy;
+            Array_Push(&stack, &child);
+            child = child->nextSibling;
+        }
+    }
+    Array_Free(&stack);
+    GUI.awaiting_scroll_composite = true;
+    return true;
+}
+
+// Finds the tile for a content band, recycling the tile furthest from the visible
+// bands [first, last] once a couple of spare tiles are kept
+static ScrollTile* ScrollRenderCache_Tile(ScrollRenderCache* cache, int index, int first, int last)
+{
+    ScrollTile* recycle = NULL;
+    int recycleDist = 0;
+    for (u32 i=0; i<cache->tiles.size; i++) {
+        ScrollTile* tile = Array_Get(&cache->tiles, i);
+        if (tile->index == index) return tile;
+        int dist = tile->index < first ? first - tile->index : tile->index - last;
+        if (dist > recycleDist) { recycle = tile; recycleDist = dist; }
+    }
+    if (recycle == NULL || cache->tiles.size < (u32)(last - first + 3)) {
+        recycle = Array_PushEmpty(&cache->tiles);
+        CanvasRenderCache_Init(&recycle->target);
+    }
+    recycle->index = index;
+    recycle->dirty = true;
+    return recycle;
+}
+
+// Draws a subtree (the root itself only if drawRoot) into an offscreen target whose
+// top left corner is at originX, originY in the window. Subtrees outside it are skipped
+static void NU_Draw_Subtree_To_Target(NodeP* root, bool drawRoot, CanvasRenderCache* target, float originX, float originY, float winW, float winH)
+{
+    float targetW = (float)target->width;
+    float targetH = (float)target->height;
+    float top = originY;
+    float bottom = originY + targetH;
+    float left = originX;
+    float right = originX + targetW;
+
+    Array rects; Array_Init(&rects, sizeof(BorderRectRenderData), 64);
+    Vertex_RGB_UV_List textVertices[GUI.stylesheet.fonts.size];
+    Index_List textIndices[GUI.stylesheet.fonts.size];
+    for (u32 i=0; i<GUI.stylesheet.fonts.size; i++) {
+        Vertex_RGB_UV_List_Init(&textVertices[i], 256);
+        Index_List_Init(&textIndices[i], 256);
+    }
+    ImageResourceManager_ClearAllImageRenderData(&GUI.imageResourceManager);
+
+    // Generate render data in window space
+    Array stack; Array_Init(&stack, sizeof(NodeP*), 32);
+    Array_Push(&stack, &root);
+    while (stack.size > 0) {
+        NodeP* node = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        stack.size -= 1;
+        if (node != root || drawRoot) {
+            float z = (float)node->layer;
+            Add_NodeRectRenderData(node, z, top, bottom, left, right, &rects);
+            if (node->node.textContent != NULL) {
+                NU_AddTextMesh(node, z, node->node.textContent, &textVertices[node->fontId], &textIndices[node->fontId]);
+            }
+            if (node->typeData.image.imageHandle != 0) {
+                ImageRenderData renderData;
+                renderData.x = node->node.x + node->node.borderLeft + node->node.padLeft - originX; 
+                renderData.y = node->node.y + node->node.borderTop + node->node.padTop - originY; 
+                renderData.z = z + 0.75f;
+                renderData.w = node->node.width - node->node.borderLeft - node->node.borderRight - node->node.padLeft - node->node.padRight; 
+                renderData.h = node->node.height - node->node.borderTop - node->node.borderBottom - node->node.padTop - node->node.padBottom;
+                renderData.scissorTop = 0.0f;
+                renderData.scissorBottom = targetH;
+                renderData.scissorLeft = 0.0f;
+                renderData.scissorRight = targetW;
+                ImageResourceManager_AddImageRenderData(&GUI.imageResourceManager, node->typeData.image.imageHandle, &renderData);
+            }
+        }
+        NodeP* child = node->firstChild;
+        for (; child != NULL; child = child->nextSibling) {
+            if (child->layoutFlags & HIDDEN || 
+                child->node.y >= bottom || child->node.y + child->node.height <= top) continue;
+            Array_Push(&stack, &child);
+        }
+    }
+    Array_Free(&stack);
+
+    // Move into target space (origins are whole pixels, so snapping is kept)
+    for (u32 i=0; i<rects.size; i++) {
+        BorderRectRenderData* rect = Array_Get(&rects, i);
+        rect->x -= originX; rect->scissorLeft -= originX; rect->scissorRight -= originX;
+        rect->y -= originY; rect->scissorTop -= originY; rect->scissorBottom -= originY;
+    }
+    for (u32 t=0; t<GUI.stylesheet.fonts.size; t++) {
+        for (u32 v=0; v<textVertices[t].size; v++) {
+            textVertices[t].array[v].x -= originX;
+            textVertices[t].array[v].y -= originY;
+        }
+    }
+
+    // Draw into the target (border rects, text, images: same order as NU_Draw)
+    GLint prevFramebuffer = CanvasRenderCache_Begin(target);
+    Draw_SDF_Border_Rects(rects, targetW, targetH);
+    for (u32 t=0; t<GUI.stylesheet.fonts.size; t++) {
+        NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, t);
+        if (textIndices[t].size > 0) NU_Render_Text(&textVertices[t], &textIndices[t], font, targetW, targetH, 0, 0, -1.0f, 100000.0f, -1.0f, 100000.0f);
+        Vertex_RGB_UV_List_Free(&textVertices[t]);
+        Index_List_Free(&textIndices[t]);
+    }
+    ImageResourceManager_DrawImages(&GUI.imageResourceManager, targetW, targetH);
+    CanvasRenderCache_End(target, prevFramebuffer, winW, winH);
+    ImageResourceManager_ClearAllImageRenderData(&GUI.imageResourceManager);
+    Array_Free(&rects);
+}
+
+// Composites the visible tiles of a cached scroll node (1 draw call per tile),
+// rendering only tiles that are dirty or newly scrolled into view
+static void NU_DrawScrollCacheContent(NodeP* node, float winW, float winH, NU_ClipBounds* clip)
+{
+    ScrollRenderCache* cache = NU_Scroll_Cache_Get(node);
+    float innerY = node->node.y + node->node.borderTop + node->node.padTop;
+    float innerHeight = node->node.height - node->node.borderTop - node->node.borderBottom - node->node.padTop - node->node.padBottom;
+    float originX = floorf(node->node.x);
+    float originY = roundf(innerY + NU_Vertical_Scroll_Offset(node));
+    int tileW = (int)ceilf(node->node.width) + 1;
+    if (innerHeight <= 0.0f || tileW <= 1) return;
+
+    // Tile widths follow the node's width, a shift within the pixel needs a redraw too
+    if (node->node.x - originX != cache->subpixelX) {
+        cache->subpixelX = node->node.x - originX;
+        for (u32 i=0; i<cache->tiles.size; i++) {
+            ((ScrollTile*)Array_Get(&cache->tiles, i))->dirty = true;
+        }
+    }
+
+    NU_ClipBounds viewClip;
+    viewClip.top    = innerY;
+    viewClip.bottom = innerY + innerHeight;
+    viewClip.left   = node->node.x;
+    viewClip.right  = node->node.x + node->node.width;
+    if (clip) {
+        viewClip.top    = fmaxf(viewClip.top, clip->top);
+        viewClip.bottom = fminf(viewClip.bottom, clip->bottom);
+        viewClip.left   = fmaxf(viewClip.left, clip->left);
+        viewClip.right  = fminf(viewClip.right, clip->right);
+    }
+
+    int first = (int)floorf(fmaxf(innerY - originY, 0.0f) / SCROLL_TILE_HEIGHT);
+    int last = (int)floorf((innerY + innerHeight - originY - 1.0f) / SCROLL_TILE_HEIGHT);
+    float z = (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node) + 0.25f;
+    for (int index=first; index<=last; index++) {
+        ScrollTile* tile = ScrollRenderCache_Tile(cache, index, first, last);
+        if (CanvasRenderCache_Resize(&tile->target, tileW, SCROLL_TILE_HEIGHT)) tile->dirty = true;
+        if (tile->dirty) {
+            NU_Draw_Subtree_To_Target(node, false, &tile->target, originX, originY + (float)(index * SCROLL_TILE_HEIGHT), winW, winH);
+            tile->dirty = false;
+        }
+        NU_Draw_Canvas_Cache(
+            &tile->target, originX, originY + (float)(index * SCROLL_TILE_HEIGHT), z, winW, winH,
+            viewClip.top, viewClip.bottom, viewClip.left, viewClip.right
+        );
+    }
+}
+
+// ----------------------
+// --- Layer caching ----
+// ----------------------
+static LayerRenderCache* NU_Layer_Cache_Get(NodeP* node)
+{
+    LayerRenderCache** found = Hashmap_Get(&GUI.layerCaches, &node);
+    return found ? *found : NULL;
+}
+
+void NU_Layer_Cache_Delete(NodeP* node)
+{
+    LayerRenderCache* cache = NU_Layer_Cache_Get(node);
+    if (cache == NULL) return;
+    CanvasRenderCache_Free(&cache->target);
+    free(cache);
+    Hashmap_Delete(&GUI.layerCaches, &node);
+}
+
+void NU_Layer_Caches_Free()
+{
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.layerCaches);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        LayerRenderCache* cache = *(LayerRenderCache**)value;
+        CanvasRenderCache_Free(&cache->target);
+        free(cache);
+    }
+    Hashmap_Free(&GUI.layerCaches);
+}
+
+static inline u64 NU_Hash_Bytes(u64 hash, const void* data, size_t size)
+{
+    const u8* bytes = data;
+    for (size_t i=0; i<size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Walks the visible descendants of a promoted node, hashing everything that affects
+// how they are painted (positions relative to the layer). Returns false if the
+// subtree can't be drawn into a layer or has nothing visible in the window
+static bool NU_Layer_Signature(NodeP* root, float winW, float winH, LayerRenderCache* cache)
+{
+    // Bounds of the visible descendants, limited to the window
+    float minX = 1000000.0f, minY = 1000000.0f, maxX = -1000000.0f, maxY = -1000000.0f;
+    bool cacheable = true;
+    Array stack; Array_Init(&stack, sizeof(NodeP*), 32);
+    Array_Push(&stack, &root);
+    while (stack.size > 0 && cacheable) {
+        NodeP* node = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        stack.size -= 1;
+        NodeP* child = node->firstChild;
+        for (; child != NULL; child = child->nextSibling) {
+            if (child->layoutFlags & HIDDEN) continue;
+            if (!NU_Node_Cacheable(child)) { cacheable = false; break; }
+            minX = fminf(minX, child->node.x);
+            minY = fminf(minY, child->node.y);
+            maxX = fmaxf(maxX, child->node.x + child->node.width);
+            maxY = fmaxf(maxY, child->node.y + child->node.height);
+            Array_Push(&stack, &child);
+        }
+    }
+    if (!cacheable) { Array_Free(&stack); return false; }
+    minX = floorf(fmaxf(minX, 0.0f));
+    minY = floorf(fmaxf(minY, 0.0f));
+    maxX = fminf(maxX, winW);
+    maxY = fminf(maxY, winH);
+    if (maxX <= minX || maxY <= minY) { Array_Free(&stack); return false; }
+    cache->originX = minX;
+    cache->originY = minY;
+    cache->width = (int)ceilf(maxX - minX) + 1;
+    cache->height = (int)ceilf(maxY - minY) + 1;
+
+    // FNV-1a over the painted state of each visible descendant
+    u64 hash = 14695981039346656037ULL;
+    Array_Push(&stack, &root);
+    while (stack.size > 0) {
+        NodeP* node = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        stack.size -= 1;
+        NodeP* child = node->firstChild;
+        for (; child != NULL; child = child->nextSibling) {
+            if (child->layoutFlags & HIDDEN) continue;
+            Node paint;
+            memcpy(&paint, &child->node, sizeof(Node));
+            paint.textContent = NULL;
+            paint.x -= minX;
+            paint.y -= minY;
+            hash = NU_Hash_Bytes(hash, &paint, sizeof(Node));
+            hash = NU_Hash_Bytes(hash, &child->typeData.image.imageHandle, sizeof(int));
+            hash = NU_Hash_Bytes(hash, &child->layoutFlags, sizeof(u16));
+            hash = NU_Hash_Bytes(hash, &child->layer, sizeof(u8));
+            hash = NU_Hash_Bytes(hash, &child->fontId, sizeof(u8));
+            hash = NU_Hash_Bytes(hash, &child->horizontalTextAlignment, 2 * sizeof(char));
+            if (child->node.textContent != NULL) {
+                hash = NU_Hash_Bytes(hash, child->node.textContent, strlen(child->node.textContent) + 1);
+            }
+            Array_Push(&stack, &child);
+        }
+    }
+    Array_Free(&stack);
+    hash = NU_Hash_Bytes(hash, &cache->width, sizeof(int));
+    hash = NU_Hash_Bytes(hash, &cache->height, sizeof(int));
+    cache->pendingSignature = hash;
+    return true;
+}
+
+// Decides whether a promoted node's descendants are drawn from its layer this frame
+static bool NU_Layer_Use(NodeP* node)
+{
+    if (!NU_Node_Cacheable(node) || node->firstChild == NULL) return false;
+    int winW, winH;
+    GetWindowSize(&GUI.winManager, node->windowID, &winW, &winH);
+
+    LayerRenderCache* cache = NU_Layer_Cache_Get(node);
+    if (cache == NULL) {
+        cache = malloc(sizeof(LayerRenderCache));
+        CanvasRenderCache_Init(&cache->target);
+        cache->valid = false;
+        Hashmap_Set(&GUI.layerCaches, &node, &cache);
+    }
+    return NU_Layer_Signature(node, (float)winW, (float)winH, cache);
+}
+
+// Composites a promoted node's descendants (1 draw call), re-rendering the layer
+// only when their paint signature changed since it was drawn
+static void NU_DrawLayerContent(NodeP* node, float winW, float winH, NU_ClipBounds* clip)
+{
+    LayerRenderCache* cache = NU_Layer_Cache_Get(node);
+    if (CanvasRenderCache_Resize(&cache->target, cache->width, cache->height)) cache->valid = false;
+    if (!cache->valid || cache->signature != cache->pendingSignature) {
+        NU_Draw_Subtree_To_Target(node, false, &cache->target, cache->originX, cache->originY, winW, winH);
+        cache->signature = cache->pendingSignature;
+        cache->valid = true;
+    }
+    float z = (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node) + 0.25f;
+    if (clip) {
+        NU_Draw_Canvas_Cache(&cache->target, cache->originX, cache->originY, z, winW, winH, clip->top, clip->bottom, clip->left, clip->right);
+    } else {
+        NU_Draw_Canvas_Cache(&cache->target, cache->originX, cache->originY, z, winW, winH, -1.0f, 1000000.0f, -1.0f, 1000000.0f);
+    }
+}
+
+// ---------------------------
+// --- Occlusion culling -----
+// ---------------------------
+#define MAX_OCCLUDERS 32
+#define MIN_OCCLUDER_AREA 1024.0f
+
+// Records the opaque part of a drawn node (its rect inset by the largest corner radius
+// and 1px of edge antialiasing). Only the largest MAX_OCCLUDERS rects are kept
+static void NU_Occluder_Add(Array* occluders, NodeP* node, float z, NU_ClipBounds* clip)
+{
+    if (node->layoutFlags & HIDE_BACKGROUND) return;
+    Node* n = &node->node;
+    float inset = 1.0f + fmaxf(fmaxf(n->borderRadiusTl, n->borderRadiusTr), fmaxf(n->borderRadiusBl, n->borderRadiusBr));
+    NU_Occluder occluder;
+    occluder.bounds.left   = floorf(n->x) + inset;
+    occluder.bounds.right  = floorf(n->x + n->width) - inset;
+    occluder.bounds.top    = floorf(n->y) + inset;
+    occluder.bounds.bottom = floorf(n->y + n->height) - inset;
+    if (clip) {
+        occluder.bounds.left   = fmaxf(occluder.bounds.left, clip->left);
+        occluder.bounds.right  = fminf(occluder.bounds.right, clip->right);
+        occluder.bounds.top    = fmaxf(occluder.bounds.top, clip->top);
+        occluder.bounds.bottom = fminf(occluder.bounds.bottom, clip->bottom);
+    }
+    float w = occluder.bounds.right - occluder.bounds.left;
+    float h = occluder.bounds.bottom - occluder.bounds.top;
+    if (w <= 0.0f || h <= 0.0f || w * h < MIN_OCCLUDER_AREA) return;
+    occluder.z = z;
+    occluder.area = w * h;
+
+    if (occluders->size < MAX_OCCLUDERS) {
+        Array_Push(occluders, &occluder);
+        return;
+    }
+    NU_Occluder* smallest = Array_Get(occluders, 0);
+    for (u32 i=1; i<occluders->size; i++) {
+        NU_Occluder* o = Array_Get(occluders, i);
+        if (o->area < smallest->area) smallest = o;
+    }
+    if (occluder.area > smallest->area) *smallest = occluder;
+}
+
+static int NU_Occluder_Compare_Front_To_Back(const void* a, const void* b)
+{
+    float za = ((const NU_Occluder*)a)->z;
+    float zb = ((const NU_Occluder*)b)->z;
+    return (za < zb) - (za > zb);
+}
+
+// A node is occluded if everything it draws lies inside an opaque rect that is
+// strictly in front of it. Text that overflows the node's inner rect is included
+static bool NU_Node_Occluded(Array* occluders, NodeP* node, float z, NU_ClipBounds* clip)
+{
+    Node* n = &node->node;
+    float innerW = n->width - n->borderLeft - n->borderRight - n->padLeft - n->padRight;
+    float innerH = n->height - n->borderTop - n->borderBottom - n->padTop - n->padBottom;
+    float overflowX = fmaxf(n->contentWidth - innerW, 0.0f);
+    float overflowY = fmaxf(n->contentHeight - innerH, 0.0f);
+    NU_ClipBounds bounds;
+    bounds.left   = floorf(n->x - overflowX) - 1.0f;
+    bounds.right  = ceilf(n->x + n->width + overflowX) + 1.0f;
+    bounds.top    = floorf(n->y - overflowY) - 1.0f;
+    bounds.bottom = ceilf(n->y + n->height + overflowY) + 1.0f;
+    if (clip) {
+        bounds.left   = fmaxf(bounds.left, clip->left);
+        bounds.right  = fminf(bounds.right, clip->right);
+        bounds.top    = fmaxf(bounds.top, clip->top);
+        bounds.bottom = fminf(bounds.bottom, clip->bottom);
+    }
+
+    // Occluders are sorted front to back, so stop at the first one that isn't in front
+    for (u32 i=0; i<occluders->size; i++) {
+        NU_Occluder* o = Array_Get(occluders, i);
+        if (o->z <= z) break;
+        if (bounds.left >= o->bounds.left && bounds.right <= o->bounds.right &&
+            bounds.top >= o->bounds.top && bounds.bottom <= o->bounds.bottom) return true;
+    }
+    return false;
+}
+
+// Removes nodes that are fully covered by opaque nodes in front of them from a window's drawlists.
+// Layer roots are kept since their composited content can extend past their own rect
+static void NU_Cull_Occluded_Nodes(NU_WindowDrawlist* list)
+{
+    Array* occluders = &GUI.winManager.occluders;
+    Array_Clear(occluders);
+    for (u32 n=0; n<list->drawNodes.size; n++) {
+        NodeP* node = *(NodeP**)Array_Get(&list->drawNodes, n);
+        NU_Occluder_Add(occluders, node, (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node), NULL);
+    }
+    for (u32 n=0; n<list->clippedDrawNodes.size; n++) {
+        NodeP* node = *(NodeP**)Array_Get(&list->clippedDrawNodes, n);
+        NU_ClipBounds* clip = Hashmap_Get(&GUI.winManager.clipMap, &node->clippedAncestor);
+        NU_Occluder_Add(occluders, node, (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node), clip);
+    }
+    if (occluders->size == 0) return;
+    qsort(occluders->data, occluders->size, sizeof(NU_Occluder), NU_Occluder_Compare_Front_To_Back);
+
+    // Compact each list in place, keeping only visible nodes
+    Array* lists[3] = { &list->drawNodes, &list->clippedDrawNodes, &list->scrollCacheNodes };
+    for (int l=0; l<3; l++) {
+        u32 kept = 0;
+        for (u32 n=0; n<lists[l]->size; n++) {
+            NodeP* node = *(NodeP**)Array_Get(lists[l], n);
+            NU_ClipBounds* clip = (l != 0 && node->clippedAncestor) ? Hashmap_Get(&GUI.winManager.clipMap, &node->clippedAncestor) : NULL;
+            float z = (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node);
+            if (!(node->layoutFlags & LAYER_PROMOTED) && NU_Node_Occluded(occluders, node, z, clip)) continue;
+            *(NodeP**)Array_Get(lists[l], kept++) = node;
+        }
+        lists[l]->size = kept;
+    }
+}
+
+// useRenderCaches -> descendants of cached scroll nodes and promoted layers are left out,
+// they are composited from their render caches instead
+void NU_GenerateDrawlists(bool useRenderCaches)
 {
     // Clear drawlists
     for (int i=0; i<GUI.winManager.windows.size; i++) 
@@ -173,6 +771,8 @@ void NU_GenerateDrawlists()
         NU_Window* win = Container_GetAt(&GUI.winManager.windows, i);
         Array_Clear(&win->drawlist.drawNodes);
         Array_Clear(&win->drawlist.clippedDrawNodes);
+        Array_Clear(&win->drawlist.scrollCacheNodes);
+        Array_Clear(&win->drawlist.layerNodes);
     }
 
     // Clear hashmaps
@@ -189,7 +789,15 @@ void NU_GenerateDrawlists()
     NodeP* node;
     while(BreadthFirstSearch_Next(bfs, &node)) {
 
-        // Node not visible? children must inherit this
+        // Node drawn from a scroll cache or layer (or not visible)? children must inherit this
+        if (node->stateFlags & STATE_FLAG_CACHED) {
+            NodeP* child = node->firstChild;
+            while(child != NULL) {
+                child->stateFlags |= STATE_FLAG_CACHED;
+                child = child->nextSibling;
+            }
+            continue;
+        }
         if (NodeStateHidden(node)) {
             NodeP* child = node->firstChild;
             while(child != NULL) {
@@ -199,6 +807,28 @@ void NU_GenerateDrawlists()
             continue;
         }
 
+        // Scroll node content is composited from its tile cache
+        if (useRenderCaches && node->layoutFlags & OVERFLOW_VERTICAL_SCROLL && NU_Scroll_Cache_Use(node)) {
+            SetNodeDrawlist_ScrollCache(&GUI.winManager, node);
+            NodeP* child = node->firstChild;
+            while(child != NULL) {
+                child->stateFlags |= STATE_FLAG_CACHED;
+                child = child->nextSibling;
+            }
+            continue;
+        }
+
+        // Promoted node content is composited from its layer
+        if (useRenderCaches && node->layoutFlags & LAYER_PROMOTED && NU_Layer_Use(node)) {
+            SetNodeDrawlist_Layer(&GUI.winManager, node);
+            NodeP* child = node->firstChild;
+            while(child != NULL) {
+                child->stateFlags |= STATE_FLAG_CACHED;
+                child = child->nextSibling;
+            }
+            continue;
+        }
+
         // Precompute node inner rect
         float nodeInnerX, nodeInnerY, nodeInnerWidth, nodeInnerHeight = 0;
         if (node->layoutFlags & OVERFLOW_VERTICAL_SCROLL) {
@@ -220,13 +850,14 @@ void NU_GenerateDrawlists()
 
         // cache window dimensions
         int winW, winH;
-        SDL_Window* window = GetSDL_Window(&GUI.winManager, node->windowID);
-        SDL_GetWindowSize(window, &winW, &winH);
+        GetWindowSize(&GUI.winManager, node->windowID, &winW, &winH);
 
         // iterate over children
         NodeP* child = node->firstChild;
         while(child != NULL) 
         {
+            child->stateFlags &= ~STATE_FLAG_CACHED;
+
             // if child is not visible (or not visible in window -> mark as hidded) -> skip
             if (NodeStateHidden(child) | NodeNotVisibleInWindow(child, winW, winH)) {
                 child->stateFlags |= STATE_FLAG_HIDDEN; 
@@ -289,11 +920,17 @@ void NU_GenerateDrawlists()
             child = child->nextSibling;
         }
     }
+
+    // Drop nodes hidden behind opaque content
+    for (int i=0; i<GUI.winManager.windows.size; i++) {
+        NU_Window* win = Container_GetAt(&GUI.winManager.windows, i);
+        NU_Cull_Occluded_Nodes(&win->drawlist);
+    }
 }
 
 void NU_Draw()
 {
-    NU_GenerateDrawlists();
+    NU_GenerateDrawlists(true);
 
     // Initialise text vertex and index buffers (per font)
     Vertex_RGB_UV_List text_vertex_buffers[GUI.stylesheet.fonts.size];
@@ -303,13 +940,14 @@ void NU_Draw()
         Index_List_Init(&text_index_buffers[i], 512);
     }
 
-    ImageResourceManager_ClearAllImageRenderData(&GUI.imageResourceManager);
     Array_Clear(&GUI.borderRects);
 
     // Upload / reupload font atlases as needed
     for (u32 t=0; t<GUI.stylesheet.fonts.size; t++) {
         NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, t);
+        SDL_LockMutex(font->glyphMutex);
         NU_Font_Atlas_Upload_Or_Modify_GPU(&font->atlas);
+        SDL_UnlockMutex(font->glyphMutex);
     }
 
     NodeP* focusedInputNode = NULL;
@@ -328,6 +966,7 @@ void NU_Draw()
         SDL_GetWindowSize(window, &winW_int, &winH_int);
         float winW = (float)winW_int;
         float winH = (float)winH_int;
+        ImageResourceManager_ClearAllImageRenderData(&GUI.imageResourceManager);
         
         // 1. Generate border rect data for unclipped nodes
         for (u32 n=0; n<drawList->drawNodes.size; n++) 
@@ -439,14 +1078,21 @@ void NU_Draw()
             if (node->type == NU_CANVAS) NU_DrawCanvasContent(node, winW, winH, clip);
         }
 
-        // 5. Draw all images (1 draw call per atlas / standalone image)
-        for (int i=0; i<GUI.imageResourceManager.atlases.size; i++) {
-            Atlas* atlas = Array_Get(&GUI.imageResourceManager.atlases, i);
-            NU_Draw_Images(atlas->renderDataArray, winW, winH, atlas->glImageHandle);
+        // 5. Draw all images (1 draw call, plus 1 per change of large image bucket)
+        ImageResourceManager_DrawImages(&GUI.imageResourceManager, winW, winH);
+
+        // 6. Composite cached scroll content (1 draw call per visible tile)
+        for (u32 n=0; n<drawList->scrollCacheNodes.size; n++) {
+            NodeP* node = *(NodeP**)Array_Get(&drawList->scrollCacheNodes, n);
+            NU_ClipBounds* clip = node->clippedAncestor ? Hashmap_Get(&GUI.winManager.clipMap, &node->clippedAncestor) : NULL;
+            NU_DrawScrollCacheContent(node, winW, winH, clip);
         }
-        for (int i=0; i<GUI.imageResourceManager.standaloneImageRenderDatas.size; i++) {
-            StandaloneImageRenderData* sRenderData = Array_Get(&GUI.imageResourceManager.standaloneImageRenderDatas, i);
-            NU_Draw_Image(&sRenderData->renderData, winW, winH, sRenderData->glImageHandle);
+
+        // 7. Composite promoted layers (1 draw call per layer)
+        for (u32 n=0; n<drawList->layerNodes.size; n++) {
+            NodeP* node = *(NodeP**)Array_Get(&drawList->layerNodes, n);
+            NU_ClipBounds* clip = node->clippedAncestor ? Hashmap_Get(&GUI.winManager.clipMap, &node->clippedAncestor) : NULL;
+            NU_DrawLayerContent(node, winW, winH, clip);
         }
 
         SDL_GL_SwapWindow(window); 
@@ -459,5 +1105,9 @@ void NU_Draw()
         Vertex_RGB_UV_List_Free(&text_vertex_buffers[i]);
         Index_List_Free(&text_index_buffers[i]);
     }
+
+    // Resample large images to the size they were drawn at (used from the next frame on)
+    ImageResourceManager_FitLargeImagesToDisplay(&GUI.imageResourceManager);
     GUI.awaiting_redraw = false;
+    GUI.awaiting_scroll_composite = false;
 }
\ No newline at end of file
@@ -37,6 +37,8 @@ static inline float fmin_fast(float a, float b) {
 #include <tree/nu_node.h>
 #include <tree/nu_tree.h>
 #include <tree/nu_nodelist.h>
+#include <tree/nu_node_index.h>
+#include <tree/nu_node_handles.h>
 #include <rendering/nu_renderer_structures.h>
 #include <window/nu_window_manager_structs.h>
 #include <templates/stylesheet/nu_stylesheet_structs.h>
@@ -51,10 +53,14 @@ struct NU_GUI
     WindowManager winManager;
     ImageResourceManager imageResourceManager;
     StringArena nodeTextArena;
+    Hashmap textMetrics; // NodeP* -> NU_TextMetrics
     Stringset class_string_set;
     Stringset id_string_set;
     Stringmap id_node_map;
+    NodeIndex nodeIndex; // class and type -> nodes
+    NodeHandles nodeHandles; // generational handles, slots exist only for requested nodes
     Container canvasContexts;
+    SDL_Mutex* canvasMutex; // guards canvasContexts for worker thread lookups
     Container textInputs;
 
     // Pseudo nodes
@@ -69,6 +75,9 @@ struct NU_GUI
     NodeP* scroll_hovered_node;
     NodeP* scroll_mouse_down_node;
     float v_scroll_thumb_grab_offset;
+    Hashmap scrollCaches; // NodeP* -> ScrollRenderCache*
+    Hashmap layerCaches;  // NodeP* -> LayerRenderCache*
+    Hashmap virtualRows;  // NodeP* -> VirtualRows*
 
     // Mouse position state
     float mouseDownGlobalX;
@@ -77,11 +86,16 @@ struct NU_GUI
     // States
     bool running;
     bool awaiting_redraw;
+    bool awaiting_scroll_composite; // only cached scroll content moved
+    u32 updateDepth; // nesting of NU_Begin_Update calls
+    Set pendingStyleNodes; // NodeP* restyled at the outermost NU_End_Update
+    Set layoutDirtyRoots;  // NodeP* contain boundaries to lay out without a full layout
     bool recalculate_mouse_hover;
 
     // styles
     Stylesheet stylesheet;
     SDL_GLContext gl_ctx;
+    bool headless; // no SDL windows or GL context, windows are drawn with NU_Render_To_Framebuffer
 
     // Events
     EventSystem eventSystem;
@@ -120,25 +134,36 @@ struct NU_GUI GUI;
 #include <templates/stylesheet/nu_stylesheet.h>
 #include <rendering/canvas/nu_canvas_api.h>
 #include <templates/xml/nu_xml.h>
+#include <nu_virtual_rows.h>
 #include <nu_layout.h>
 #include <input_text/nu_input_text.h>
 #include <nu_draw.h>
+#include <rendering/software/nu_software_renderer.h>
 #include <nu_mouse_detection.h>
 #include <events/nu_events.h>
 #include <nu_dom.h>
 
 void NU_Internal_Quit()
 {
+    NU_Scroll_Caches_Free(); // before the GL context is destroyed
+    NU_Layer_Caches_Free();
+    Set_Free(&GUI.pendingStyleNodes);
+    Set_Free(&GUI.layoutDirtyRoots);
+    VirtualRows_Free_All();
     TreeFree(&GUI.tree);
     WindowManager_Free(&GUI.winManager);
     ImageResourceManager_Free(&GUI.imageResourceManager);
     ErrorSystem_Free(&GUI.errorSystem);
     Stringmap_Free(&GUI.id_node_map);
+    NodeIndex_Free(&GUI.nodeIndex);
+    NodeHandles_Free(&GUI.nodeHandles);
     Stringset_Free(&GUI.class_string_set);
     Stringset_Free(&GUI.id_string_set);
     StringArena_Free(&GUI.nodeTextArena);
+    Hashmap_Free(&GUI.textMetrics);
     Stylesheet_Free(&GUI.stylesheet);
     Container_Free(&GUI.canvasContexts);
+    SDL_DestroyMutex(GUI.canvasMutex);
     Container_Free(&GUI.textInputs);
     Array_Free(&GUI.borderRects);
     BreadthFirstSearch_Free(&GUI.bfs);
@@ -147,33 +172,52 @@ void NU_Internal_Quit()
     SDL_Quit();
 }
 
-int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath)
+// headless -> no video subsystem, windows or GL context. The root window is width x height
+int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath, bool headless, int width, int height)
 {
-    // Init SDL
-    if (!SDL_Init(SDL_INIT_VIDEO)) return 0;
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
-    SDL_SetHint("SDL_MOUSE_FOCUS_CLICKTHROUGH", "1");
+    // Init SDL (headless guis still use SDL threads, mutexes and events)
+    GUI.headless = headless;
+    if (headless) {
+        if (!SDL_Init(SDL_INIT_EVENTS)) return 0;
+    }
+    else {
+        if (!SDL_Init(SDL_INIT_VIDEO)) return 0;
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
+        SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+        SDL_SetHint("SDL_MOUSE_FOCUS_CLICKTHROUGH", "1");
+    }
+
+    // Init FreeType (glyphs are rasterised on the CPU, headless or not)
+    if (FT_Init_FreeType(&nu_global_freetype)) {
+        printf("Could not init FreeType.\n");
+        SDL_Quit();
+        return 0;
+    }
 
     // Init Window Manager -> create the main window (hidden)
-    WindowManager_Init(&GUI.winManager);
+    WindowManager_Init(&GUI.winManager, width, height);
 
     // Init other systems
     ImageResourceManager_Init(&GUI.imageResourceManager);
+    GUI.imageResourceManager.cpuOnly = headless;
     ErrorSystem_Init(&GUI.errorSystem);
 
     // Init string data structures
     StringArena_Init(&GUI.nodeTextArena, 1024);
+    Hashmap_Init(&GUI.textMetrics, sizeof(NodeP*), sizeof(NU_TextMetrics), 64);
     Stringset_Init(&GUI.class_string_set, 1024, 100);
     Stringset_Init(&GUI.id_string_set, 1024, 100);
     Stringmap_Init(&GUI.id_node_map, sizeof(NodeP*), 100, 1024);
+    NodeIndex_Init(&GUI.nodeIndex);
+    NodeHandles_Init(&GUI.nodeHandles);
     
     // Init canvas context and text input containers
-    GUI.canvasContexts = Container_Create(sizeof(NU_Canvas_Context));
+    GUI.canvasContexts = Container_Create(sizeof(NU_Canvas_Context*));
+    GUI.canvasMutex = SDL_CreateMutex();
     GUI.textInputs = Container_Create(sizeof(InputText));
 
     // Init Event System (allocates memory)
@@ -183,17 +227,19 @@ int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath)
     Array_Init(&GUI.layoutScrollAutoNodes, sizeof(NodeP*), 20);
     Array_Init(&GUI.borderRects, sizeof(BorderRectRenderData), 2000);
 
-    // Cursors
-    GUI.cursorDefault    = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_DEFAULT);
-    GUI.cursorPointer    = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_POINTER);
-    GUI.cursorText       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_TEXT);
-    GUI.cursorWait       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_WAIT);
-    GUI.cursorCrosshair  = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_CROSSHAIR);
-    GUI.cursorMove       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_MOVE);
-    GUI.cursorNsResize   = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NS_RESIZE);
-    GUI.cursorEwResize   = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_EW_RESIZE);
-    GUI.cursorNwseResize = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NWSE_RESIZE);
-    GUI.cursorNeswResize = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NESW_RESIZE);
+    // Cursors (NULL when headless)
+    if (!headless) {
+        GUI.cursorDefault    = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_DEFAULT);
+        GUI.cursorPointer    = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_POINTER);
+        GUI.cursorText       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_TEXT);
+        GUI.cursorWait       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_WAIT);
+        GUI.cursorCrosshair  = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_CROSSHAIR);
+        GUI.cursorMove       = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_MOVE);
+        GUI.cursorNsResize   = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NS_RESIZE);
+        GUI.cursorEwResize   = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_EW_RESIZE);
+        GUI.cursorNwseResize = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NWSE_RESIZE);
+        GUI.cursorNeswResize = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_NESW_RESIZE);
+    }
 
     // Pseudo nodes
     GUI.hovered_node = NULL;
@@ -206,10 +252,17 @@ int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath)
     // Scroll nodes
     GUI.scroll_hovered_node = NULL;
     GUI.scroll_mouse_down_node = NULL;
+    Hashmap_Init(&GUI.scrollCaches, sizeof(NodeP*), sizeof(ScrollRenderCache*), 8);
+    Hashmap_Init(&GUI.layerCaches, sizeof(NodeP*), sizeof(LayerRenderCache*), 8);
+    Hashmap_Init(&GUI.virtualRows, sizeof(NodeP*), sizeof(VirtualRows*), 4);
 
     // State
     GUI.running = false;
     GUI.awaiting_redraw = true;
+    GUI.awaiting_scroll_composite = false;
+    GUI.updateDepth = 0;
+    Set_Init(&GUI.pendingStyleNodes, sizeof(NodeP*), 64);
+    Set_Init(&GUI.layoutDirtyRoots, sizeof(NodeP*), 8);
     GUI.recalculate_mouse_hover = true;
 
     // Traversal
@@ -232,6 +285,7 @@ int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath)
         NU_Internal_Quit();
         return 0;
     }
+    NodeIndex_Build(&GUI.nodeIndex, GUI.tree.root);
 
     // Load css
     if (!Stylesheet_Create(&GUI.stylesheet, css_filepath, &imageResourceLoader)) {
@@ -239,7 +293,7 @@ int NU_Internal_Create_Gui(const char* xml_filepath, const char* css_filepath)
         return 0;
     }
 
-    // Upload image to the GPU and free loader memory
+    // Upload image to the GPU (headless -> pixels stay on the CPU) and free loader memory
     ImageResourceLoader_UploadImagesAndFree(&imageResourceLoader);
 
     // Apply css
@@ -7,6 +7,9 @@
 #include <utils/performance.h>
 #include <text/nu_text_layout.h>
 
+// Defined in nu_draw.h
+void NU_Scroll_Cache_Invalidate(NodeP* node);
+
 static void NU_ApplyMinMaxWidthConstraint(NodeP* node)
 {
     node->node.width = min(max(node->node.width, node->node.minWidth), node->node.maxWidth);
@@ -24,8 +27,8 @@ static void NU_Prepass(BreadthFirstSearch* bfs, Array* scrollAutoNodes)
     NodeP* node;
     while (BreadthFirstSearch_Next(bfs, &node)) {
 
-        // Reset state
-        node->stateFlags = 0;
+        // Reset state (a restyle deferred by NU_Begin_Update stays pending)
+        node->stateFlags &= STATE_FLAG_STYLE_PENDING;
 
         // Set node hidden
         if (node->layoutFlags & HIDDEN || 
@@ -76,6 +79,40 @@ static void NU_Prepass(BreadthFirstSearch* bfs, Array* scrollAutoNodes)
     }
 }
 
+// Text measurements of a node, reused by every layout until its text or font changes
+typedef struct NU_TextMetrics
+{
+    const char* text; // textContent the metrics were measured for
+    float unwrappedWidth;
+    float minWrapWidth;
+    float wrapWidth;  // width wrapHeight was measured at (-1 before the first measure)
+    float wrapHeight;
+    u8 fontId;
+} NU_TextMetrics;
+
+static NU_TextMetrics* NU_Text_Metrics(NodeP* node, NU_Font* font)
+{
+    NU_TextMetrics* metrics = Hashmap_Get(&GUI.textMetrics, &node);
+    if (metrics != NULL && metrics->text == node->node.textContent && metrics->fontId == node->fontId) {
+        return metrics;
+    }
+    NU_TextMetrics measured;
+    measured.text = node->node.textContent;
+    measured.fontId = node->fontId;
+    measured.unwrappedWidth = NU_Calculate_Text_Unwrapped_Width(font, node->node.textContent);
+    measured.minWrapWidth = NU_Calculate_Text_Min_Wrap_Width(font, node->node.textContent);
+    measured.wrapWidth = -1.0f;
+    measured.wrapHeight = 0.0f;
+    Hashmap_Set(&GUI.textMetrics, &node, &measured);
+    return Hashmap_Get(&GUI.textMetrics, &node);
+}
+
+// Call when a node's text changes in place, so the next layout measures it again
+void NU_Invalidate_Text_Metrics(NodeP* node)
+{
+    if (GUI.textMetrics.itemCount > 0) Hashmap_Delete(&GUI.textMetrics, &node);
+}
+
 static void NU_CalculateTextFitWidths(BreadthFirstSearch* bfs)
 {
     NodeP* node;
@@ -85,16 +122,17 @@ static void NU_CalculateTextFitWidths(BreadthFirstSearch* bfs)
         if (NodeStateHidden(node) || node->node.textContent == NULL || node->type == NU_FRAME) continue;
 
         NU_Font* node_font = Stylesheet_Get_Font(&GUI.stylesheet, node->fontId);
+        NU_TextMetrics* metrics = NU_Text_Metrics(node, node_font);
 
         // Calculate text width & height
-        float text_width = NU_Calculate_Text_Unwrapped_Width(node_font, node->node.textContent);
+        float text_width = metrics->unwrappedWidth;
         
         // Calculate minimum text wrap width (longest unbreakable word)
-        float min_wrap_width = NU_Calculate_Text_Min_Wrap_Width(node_font, node->node.textContent);
+        float min_wrap_width = metrics->minWrapWidth;
 
         // Increase width to account for text (text height will be accounted for later in NU_CalculateTextHeights())
         float natural_width = node->node.padLeft + node->node.padRight + node->node.borderLeft + node->node.borderRight;
-        node->node.width = max(text_width + natural_width, node->node.prefWidth);
+        if (!(node->layoutFlags & LAYOUT_CONTAIN)) node->node.width = max(text_width + natural_width, node->node.prefWidth);
 
         // Update content width
         node->node.contentWidth = text_width; 
@@ -112,8 +150,7 @@ static void NU_CalculateFitSizeWidths(ReverseBreadthFirstSearch* rbfs)
         // If node is a window -> set dimensions equal to window
         if (node->type == NU_WINDOW) {
             int winWidth, winHeight;
-            SDL_Window* window = GetSDL_Window(&GUI.winManager, node->windowID);
-            SDL_GetWindowSize(window, &winWidth, &winHeight);
+            GetWindowSize(&GUI.winManager, node->windowID, &winWidth, &winHeight);
             node->node.width = (float)winWidth;
             node->node.height = (float)winHeight;
         }
@@ -135,7 +172,7 @@ static void NU_CalculateFitSizeWidths(ReverseBreadthFirstSearch* rbfs)
 
         // Expand width to account for content width
         if (is_layout_horizontal && visibleChildren > 0) node->node.contentWidth += (visibleChildren - 1) * node->node.gap;
-        if (node->type != NU_WINDOW && node->node.contentWidth > node->node.width) {
+        if (node->type != NU_WINDOW && !(node->layoutFlags & LAYOUT_CONTAIN) && node->node.contentWidth > node->node.width) {
             node->node.width = node->node.contentWidth + node->node.borderLeft + node->node.borderRight + node->node.padLeft + node->node.padRight;
             NU_ApplyMinMaxWidthConstraint(node);
         }
@@ -167,8 +204,12 @@ static void NU_CalculateFitSizeHeights(ReverseBreadthFirstSearch* rbfs)
 
         // Expand node height to account for content height
         if (!is_layout_horizontal && visibleChildren > 0) node->node.contentHeight += (visibleChildren - 1) * node->node.gap;
+
+        // Virtual rows stand in for all of their rows, not just the materialized ones
+        VirtualRows* virtualRows = VirtualRows_Get(node);
+        if (virtualRows != NULL) node->node.contentHeight = VirtualRows_Content_Height(virtualRows);
         if (node->type != NU_WINDOW) {
-            if (!(node->layoutFlags & OVERFLOW_VERTICAL_SCROLL)) node->node.height = node->node.contentHeight + node->node.borderTop + node->node.borderBottom + node->node.padTop + node->node.padBottom;
+            if (!(node->layoutFlags & (OVERFLOW_VERTICAL_SCROLL | LAYOUT_CONTAIN))) node->node.height = node->node.contentHeight + node->node.borderTop + node->node.borderBottom + node->node.padTop + node->node.padBottom;
             NU_ApplyMinMaxHeightConstraint(node);
         }
     }
@@ -675,12 +716,17 @@ static void NU_CalculateTextHeights(BreadthFirstSearch* bfs)
             // Compute available inner width
             float inner_width = node->node.width - node->node.borderLeft - node->node.borderRight - node->node.padLeft - node->node.padRight;
 
-            // Calculate text height
-            float text_height = NU_Calculate_FreeText_Height_From_Wrap_Width(node_font, node->node.textContent, inner_width);
+            // Calculate text height (remeasured only when the wrap width changed)
+            NU_TextMetrics* metrics = NU_Text_Metrics(node, node_font);
+            if (metrics->wrapWidth != inner_width) {
+                metrics->wrapHeight = NU_Calculate_FreeText_Height_From_Wrap_Width(node_font, node->node.textContent, inner_width);
+                metrics->wrapWidth = inner_width;
+            }
+            float text_height = metrics->wrapHeight;
 
             // Increase height to account for text
             float natural_height = node->node.padTop + node->node.padBottom + node->node.borderTop + node->node.borderBottom;
-            node->node.height = max(text_height + natural_height, node->node.prefHeight);
+            if (!(node->layoutFlags & LAYOUT_CONTAIN)) node->node.height = max(text_height + natural_height, node->node.prefHeight);
             
             // Update content height
             node->node.contentHeight = text_height;
@@ -770,22 +816,36 @@ static void NU_PositionChildrenHorizontally(NodeP* node, float scrollbarThicknes
     }
 }
 
-static void NU_PositionChildrenVertically(NodeP* node, float scrollbarThickness)
+// Vertical offset (<= 0) that scrolling applies to a node's children
+float NU_Vertical_Scroll_Offset(NodeP* node)
 {
-    float y_scroll_offset = 0.0f;
-    if (node->layoutFlags & OVERFLOW_VERTICAL_SCROLL && 
-        node->childCount > 0 && 
-        node->node.contentHeight > node->node.height - node->node.padTop - node->node.padBottom - node->node.borderTop - node->node.borderBottom) 
+    if (!(node->layoutFlags & OVERFLOW_VERTICAL_SCROLL) || 
+        node->childCount == 0 || 
+        node->node.contentHeight <= node->node.height - node->node.padTop - node->node.padBottom - node->node.borderTop - node->node.borderBottom) 
     {
-        float track_h = node->node.height - node->node.borderTop - node->node.borderBottom;
-        float inner_height_w_pad = track_h - node->node.padTop - node->node.padBottom;
-        float inner_proportion_of_content_height = inner_height_w_pad / node->node.contentHeight;
-        float thumb_h = inner_proportion_of_content_height * track_h;
-        float content_scroll_range = node->node.contentHeight - inner_height_w_pad;
-        float thumb_scroll_range = track_h - thumb_h;
-        float scroll_factor = content_scroll_range / max(thumb_scroll_range, 1.0f);
-        y_scroll_offset += (-node->scrollV * (track_h - thumb_h)) * scroll_factor;
+        return 0.0f;
+    }
+    float track_h = node->node.height - node->node.borderTop - node->node.borderBottom;
+    float inner_height_w_pad = track_h - node->node.padTop - node->node.padBottom;
+    float inner_proportion_of_content_height = inner_height_w_pad / node->node.contentHeight;
+    float thumb_h = inner_proportion_of_content_height * track_h;
+    float content_scroll_range = node->node.contentHeight - inner_height_w_pad;
+    float thumb_scroll_range = track_h - thumb_h;
+    float scroll_factor = content_scroll_range / max(thumb_scroll_range, 1.0f);
+    return (-node->scrollV * (track_h - thumb_h)) * scroll_factor;
+}
+
+static void NU_PositionChildrenVertically(NodeP* node, float scrollbarThickness)
+{
+    VirtualRows* virtualRows = VirtualRows_Get(node);
+    if (virtualRows != NULL) {
+        VirtualRows_Position(virtualRows);
+        return;
+    }
 
+    float y_scroll_offset = NU_Vertical_Scroll_Offset(node);
+    if (y_scroll_offset != 0.0f) 
+    {
         // undo effect of scroll offset for table header row
         if (node->firstChild->type == NU_THEAD) {
             node->firstChild->node.y -= y_scroll_offset;
@@ -921,19 +981,28 @@ void NU_Repass(BreadthFirstSearch* bfs)
     }
 }
 
-void NU_Layout()
+// Lays out the tree, or the subtree of a contain boundary which keeps the box its parent gave it
+static void NU_Layout_Subtree(NodeP* root)
 {
     // RESET TRAVERSAL DATA STRUCTURES
     BreadthFirstSearch* bfs = &GUI.bfs;
     ReverseBreadthFirstSearch* rbfs = &GUI.rbfs;
-    BreadthFirstSearch_Reset(bfs, GUI.tree.root);
-    ReverseBreadthFirstSearch_Reset(rbfs, GUI.tree.root);
+    BreadthFirstSearch_Reset(bfs, root);
+    ReverseBreadthFirstSearch_Reset(rbfs, root);
 
     // RESERVE LIST OF AUTO SCROLL NODES
     Array_Clear(&GUI.layoutScrollAutoNodes);
 
     // FIRST PASS -> ASSUME SCROLLBARS TAKE UP NO SPACE
+    // (a contain boundary keeps the box and state flags its parent's layout and drawlist gave it)
+    float rootX = root->node.x, rootY = root->node.y, rootWidth = root->node.width, rootHeight = root->node.height;
+    u8 rootState = root->stateFlags;
     NU_Prepass(bfs, &GUI.layoutScrollAutoNodes);
+    if (root != GUI.tree.root) {
+        root->node.x = rootX; root->node.y = rootY;
+        root->node.width = rootWidth; root->node.height = rootHeight;
+        root->stateFlags = rootState;
+    }
     NU_CalculateTextFitWidths(bfs);
     NU_CalculateFitSizeWidths(rbfs);  
     NU_GrowShrinkWidths(bfs, 0.0f);
@@ -977,4 +1046,70 @@ void NU_Layout()
         NU_GrowShrinkHeights(bfs, trackWidth);
         NU_CalculatePositions(bfs, trackWidth);
     }
-}
\ No newline at end of file
+}
+
+static void NU_Layout_Roots(NodeP** roots, u32 count)
+{
+    // Virtual rows are materialized for the viewport of the previous layout,
+    // and once more if this layout resized or scrolled a virtual container
+    bool virtualRows = GUI.virtualRows.itemCount > 0;
+    if (virtualRows) VirtualRows_Update_All();
+    for (u32 i=0; i<count; i++) NU_Layout_Subtree(roots[i]);
+    if (virtualRows && VirtualRows_Update_All()) {
+        for (u32 i=0; i<count; i++) NU_Layout_Subtree(roots[i]);
+    }
+}
+
+void NU_Layout()
+{
+    NU_Layout_Roots(&GUI.tree.root, 1);
+    Set_Clear(&GUI.layoutDirtyRoots);
+}
+
+// Nearest contain boundary strictly above node, or NULL if a change to node affects the whole tree.
+// Table rows can't be boundaries since their cells are sized with the other rows
+static NodeP* NU_Layout_Boundary(NodeP* node)
+{
+    if (node->type == NU_WINDOW) return NULL;
+    for (NodeP* ancestor = node->parent; ancestor != NULL; ancestor = ancestor->parent) {
+        if (ancestor->type == NU_WINDOW) return NULL;
+        if (ancestor->layoutFlags & LAYOUT_CONTAIN && ancestor->type != NU_ROW && ancestor->type != NU_THEAD) return ancestor;
+    }
+    return NULL;
+}
+
+// Marks node's layout as stale. Inside a contain boundary only the boundary's subtree
+// is laid out again on the next frame (see NU_Layout_Contained), otherwise the whole tree is
+void NU_Request_Layout(NodeP* node)
+{
+    if (node == NULL) return;
+    NU_Scroll_Cache_Invalidate(node);
+    if (GUI.awaiting_redraw) return; // a full layout is due anyway
+    NodeP* boundary = NU_Layout_Boundary(node);
+    if (boundary == NULL) GUI.awaiting_redraw = true;
+    else Set_Insert(&GUI.layoutDirtyRoots, &boundary);
+}
+
+static bool NU_Layout_Has_Dirty_Ancestor(NodeP* node)
+{
+    for (NodeP* ancestor = node->parent; ancestor != NULL; ancestor = ancestor->parent) {
+        if (ancestor->layoutFlags & LAYOUT_CONTAIN && Set_Contains(&GUI.layoutDirtyRoots, &ancestor)) return true;
+    }
+    return false;
+}
+
+// Lays out the subtrees marked by NU_Request_Layout, skipping boundaries inside another marked one
+void NU_Layout_Contained()
+{
+    Array roots; Array_Init(&roots, sizeof(NodeP*), GUI.layoutDirtyRoots.itemCount);
+    SetIterator it = Set_CreateIterator(&GUI.layoutDirtyRoots);
+    void* key;
+    while (Set_IteratorNext(&it, &key)) {
+        NodeP* root = *(NodeP**)key;
+        if (TreeNodeDetached(&GUI.tree, root) || NU_Layout_Has_Dirty_Ancestor(root)) continue;
+        Array_Push(&roots, &root);
+    }
+    NU_Layout_Roots((NodeP**)roots.data, roots.size);
+    Array_Free(&roots);
+    Set_Clear(&GUI.layoutDirtyRoots); // requests made while binding virtual rows were laid out above
+}
@@ -216,6 +216,7 @@ void NU_Mouse_Hover()
     if (GUI.hovered_node != GUI.prev_hovered_node) {
         if (GUI.prev_hovered_node != NULL && GUI.prev_hovered_node != GUI.mouse_down_node && GUI.prev_hovered_node != GUI.focused_node) NU_Apply_Stylesheet_To_Node(GUI.prev_hovered_node, &GUI.stylesheet);
         if (GUI.hovered_node != GUI.mouse_down_node && GUI.hovered_node != GUI.focused_node) NU_Apply_Pseudo_Style_To_Node(GUI.hovered_node, &GUI.stylesheet, PSEUDO_HOVER);
-        GUI.awaiting_redraw = true;
+        NU_Request_Layout(GUI.prev_hovered_node);
+        NU_Request_Layout(GUI.hovered_node);
     }
 }
\ No newline at end of file
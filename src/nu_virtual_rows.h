@@ -0,0 +1,316 @@
+#pragma once
+
+// Virtual rows: a vertical scroll container standing in for rowCount rows while holding only
+// enough row subtrees to cover its viewport. The container's single row child is the template,
+// clones of it form a pool that is rebound to whichever rows scroll into view.
+// Row positions come from the application's height estimates, summed once up front
+
+// Defined in nu_dom.h
+void NU_Clone_Node_Resources(NodeP* clone, NodeP* src);
+void NU_Internal_Delete_Node(NodeP* node);
+
+#define NU_VIRTUAL_OVERSCAN 4 // rows materialized past each edge of the viewport
+
+typedef float (*NU_Row_Height_Callback)(u32 rowIndex, void* args);
+typedef void (*NU_Row_Bind_Callback)(Node* row, u32 rowIndex, void* args);
+
+typedef struct VirtualRows
+{
+    NodeP* container;
+    u32 rowCount;
+    NU_Row_Height_Callback heightCB;
+    NU_Row_Bind_Callback bindCB;
+    void* args;
+    double* offsets;      // rowCount + 1 prefix sums of estimated row height + gap
+    u32 offsetsCapacity;
+    float gap;            // container gap the offsets were summed with
+    u32 first;            // first materialized row
+    u32 count;            // materialized rows
+    Array rows;           // NodeP* pool, rows[0] is the template. Row i is held by rows[i % pool size]
+    Array rowIndices;     // u32 row each pool entry is bound to (UINT32_MAX = unbound)
+} VirtualRows;
+
+static inline VirtualRows* VirtualRows_Get(NodeP* node)
+{
+    if (!(node->layoutFlags & VIRTUAL_ROWS)) return NULL;
+    VirtualRows** found = Hashmap_Get(&GUI.virtualRows, &node);
+    return found == NULL ? NULL : *found;
+}
+
+// Recomputes offsets from row `from` onwards
+static void VirtualRows_Sum_Offsets(VirtualRows* vr, u32 from)
+{
+    if (vr->rowCount + 1 > vr->offsetsCapacity) {
+        vr->offsetsCapacity = max(vr->rowCount + 1, vr->offsetsCapacity * 2);
+        vr->offsets = realloc(vr->offsets, sizeof(double) * vr->offsetsCapacity);
+    }
+    vr->offsets[0] = 0.0;
+    for (u32 i=from; i<vr->rowCount; i++) {
+        vr->offsets[i+1] = vr->offsets[i] + (double)vr->heightCB(i, vr->args) + (double)vr->gap;
+    }
+}
+
+static void VirtualRows_Unbind_From(VirtualRows* vr, u32 rowIndex)
+{
+    for (u32 p=0; p<vr->rowIndices.size; p++) {
+        u32* bound = Array_Get(&vr->rowIndices, p);
+        if (*bound != UINT32_MAX && *bound >= rowIndex) *bound = UINT32_MAX;
+    }
+}
+
+static inline double VirtualRows_Total_Height(VirtualRows* vr)
+{
+    return vr->rowCount == 0 ? 0.0 : vr->offsets[vr->rowCount] - vr->gap;
+}
+
+// Height above the rows taken by a table header (it stays pinned while the rows scroll)
+static inline float VirtualRows_Header_Height(VirtualRows* vr)
+{
+    NodeP* thead = vr->container->firstChild;
+    if (thead == NULL || thead->type != NU_THEAD || NodeStateHidden(thead)) return 0.0f;
+    return thead->node.height + vr->gap;
+}
+
+static inline double VirtualRows_Inner_Height(NodeP* node)
+{
+    return node->node.height - node->node.padTop - node->node.padBottom - node->node.borderTop - node->node.borderBottom;
+}
+
+// Scrolled distance in pixels, kept in double since the content can be far taller than float resolves
+static double VirtualRows_Scroll_Offset(VirtualRows* vr)
+{
+    double range = VirtualRows_Header_Height(vr) + VirtualRows_Total_Height(vr) - VirtualRows_Inner_Height(vr->container);
+    return range > 0.0 ? (double)vr->container->scrollV * range : 0.0;
+}
+
+// Row whose estimated span contains y (rowCount must be > 0)
+static u32 VirtualRows_Row_At(VirtualRows* vr, double y)
+{
+    u32 lo = 0, hi = vr->rowCount - 1;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo + 1) / 2;
+        if (vr->offsets[mid] <= y) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// Content height reported to layout (and so the scrollbar), covering every row
+float VirtualRows_Content_Height(VirtualRows* vr)
+{
+    if (vr->rowCount == 0) return 0.0f;
+    return VirtualRows_Header_Height(vr) + (float)VirtualRows_Total_Height(vr);
+}
+
+// Stacks the materialized rows from the first one's estimated offset
+void VirtualRows_Position(VirtualRows* vr)
+{
+    NodeP* node = vr->container;
+    float top = node->node.y + node->node.padTop + node->node.borderTop;
+    NodeP* thead = node->firstChild;
+    if (thead != NULL && thead->type == NU_THEAD && !NodeStateHidden(thead)) {
+        thead->node.y += top;
+    }
+    if (vr->count == 0) return;
+
+    u32 poolSize = vr->rows.size;
+    float cursorY = top + VirtualRows_Header_Height(vr) + (float)(vr->offsets[vr->first] - VirtualRows_Scroll_Offset(vr));
+    for (u32 i=vr->first; i<vr->first + vr->count; i++) {
+        NodeP* row = *(NodeP**)Array_Get(&vr->rows, i % poolSize);
+        if (NodeStateHidden(row)) continue;
+        row->node.y += cursorY;
+        cursorY += row->node.height + node->node.gap;
+    }
+}
+
+static void VirtualRows_Grow_Pool(VirtualRows* vr, u32 poolSize)
+{
+    NodeP* template = *(NodeP**)Array_Get(&vr->rows, 0);
+    while (vr->rows.size < poolSize) {
+        NodeP* row = TreeCloneNode(&GUI.tree, template, vr->container, true, NU_Clone_Node_Resources);
+        Array_Push(&vr->rows, &row);
+    }
+
+    // The row -> pool entry mapping depends on the pool size
+    u32 unbound = UINT32_MAX;
+    Array_Clear(&vr->rowIndices);
+    for (u32 p=0; p<poolSize; p++) Array_Push(&vr->rowIndices, &unbound);
+}
+
+// Materializes the rows covering the container's current viewport, binding those that
+// weren't already bound. Returns true if any row was bound, shown or hidden
+static bool VirtualRows_Update(VirtualRows* vr)
+{
+    NodeP* node = vr->container;
+    if (node->node.gap != vr->gap) {
+        vr->gap = node->node.gap;
+        VirtualRows_Sum_Offsets(vr, 0);
+    }
+
+    u32 first = 0, end = 0;
+    if (vr->rowCount > 0) {
+        double scroll = VirtualRows_Scroll_Offset(vr);
+        double view = max(VirtualRows_Inner_Height(node) - VirtualRows_Header_Height(vr), 0.0);
+        first = VirtualRows_Row_At(vr, scroll);
+        end = VirtualRows_Row_At(vr, scroll + view) + 1;
+        first = first > NU_VIRTUAL_OVERSCAN ? first - NU_VIRTUAL_OVERSCAN : 0;
+        end = min(end + NU_VIRTUAL_OVERSCAN, vr->rowCount);
+    }
+    vr->first = first;
+    vr->count = end - first;
+    if (vr->count > vr->rows.size) VirtualRows_Grow_Pool(vr, vr->count);
+
+    bool changed = false;
+    u32 poolSize = vr->rows.size;
+    for (u32 p=0; p<poolSize; p++) {
+        NodeP* row = *(NodeP**)Array_Get(&vr->rows, p);
+        u32* bound = Array_Get(&vr->rowIndices, p);
+        u32 rowIndex = first + (p + poolSize - first % poolSize) % poolSize; // the row in [first, end) held by p
+        if (rowIndex >= end) {
+            if (!(row->layoutFlags & HIDDEN)) { row->layoutFlags |= HIDDEN; changed = true; }
+            continue;
+        }
+        if (row->layoutFlags & HIDDEN) { row->layoutFlags &= ~HIDDEN; changed = true; }
+        if (*bound != rowIndex) {
+            *bound = rowIndex;
+            vr->bindCB(&row->node, rowIndex, vr->args);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Called around NU_Layout. Returns true if any virtual container changed its rows
+bool VirtualRows_Update_All()
+{
+    bool changed = false;
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.virtualRows);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        VirtualRows* vr = *(VirtualRows**)value;
+        if (TreeNodeDetached(&GUI.tree, vr->container)) continue;
+        changed |= VirtualRows_Update(vr);
+    }
+    return changed;
+}
+
+static void VirtualRows_Free(VirtualRows* vr)
+{
+    Array_Free(&vr->rows);
+    Array_Free(&vr->rowIndices);
+    free(vr->offsets);
+    free(vr);
+}
+
+// Turns a vertical scroll container into a virtual one, or updates its row source.
+// The container must hold a single row child (after an optional thead), which becomes the template
+bool VirtualRows_Set(NodeP* container, u32 rowCount, NU_Row_Height_Callback heightCB, NU_Row_Bind_Callback bindCB, void* args)
+{
+    if (heightCB == NULL || bindCB == NULL) return false;
+    VirtualRows* vr = VirtualRows_Get(container);
+    if (vr == NULL) {
+        if ((container->layoutFlags & (OVERFLOW_VERTICAL_SCROLL | LAYOUT_VERTICAL)) != (OVERFLOW_VERTICAL_SCROLL | LAYOUT_VERTICAL)) return false;
+        NodeP* template = container->firstChild;
+        if (template != NULL && template->type == NU_THEAD) template = template->nextSibling;
+        if (template == NULL || template->nextSibling != NULL || template->type == NU_WINDOW || template->type == NU_THEAD) return false;
+
+        vr = calloc(1, sizeof(VirtualRows));
+        vr->container = container;
+        vr->gap = container->node.gap;
+        Array_Init(&vr->rows, sizeof(NodeP*), 32);
+        Array_Init(&vr->rowIndices, sizeof(u32), 32);
+        u32 unbound = UINT32_MAX;
+        Array_Push(&vr->rows, &template);
+        Array_Push(&vr->rowIndices, &unbound);
+        container->layoutFlags |= VIRTUAL_ROWS;
+        Hashmap_Set(&GUI.virtualRows, &container, &vr);
+    }
+    else {
+        VirtualRows_Unbind_From(vr, 0);
+    }
+
+    vr->rowCount = rowCount;
+    vr->heightCB = heightCB;
+    vr->bindCB = bindCB;
+    vr->args = args;
+    VirtualRows_Sum_Offsets(vr, 0);
+    GUI.awaiting_redraw = true;
+    return true;
+}
+
+// Appending rows only estimates the new ones, rows already bound below the old count stay bound
+bool VirtualRows_Set_Count(NodeP* container, u32 rowCount)
+{
+    VirtualRows* vr = VirtualRows_Get(container);
+    if (vr == NULL) return false;
+    u32 prevCount = vr->rowCount;
+    vr->rowCount = rowCount;
+    if (rowCount > prevCount) VirtualRows_Sum_Offsets(vr, prevCount);
+    else VirtualRows_Unbind_From(vr, rowCount);
+    GUI.awaiting_redraw = true;
+    return true;
+}
+
+// Binds every materialized row again on the next layout. With reestimate the heights are summed again too
+bool VirtualRows_Refresh(NodeP* container, bool reestimate)
+{
+    VirtualRows* vr = VirtualRows_Get(container);
+    if (vr == NULL) return false;
+    VirtualRows_Unbind_From(vr, 0);
+    if (reestimate) VirtualRows_Sum_Offsets(vr, 0);
+    GUI.awaiting_redraw = true;
+    return true;
+}
+
+// Drops the pool and shows the template as an ordinary child again
+void VirtualRows_End(NodeP* container)
+{
+    VirtualRows* vr = VirtualRows_Get(container);
+    if (vr == NULL) return;
+    Hashmap_Delete(&GUI.virtualRows, &container);
+    container->layoutFlags &= ~VIRTUAL_ROWS;
+
+    NodeP* template = *(NodeP**)Array_Get(&vr->rows, 0);
+    template->layoutFlags &= ~HIDDEN;
+    for (u32 p=1; p<vr->rows.size; p++) {
+        NU_Internal_Delete_Node(*(NodeP**)Array_Get(&vr->rows, p));
+    }
+    VirtualRows_Free(vr);
+    GUI.awaiting_redraw = true;
+}
+
+// Called when a container is torn down by the sweep (its rows are swept with it)
+void VirtualRows_Delete(NodeP* container)
+{
+    VirtualRows* vr = VirtualRows_Get(container);
+    if (vr == NULL) return;
+    Hashmap_Delete(&GUI.virtualRows, &container);
+    VirtualRows_Free(vr);
+}
+
+void VirtualRows_Free_All()
+{
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.virtualRows);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        VirtualRows_Free(*(VirtualRows**)value);
+    }
+    Hashmap_Free(&GUI.virtualRows);
+}
+
+// Points containers and pools at relocated node records (see TreeCompact)
+void VirtualRows_Remap(Hashmap* remap)
+{
+    if (GUI.virtualRows.itemCount == 0) return;
+    Hashmap_RemapKeys(&GUI.virtualRows, remap);
+    HashmapIterator it = Hashmap_CreateIterator(&GUI.virtualRows);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        VirtualRows* vr = *(VirtualRows**)value;
+        vr->container = TreeRemapNode(remap, vr->container);
+        for (u32 p=0; p<vr->rows.size; p++) {
+            NodeP** row = Array_Get(&vr->rows, p);
+            *row = TreeRemapNode(remap, *row);
+        }
+    }
+}
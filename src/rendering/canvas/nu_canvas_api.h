@@ -2,208 +2,468 @@
 #include <rendering/nu_renderer_structures.h>
 #include <text/nu_text_layout.h>
 #include <math.h>
+#include <float.h>
+#include <emmintrin.h>
 
 #define NORMALIZE(dx, dy) do { float len = sqrtf((dx)*(dx) + (dy)*(dy)); if (len > 0.0001f) { dx /= len; dy /= len; } } while(0)
 
-int NU_Internal_Get_Canvas_Context(Node* node)
+static void CanvasDrawBuffer_Init(CanvasDrawBuffer* buf)
 {
-    NodeP* nodeP = NODEP_OF(node);
-    if (nodeP->type != NU_CANVAS) return -1;
-    if (nodeP->typeData.canvas.ctxHandle != -1) return nodeP->typeData.canvas.ctxHandle;
-
-    // Create a new canvas ctx
-    NU_Canvas_Context ctx;
-    ctx.isShapeLayer = true; 
-    ctx.fontID = 0;
-    ctx.z = 1;
-    ctx.textLayerIndex = 0;
-    ctx.node = nodeP;
-    Array_Init(&ctx.textLayers, sizeof(CanvasTextLayer), 4);
+    buf->isShapeLayer = true; 
+    buf->isPrimitive = false;
+    buf->fontID = 0;
+    buf->z = 1;
+    buf->textLayerIndex = 0;
+    buf->textLayerCount = 1;
+    Array_Init(&buf->textLayers, sizeof(CanvasTextLayer), 4);
+
+    // Create identity transform (bottom of the transform stack)
+    CanvasTransform identity = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0 };
+    Array_Init(&buf->transforms, sizeof(CanvasTransform), 4);
+    Array_Push(&buf->transforms, &identity);
+    buf->transformIndex = 0;
 
     // Create default text layer
     CanvasTextLayer textLayer;
     textLayer.fontID = 0;
     Vertex_RGB_UV_List_Init(&textLayer.vertices, 256);
     Index_List_Init(&textLayer.indices, 512);
-    Array_Push(&ctx.textLayers, &textLayer);
+    Array_Init(&textLayer.ranges, sizeof(CanvasDrawRange), 4);
+    Array_Push(&buf->textLayers, &textLayer);
 
     // Create shape layer
-    Vertex_RGB_List_Init(&ctx.shapeLayer.vertices, 1024);
-    Index_List_Init(&ctx.shapeLayer.indices, 2048);
-
-    // Add ctx
-    int ctxId = Container_Add(&GUI.canvasContexts, &ctx);
-    nodeP->typeData.canvas.ctxHandle = ctxId;
-    return ctxId;
+    Vertex_RGB_List_Init(&buf->shapeLayer.vertices, 1024);
+    Index_List_Init(&buf->shapeLayer.indices, 2048);
+    Array_Init(&buf->shapeLayer.primitives, sizeof(CanvasPrimitiveRenderData), 256);
+    Array_Init(&buf->shapeLayer.meshRanges, sizeof(CanvasDrawRange), 4);
+    Array_Init(&buf->shapeLayer.primitiveRanges, sizeof(CanvasDrawRange), 4);
 }
 
-void NU_DeleteCanvasContext(int contextID)
+static void CanvasDrawBuffer_Free(CanvasDrawBuffer* buf)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
-
     // Free vertices and indices of each layer
-    for (u32 i=0; i<ctx->textLayers.size; i++) {
-        CanvasTextLayer* layer = Array_Get(&ctx->textLayers, i);
+    for (u32 i=0; i<buf->textLayers.size; i++) {
+        CanvasTextLayer* layer = Array_Get(&buf->textLayers, i);
         Vertex_RGB_UV_List_Free(&layer->vertices);
         Index_List_Free(&layer->indices);
+        Array_Free(&layer->ranges);
     }
-    Array_Free(&ctx->textLayers);
+    Array_Free(&buf->textLayers);
+    Array_Free(&buf->transforms);
 
     // Free vertices and indices of shape layer
-    Vertex_RGB_List_Free(&ctx->shapeLayer.vertices);
-    Index_List_Free(&ctx->shapeLayer.indices);
-
-    // Remove ctx
-    Container_Remove(&GUI.canvasContexts, contextID);
+    Vertex_RGB_List_Free(&buf->shapeLayer.vertices);
+    Index_List_Free(&buf->shapeLayer.indices);
+    Array_Free(&buf->shapeLayer.primitives);
+    Array_Free(&buf->shapeLayer.meshRanges);
+    Array_Free(&buf->shapeLayer.primitiveRanges);
 }
 
-void NU_Internal_Clear_Canvas(int contextID)
+static void CanvasDrawBuffer_Clear(CanvasDrawBuffer* buf)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
-
-    // Clear vertices and indices of each text layer (except layer 0)
-    for (u32 i=0; i<ctx->textLayers.size; i++) {
-        CanvasTextLayer* layer = Array_Get(&ctx->textLayers, i);
+    // Clear vertices and indices of each text layer
+    for (u32 i=0; i<buf->textLayers.size; i++) {
+        CanvasTextLayer* layer = Array_Get(&buf->textLayers, i);
         Vertex_RGB_UV_List_Clear(&layer->vertices);
         Index_List_Clear(&layer->indices);
+        Array_Clear(&layer->ranges);
         layer->fontID = 0;
     }
 
     // Clear vertices and indices of shape layer
-    Vertex_RGB_List_Clear(&ctx->shapeLayer.vertices);
-    Index_List_Clear(&ctx->shapeLayer.indices);
+    Vertex_RGB_List_Clear(&buf->shapeLayer.vertices);
+    Index_List_Clear(&buf->shapeLayer.indices);
+    Array_Clear(&buf->shapeLayer.primitives);
+    Array_Clear(&buf->shapeLayer.meshRanges);
+    Array_Clear(&buf->shapeLayer.primitiveRanges);
+
+    // Keep only the identity transform
+    buf->transforms.size = 1;
+    buf->transformIndex = 0;
 
     // Reset state
-    ctx->fontID = 0;
-    ctx->z = 1;
-    ctx->textLayerIndex = 0;
-    ctx->isShapeLayer = true;
+    buf->fontID = 0;
+    buf->z = 1;
+    buf->textLayerIndex = 0;
+    buf->textLayerCount = 1;
+    buf->isShapeLayer = true;
+    buf->isPrimitive = false;
 }
 
-void NU_Internal_Border_Rect(
-    int contextID,
-    float x, float y, float w, float h, 
-    float thickness,
-    NU_RGB border_col,
-    NU_RGB fill_col)
+static void CanvasArray_Copy(Array* dst, Array* src)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    dst->size = 0;
+    Array_Reserve(dst, src->size);
+    memcpy(dst->data, src->data, src->size * src->elementSize);
+    dst->size = src->size;
+}
 
-    // Constrain dimensions based on thickness
-    w = fmaxf(w, thickness * 2);
-    h = fmaxf(h, thickness * 2);
+// Copies everything recorded into src (dst is initialised and empty)
+static void CanvasDrawBuffer_Copy(CanvasDrawBuffer* dst, CanvasDrawBuffer* src)
+{
+    // Text layers
+    for (u32 i=0; i<src->textLayers.size; i++) {
+        if (i >= dst->textLayers.size) {
+            CanvasTextLayer textLayer;
+            Vertex_RGB_UV_List_Init(&textLayer.vertices, 256);
+            Index_List_Init(&textLayer.indices, 512);
+            Array_Init(&textLayer.ranges, sizeof(CanvasDrawRange), 4);
+            Array_Push(&dst->textLayers, &textLayer);
+        }
+        CanvasTextLayer* from = Array_Get(&src->textLayers, i);
+        CanvasTextLayer* to = Array_Get(&dst->textLayers, i);
+        to->fontID = from->fontID;
+        if (from->vertices.size > to->vertices.capacity) Vertex_RGB_UV_List_Grow(&to->vertices, from->vertices.size - to->vertices.capacity);
+        if (from->indices.size > to->indices.capacity) Index_List_Grow(&to->indices, from->indices.size - to->indices.capacity);
+        memcpy(to->vertices.array, from->vertices.array, from->vertices.size * sizeof(vertex_rgb_uv));
+        memcpy(to->indices.array, from->indices.array, from->indices.size * sizeof(GLuint));
+        to->vertices.size = from->vertices.size;
+        to->indices.size = from->indices.size;
+        CanvasArray_Copy(&to->ranges, &from->ranges);
+    }
 
-    // Skip function if rect is not visible
-    if (x + w < 0.0f || x > ctx->canvasWidth || y + h < 0.0f || y > ctx->canvasHeight) return;
+    // Shape layer
+    CanvasShapeLayer* from = &src->shapeLayer;
+    CanvasShapeLayer* to = &dst->shapeLayer;
+    if (from->vertices.size > to->vertices.capacity) Vertex_RGB_List_Grow(&to->vertices, from->vertices.size - to->vertices.capacity);
+    if (from->indices.size > to->indices.capacity) Index_List_Grow(&to->indices, from->indices.size - to->indices.capacity);
+    memcpy(to->vertices.array, from->vertices.array, from->vertices.size * sizeof(vertex_rgb));
+    memcpy(to->indices.array, from->indices.array, from->indices.size * sizeof(GLuint));
+    to->vertices.size = from->vertices.size;
+    to->indices.size = from->indices.size;
+    CanvasArray_Copy(&to->primitives, &from->primitives);
+    CanvasArray_Copy(&to->meshRanges, &from->meshRanges);
+    CanvasArray_Copy(&to->primitiveRanges, &from->primitiveRanges);
+
+    // Transform stack and recording state
+    CanvasArray_Copy(&dst->transforms, &src->transforms);
+    dst->transformIndex = src->transformIndex;
+    dst->isShapeLayer = src->isShapeLayer;
+    dst->isPrimitive = src->isPrimitive;
+    dst->fontID = src->fontID;
+    dst->z = src->z;
+    dst->textLayerIndex = src->textLayerIndex;
+    dst->textLayerCount = src->textLayerCount;
+}
 
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
-    }
+static NU_Canvas_Context* NU_Canvas_Create(NodeP* nodeP)
+{
+    NU_Canvas_Context* ctx = malloc(sizeof(NU_Canvas_Context));
+    CanvasDrawBuffer_Init(&ctx->buffers[0]);
+    CanvasDrawBuffer_Init(&ctx->buffers[1]);
+    SDL_SetAtomicInt(&ctx->front, 0);
+    SDL_SetAtomicInt(&ctx->doubleBuffered, 0);
+    ctx->swapMutex = SDL_CreateMutex();
+    ctx->decimate = true;
+    ctx->canvasWidth = 0.0f;
+    ctx->canvasHeight = 0.0f;
+    ctx->node = nodeP;
+    SDL_SetAtomicInt(&ctx->layer, nodeP->layer);
+    ctx->refs = 1;
+    SDL_SetAtomicInt(&ctx->dirty, 1);
+    CanvasRenderCache_Init(&ctx->cache);
+    return ctx;
+}
 
-    // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
+static int NU_Canvas_Add(NodeP* nodeP, NU_Canvas_Context* ctx)
+{
+    SDL_LockMutex(GUI.canvasMutex);
+    int ctxId = Container_Add(&GUI.canvasContexts, &ctx);
+    SDL_UnlockMutex(GUI.canvasMutex);
+    nodeP->typeData.canvas.ctxHandle = ctxId;
+    return ctxId;
+}
 
-    // --- Allocate extra space in vertex and index lists ---
-    u32 additional_vertices = 12;    
-    u32 additional_indices = 30;          
-    if (vertices->size + additional_vertices > vertices->capacity) Vertex_RGB_List_Grow(vertices, additional_vertices);
-    if (indices->size + additional_indices > indices->capacity) Index_List_Grow(indices, additional_indices);
+int NU_Internal_Get_Canvas_Context(Node* node)
+{
+    NodeP* nodeP = NODEP_OF(node);
+    if (nodeP->type != NU_CANVAS) return -1;
+    if (nodeP->typeData.canvas.ctxHandle != -1) return nodeP->typeData.canvas.ctxHandle;
+    return NU_Canvas_Add(nodeP, NU_Canvas_Create(nodeP));
+}
 
-    u32 vertex_offset = vertices->size;
+// UI thread only, the UI thread is the only one deleting contexts
+static NU_Canvas_Context* NU_Canvas_Get(int contextID)
+{
+    SDL_LockMutex(GUI.canvasMutex);
+    NU_Canvas_Context** found = Container_Get(&GUI.canvasContexts, contextID);
+    NU_Canvas_Context* ctx = found ? *found : NULL;
+    SDL_UnlockMutex(GUI.canvasMutex);
+    return ctx;
+}
+
+static void NU_Canvas_Free(NU_Canvas_Context* ctx)
+{
+    CanvasDrawBuffer_Free(&ctx->buffers[0]);
+    CanvasDrawBuffer_Free(&ctx->buffers[1]);
+    SDL_DestroyMutex(ctx->swapMutex);
+    free(ctx);
+}
 
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
+// Safe to call from any thread. The context stays alive until the matching
+// NU_Canvas_Release, even if its node is deleted in the meantime
+NU_Canvas_Context* NU_Canvas_Acquire(int contextID)
+{
+    SDL_LockMutex(GUI.canvasMutex);
+    NU_Canvas_Context** found = Container_Get(&GUI.canvasContexts, contextID);
+    NU_Canvas_Context* ctx = found ? *found : NULL;
+    if (ctx != NULL) ctx->refs++;
+    SDL_UnlockMutex(GUI.canvasMutex);
+    return ctx;
+}
+
+void NU_Canvas_Release(NU_Canvas_Context* ctx)
+{
+    SDL_LockMutex(GUI.canvasMutex);
+    bool last = --ctx->refs == 0;
+    SDL_UnlockMutex(GUI.canvasMutex);
+    if (last) NU_Canvas_Free(ctx);
+}
+
+// Context the calling thread records into between NU_Canvas_Begin and NU_Canvas_Commit. The
+// session holds one reference, so its draw calls skip the lookup and GUI.canvasMutex
+__declspec(thread) NU_Canvas_Context* canvasSessionCtx = NULL;
+__declspec(thread) int canvasSessionID = -1;
+
+void NU_Canvas_End_Session()
+{
+    if (canvasSessionCtx == NULL) return;
+    NU_Canvas_Context* ctx = canvasSessionCtx;
+    canvasSessionCtx = NULL;
+    canvasSessionID = -1;
+    NU_Canvas_Release(ctx);
+}
+
+void NU_Canvas_Begin_Session(int contextID)
+{
+    NU_Canvas_End_Session();
+    canvasSessionCtx = NU_Canvas_Acquire(contextID);
+    if (canvasSessionCtx != NULL) canvasSessionID = contextID;
+}
+
+// Context for one API call: the thread's session context, otherwise a reference held for the call
+static inline NU_Canvas_Context* NU_Canvas_Use(int contextID)
+{
+    if (contextID == canvasSessionID) return canvasSessionCtx;
+    return NU_Canvas_Acquire(contextID);
+}
+
+static inline void NU_Canvas_Done(NU_Canvas_Context* ctx)
+{
+    if (ctx != canvasSessionCtx) NU_Canvas_Release(ctx);
+}
 
-    // Outer TL
-    vertices->array[vertex_offset] = (vertex_rgb){ x, y, z, border_col.r, border_col.g, border_col.b };
+// Keeps the layer snapshot of canvases in a subtree current after it moved levels
+void NU_Canvas_Sync_Layers(NodeP* root)
+{
+    if (GUI.canvasContexts.size == 0) return;
+    DepthFirstSearch dfs = DepthFirstSearch_Create(root);
+    NodeP* node;
+    while (DepthFirstSearch_Next(&dfs, &node)) {
+        if (node->type != NU_CANVAS || node->typeData.canvas.ctxHandle == -1) continue;
+        NU_Canvas_Context* ctx = NU_Canvas_Get(node->typeData.canvas.ctxHandle);
+        if (ctx != NULL) SDL_SetAtomicInt(&ctx->layer, node->layer);
+    }
+    DepthFirstSearch_Free(&dfs);
+}
 
-    // Outer TR
-    vertices->array[vertex_offset + 1] = (vertex_rgb){ x + w, y, z, border_col.r, border_col.g, border_col.b };
+static inline CanvasDrawBuffer* NU_Canvas_Front(NU_Canvas_Context* ctx)
+{
+    return &ctx->buffers[SDL_GetAtomicInt(&ctx->front)];
+}
 
-    // Outer BL
-    vertices->array[vertex_offset + 2] = (vertex_rgb){ x, y + h, z, border_col.r, border_col.g, border_col.b };
+static inline CanvasDrawBuffer* NU_Canvas_Back(NU_Canvas_Context* ctx)
+{
+    int front = SDL_GetAtomicInt(&ctx->front);
+    return &ctx->buffers[SDL_GetAtomicInt(&ctx->doubleBuffered) ? front ^ 1 : front];
+}
 
-    // Outer BR
-    vertices->array[vertex_offset + 3] = (vertex_rgb){ x + w, y + h, z, border_col.r, border_col.g, border_col.b };
+// Buffer for draw calls to record into. Single buffered contexts record straight
+// into the front buffer, so the cached render is invalidated right away
+static CanvasDrawBuffer* NU_Canvas_Record_Buffer(NU_Canvas_Context* ctx)
+{
+    int front = SDL_GetAtomicInt(&ctx->front);
+    if (SDL_GetAtomicInt(&ctx->doubleBuffered)) return &ctx->buffers[front ^ 1];
+    SDL_SetAtomicInt(&ctx->dirty, 1);
+    return &ctx->buffers[front];
+}
 
-    // Inner TL
-    vertices->array[vertex_offset + 4] = (vertex_rgb){ x + thickness, y + thickness, z, border_col.r, border_col.g, border_col.b };
+// UI thread only. Gives a cloned canvas node its own context showing what src's context shows
+// (its front buffer, transform stack and settings). Nothing is created if src has no context
+void NU_Canvas_Clone_Context(NodeP* clone, NodeP* src)
+{
+    clone->typeData.canvas.ctxHandle = -1;
+    if (src->typeData.canvas.ctxHandle == -1) return;
+    NU_Canvas_Context* srcCtx = NU_Canvas_Get(src->typeData.canvas.ctxHandle);
+    if (srcCtx == NULL) return;
+
+    NU_Canvas_Context* ctx = NU_Canvas_Create(clone);
+    ctx->decimate = srcCtx->decimate;
+    ctx->canvasWidth = srcCtx->canvasWidth;
+    ctx->canvasHeight = srcCtx->canvasHeight;
+    SDL_SetAtomicInt(&ctx->doubleBuffered, SDL_GetAtomicInt(&srcCtx->doubleBuffered));
+    SDL_LockMutex(srcCtx->swapMutex); // a worker may be committing into src
+    CanvasDrawBuffer_Copy(NU_Canvas_Front(ctx), NU_Canvas_Front(srcCtx));
+    SDL_UnlockMutex(srcCtx->swapMutex);
+    NU_Canvas_Add(clone, ctx);
+}
 
-    // Inner TR
-    vertices->array[vertex_offset + 5] = (vertex_rgb){ x + w - thickness, y + thickness, z, border_col.r, border_col.g, border_col.b };
+// UI thread only. Workers still recording into the context keep it alive, the last
+// NU_Canvas_Release frees it
+void NU_DeleteCanvasContext(int contextID)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Get(contextID); 
+    if (ctx == NULL) return;
+    ctx->node = NULL;
 
-    // Inner BL
-    vertices->array[vertex_offset + 6] = (vertex_rgb){ x + thickness, y + h - thickness, z, border_col.r, border_col.g, border_col.b };
+    // Free cached render target (GL resources belong to the UI thread)
+    CanvasRenderCache_Free(&ctx->cache);
 
-    // Inner BR
-    vertices->array[vertex_offset + 7] = (vertex_rgb){ x + w - thickness, y + h - thickness, z, border_col.r, border_col.g, border_col.b };
+    // Remove ctx, dropping the list's reference
+    SDL_LockMutex(GUI.canvasMutex);
+    Container_Remove(&GUI.canvasContexts, contextID);
+    bool last = --ctx->refs == 0;
+    SDL_UnlockMutex(GUI.canvasMutex);
+    if (last) NU_Canvas_Free(ctx);
+}
 
-    // Fill TL
-    vertices->array[vertex_offset + 8] = (vertex_rgb){ x + thickness, y + thickness, z, fill_col.r, fill_col.g, fill_col.b };
+void NU_Internal_Clear_Canvas(NU_Canvas_Context* ctx)
+{
+    CanvasDrawBuffer_Clear(NU_Canvas_Record_Buffer(ctx));
+}
 
-    // Fill TR
-    vertices->array[vertex_offset + 9] = (vertex_rgb){ x + w - thickness, y + thickness, z, fill_col.r, fill_col.g, fill_col.b };
+void NU_Internal_Set_Canvas_Double_Buffered(NU_Canvas_Context* ctx, bool enabled)
+{
+    SDL_LockMutex(ctx->swapMutex);
+    if ((SDL_GetAtomicInt(&ctx->doubleBuffered) != 0) != enabled) {
+        SDL_SetAtomicInt(&ctx->doubleBuffered, enabled);
+        CanvasDrawBuffer_Clear(&ctx->buffers[SDL_GetAtomicInt(&ctx->front) ^ 1]);
+    }
+    SDL_UnlockMutex(ctx->swapMutex);
+}
 
-    // Fill BL
-    vertices->array[vertex_offset + 10] = (vertex_rgb){ x + thickness, y + h - thickness, z, fill_col.r, fill_col.g, fill_col.b };
+// Publishes everything recorded into the back buffer since the last commit. The
+// old front buffer becomes the (cleared) back buffer for the next recording
+void NU_Internal_Canvas_Commit(NU_Canvas_Context* ctx)
+{
+    SDL_LockMutex(ctx->swapMutex);
+    if (!SDL_GetAtomicInt(&ctx->doubleBuffered)) {
+        SDL_UnlockMutex(ctx->swapMutex);
+        return;
+    }
+    int front = SDL_GetAtomicInt(&ctx->front) ^ 1;
+    SDL_SetAtomicInt(&ctx->front, front);
+    SDL_SetAtomicInt(&ctx->dirty, 1);
+    SDL_UnlockMutex(ctx->swapMutex);
+    CanvasDrawBuffer_Clear(&ctx->buffers[front ^ 1]);
+
+    // Request a redraw (SDL_PushEvent is thread safe). Headless guis have no event loop,
+    // NU_Render_To_Framebuffer always reads the latest front buffer
+    if (GUI.headless) return;
+    SDL_Event e;
+    SDL_zero(e);
+    e.type = GUI.SDL_CUSTOM_RENDER_EVENT;
+    SDL_PushEvent(&e);
+}
 
-    // Fill BR
-    vertices->array[vertex_offset + 11] = (vertex_rgb){ x + w - thickness, y + h - thickness, z, fill_col.r, fill_col.g, fill_col.b };
+// Starts a new draw range if geometry appended at start uses a different transform
+static void NU_Canvas_Mark_Range(Array* ranges, u32 start, u32 vertexStart, int transform)
+{
+    CanvasDrawRange* last = ranges->size ? Array_Get(ranges, ranges->size - 1) : NULL;
+    if ((last ? last->transform : 0) == transform) return;
+    if (last && last->start == start) {
+        last->transform = transform; // previous range is empty
+        return;
+    }
+    CanvasDrawRange range = { start, vertexStart, transform };
+    Array_Push(ranges, &range);
+}
 
-    // Indices
-    u32* indices_write = indices->array + indices->size;
+// Transformed geometry can be panned into view later, so it is never culled
+static inline bool NU_Canvas_Culling(CanvasDrawBuffer* buf)
+{
+    return buf->transformIndex == 0;
+}
 
-    // Top border face
-    *indices_write++ = vertex_offset;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 4;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 4;
-    *indices_write++ = vertex_offset + 5;
+// Meshes, SDF primitives and text are drawn as separate batches. Switching between
+// them moves to the next depth step so the batches still overlap in call order.
+// Call before appending shape geometry, so it lands in the current transform's range
+static float NU_Canvas_Shape_Depth(NU_Canvas_Context* ctx, CanvasDrawBuffer* buf, bool primitive)
+{
+    if (!buf->isShapeLayer || buf->isPrimitive != primitive) {
+        buf->isShapeLayer = true;
+        buf->isPrimitive = primitive;
+        buf->z++;
+    }
+    CanvasShapeLayer* layer = &buf->shapeLayer;
+    if (primitive) NU_Canvas_Mark_Range(&layer->primitiveRanges, layer->primitives.size, 0, buf->transformIndex);
+    else NU_Canvas_Mark_Range(&layer->meshRanges, layer->indices.size, layer->vertices.size, buf->transformIndex);
+    return (float)SDL_GetAtomicInt(&ctx->layer) + buf->z * 0.005f;
+}
 
-    // Right border face
-    *indices_write++ = vertex_offset + 5;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 3;
-    *indices_write++ = vertex_offset + 5;
-    *indices_write++ = vertex_offset + 7;
-    *indices_write++ = vertex_offset + 3;
+static inline u32 NU_Canvas_Pack_RGB(NU_RGB col)
+{
+    return PackRGBA(
+        (u8)(fminf(fmaxf(col.r, 0.0f), 1.0f) * 255.0f + 0.5f), 
+        (u8)(fminf(fmaxf(col.g, 0.0f), 1.0f) * 255.0f + 0.5f), 
+        (u8)(fminf(fmaxf(col.b, 0.0f), 1.0f) * 255.0f + 0.5f), 
+        255);
+}
 
-    // Bottom border face
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 7;
-    *indices_write++ = vertex_offset + 3;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 6;
-    *indices_write++ = vertex_offset + 7;
+static CanvasPrimitiveRenderData* NU_Canvas_Push_Line_Primitive(
+    NU_Canvas_Context* ctx,
+    CanvasDrawBuffer* buf,
+    float x1, float y1, float x2, float y2,
+    float thickness,
+    NU_RGB col)
+{
+    float z = NU_Canvas_Shape_Depth(ctx, buf, true);
+    CanvasPrimitiveRenderData* line = Array_PushEmpty(&buf->shapeLayer.primitives);
+    line->x0 = x1; line->y0 = y1;
+    line->x1 = x2; line->y1 = y2;
+    line->z = z;
+    line->thickness = thickness;
+    line->radius = 0.0f;
+    line->kind = CANVAS_PRIMITIVE_LINE;
+    line->fillRGBA = 0;
+    line->strokeRGBA = NU_Canvas_Pack_RGB(col);
+    line->dashCount = 0.0f;
+    line->dashPhase = 0.0f;
+    return line;
+}
 
-    // Left border face
-    *indices_write++ = vertex_offset + 0;
-    *indices_write++ = vertex_offset + 4;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 4;
-    *indices_write++ = vertex_offset + 6;
+void NU_Internal_Border_Rect(
+    NU_Canvas_Context* ctx,
+    float x, float y, float w, float h, 
+    float thickness,
+    NU_RGB border_col,
+    NU_RGB fill_col)
+{
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
-    // Center face
-    *indices_write++ = vertex_offset + 8;
-    *indices_write++ = vertex_offset + 9;
-    *indices_write++ = vertex_offset + 10;
-    *indices_write++ = vertex_offset + 9;
-    *indices_write++ = vertex_offset + 10;
-    *indices_write++ = vertex_offset + 11;
+    // Constrain dimensions based on thickness
+    w = fmaxf(w, thickness * 2);
+    h = fmaxf(h, thickness * 2);
 
-    vertices->size += additional_vertices;
-    indices->size += additional_indices;
+    // Skip function if rect is not visible
+    if (NU_Canvas_Culling(buf) && (x + w < 0.0f || x > ctx->canvasWidth || y + h < 0.0f || y > ctx->canvasHeight)) return;
+
+    float z = NU_Canvas_Shape_Depth(ctx, buf, true);
+    CanvasPrimitiveRenderData* rect = Array_PushEmpty(&buf->shapeLayer.primitives);
+    rect->x0 = x; rect->y0 = y;
+    rect->x1 = x + w; rect->y1 = y + h;
+    rect->z = z;
+    rect->thickness = thickness;
+    rect->radius = 0.0f;
+    rect->kind = CANVAS_PRIMITIVE_RECT;
+    rect->fillRGBA = NU_Canvas_Pack_RGB(fill_col);
+    rect->strokeRGBA = NU_Canvas_Pack_RGB(border_col);
+    rect->dashCount = 0.0f;
+    rect->dashPhase = 0.0f;
 }
 
 void NU_Internal_Triangle(
-    int contextID,
+    NU_Canvas_Context* ctx,
     float x1, float y1, 
     float x2, float y2, 
     float x3, float y3,
@@ -211,27 +471,20 @@ void NU_Internal_Triangle(
     NU_RGB border_col,
     NU_RGB fill_col)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     // Skip if triangle is offscreen
     float minX = fminf(x1, fminf(x2, x3));
     float maxX = fmaxf(x1, fmaxf(x2, x3));
     float minY = fminf(y1, fminf(y2, y3));
     float maxY = fmaxf(y1, fmaxf(y2, y3));
-    if (maxX < 0.0f || minX > ctx->canvasWidth || maxY < 0.0f || minY > ctx->canvasHeight) return;
-
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
-    }
+    if (NU_Canvas_Culling(buf) && (maxX < 0.0f || minX > ctx->canvasWidth || maxY < 0.0f || minY > ctx->canvasHeight)) return;
 
     // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
+    Vertex_RGB_List* vertices = &buf->shapeLayer.vertices;
+    Index_List* indices = &buf->shapeLayer.indices;
 
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
+    float z = NU_Canvas_Shape_Depth(ctx, buf, false);
 
     // --- Allocate extra space in vertex and index lists ---
     u32 additional_vertices = 6;    
@@ -242,9 +495,9 @@ void NU_Internal_Triangle(
     u32 vertex_offset = vertices->size;
     
     // --- Outer triangle (border) ---
-    vertices->array[vertex_offset + 0] = (vertex_rgb){ x1, y1, border_col.r, border_col.g, border_col.b };
-    vertices->array[vertex_offset + 1] = (vertex_rgb){ x2, y2, border_col.r, border_col.g, border_col.b };
-    vertices->array[vertex_offset + 2] = (vertex_rgb){ x3, y3, border_col.r, border_col.g, border_col.b };
+    vertices->array[vertex_offset + 0] = (vertex_rgb){ x1, y1, z, border_col.r, border_col.g, border_col.b };
+    vertices->array[vertex_offset + 1] = (vertex_rgb){ x2, y2, z, border_col.r, border_col.g, border_col.b };
+    vertices->array[vertex_offset + 2] = (vertex_rgb){ x3, y3, z, border_col.r, border_col.g, border_col.b };
 
     // Compute inward offset (very simple approximation using centroid)
     float cx = (x1 + x2 + x3) / 3.0f;
@@ -305,146 +558,76 @@ void NU_Internal_Triangle(
     indices->size += additional_indices;
 }
 
-void NU_Internal_Vline(int contextID, float x, float y, float height, float thickness, NU_RGB col)
+void NU_Internal_Vline(NU_Canvas_Context* ctx, float x, float y, float height, float thickness, NU_RGB col)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     float canvasWidth = ctx->canvasWidth;
     float canvasHeight = ctx->canvasHeight;
 
-    // Skip if line is not visible on canvas
-    if (x < -thickness || x > canvasWidth + thickness || y > canvasHeight || y + height < 0.0f) return;
-
-    // Constrain to avoid large numbers
-    if (y < 0.0f) y = 0.0f;
-    if (y + height > canvasHeight) height = canvasHeight - y;
+    if (NU_Canvas_Culling(buf)) {
+        // Skip if line is not visible on canvas
+        if (x < -thickness || x > canvasWidth + thickness || y > canvasHeight || y + height < 0.0f) return;
 
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
+        // Constrain to avoid large numbers
+        if (y < 0.0f) y = 0.0f;
+        if (y + height > canvasHeight) height = canvasHeight - y;
     }
 
-    // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
-
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
-
-    // --- Allocate extra space in vertex and index lists ---
-    u32 additional_vertices = 4;    
-    u32 additional_indices = 6;          
-    if (vertices->size + additional_vertices > vertices->capacity) Vertex_RGB_List_Grow(vertices, additional_vertices);
-    if (indices->size + additional_indices > indices->capacity) Index_List_Grow(indices, additional_indices);
-
-    // Add pixel alignment offset
+    // Pixel alignment offset
     x += 0.5f;
-    float half_thick = thickness * 0.5f;
- 
-    // Create mesh
-    u32 vertex_offset = vertices->size;
-    vertices->array[vertex_offset] = (vertex_rgb){ x - half_thick, y, z, col.r, col.g, col.b }; // Bottom point (y) - thick -
-    vertices->array[vertex_offset + 1] = (vertex_rgb){ x + half_thick, y, z, col.r, col.g, col.b }; // Bottom point (y) - thick + 
-    vertices->array[vertex_offset + 2] = (vertex_rgb){ x - half_thick, y + height, z, col.r, col.g, col.b }; // Top point (y1) - thick -
-    vertices->array[vertex_offset + 3] = (vertex_rgb){ x + half_thick, y + height, z, col.r, col.g, col.b }; // Top point (y1) - thick + 
-
-    // Indices
-    u32* indices_write = indices->array + indices->size;
-    *indices_write++ = vertex_offset;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 3;
-
-    vertices->size += additional_vertices;
-    indices->size += additional_indices;
+    NU_Canvas_Push_Line_Primitive(ctx, buf, x, y, x, y + height, thickness, col);
 }
 
-void NU_Internal_Hline(int contextID, float x, float y, float width, float thickness, NU_RGB col)
+void NU_Internal_Hline(NU_Canvas_Context* ctx, float x, float y, float width, float thickness, NU_RGB col)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     float canvasWidth = ctx->canvasWidth;
     float canvasHeight = ctx->canvasHeight;
 
-    // Skip if line is not visible on canvas
-    if (y < -thickness || y > canvasHeight + thickness || x > canvasWidth || x + width < 0.0f) return;
-
-    // Constrain to avoid large numbers
-    if (x < 0.0f) x = 0.0f;
-    if (x + width > canvasWidth) width = canvasWidth - x;
+    if (NU_Canvas_Culling(buf)) {
+        // Skip if line is not visible on canvas
+        if (y < -thickness || y > canvasHeight + thickness || x > canvasWidth || x + width < 0.0f) return;
 
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
+        // Constrain to avoid large numbers
+        if (x < 0.0f) x = 0.0f;
+        if (x + width > canvasWidth) width = canvasWidth - x;
     }
 
-    // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
-
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
-
-    // --- Allocate extra space in vertex and index lists ---
-    u32 additional_vertices = 4;    
-    u32 additional_indices = 6;          
-    if (vertices->size + additional_vertices > vertices->capacity) Vertex_RGB_List_Grow(vertices, additional_vertices);
-    if (indices->size + additional_indices > indices->capacity) Index_List_Grow(indices, additional_indices);
-
-    // Add pixel alignment offset
+    // Pixel alignment offset
     y += 0.5f;
-    float half_thick = thickness * 0.5f;
-    
-    // Create mesh
-    u32 vertex_offset = vertices->size;
-    vertices->array[vertex_offset] = (vertex_rgb){ x, y - half_thick, z, col.r, col.g, col.b }; // Left point (x) - thick -
-    vertices->array[vertex_offset + 1] = (vertex_rgb){ x, y + half_thick, z, col.r, col.g, col.b }; // Left point (x) - thick + 
-    vertices->array[vertex_offset + 2] = (vertex_rgb){ x + width, y - half_thick, z, col.r, col.g, col.b }; // Right point (x1) - thick -
-    vertices->array[vertex_offset + 3] = (vertex_rgb){ x + width, y + half_thick, z, col.r, col.g, col.b }; // Right point (x1) - thick + 
-
-    // Indices
-    u32* indices_write = indices->array + indices->size;
-    *indices_write++ = vertex_offset;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 3;
-
-    vertices->size += additional_vertices;
-    indices->size += additional_indices;
+    NU_Canvas_Push_Line_Primitive(ctx, buf, x, y, x + width, y, thickness, col);
 }
 
 void NU_Internal_Line(
-    int contextID,
+    NU_Canvas_Context* ctx,
     float x1, float y1, float x2, float y2,
     float thickness,
     NU_RGB col
 )
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     float twoThick = thickness * 2.0f;
     float canvasWidth = ctx->canvasWidth;
     float canvasHeight = ctx->canvasHeight;
 
     // Skip if line is not visible on canvas
-    if ((x1 < -twoThick && x2 < -twoThick) || 
+    bool cull = NU_Canvas_Culling(buf);
+    if (cull && (
+        (x1 < -twoThick && x2 < -twoThick) || 
         (x1 > ctx->canvasWidth && x2 > ctx->canvasWidth) || 
         (y1 < -twoThick && y2 < -twoThick) || 
-        (y1 > ctx->canvasHeight + twoThick && y2 > ctx->canvasHeight + twoThick)) {
+        (y1 > ctx->canvasHeight + twoThick && y2 > ctx->canvasHeight + twoThick))) {
         return;
     }
 
-    bool coordsWithinLargeVirtualCanvas = x1 >= -twoThick && x1 <= canvasWidth + twoThick &&
+    bool coordsWithinLargeVirtualCanvas = !cull || (
+                                          x1 >= -twoThick && x1 <= canvasWidth + twoThick &&
                                           x2 >= -twoThick && x2 <= canvasWidth + twoThick &&
                                           y1 >= -twoThick && y1 <= canvasHeight + twoThick &&
-                                          y2 >= -twoThick && y2 <= canvasHeight + twoThick;
+                                          y2 >= -twoThick && y2 <= canvasHeight + twoThick);
 
     // Implement fancy clipping -> moves coords closer to canvas
     if (!coordsWithinLargeVirtualCanvas)
@@ -528,64 +711,17 @@ void NU_Internal_Line(
         x2 = nx2; y2 = ny2;
     }
 
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
-    }
-
-    // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
-
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
-
-    // --- Allocate extra space in vertex and index lists ---
-    u32 additional_vertices = 4;    
-    u32 additional_indices = 6;          
-    if (vertices->size + additional_vertices > vertices->capacity) Vertex_RGB_List_Grow(vertices, additional_vertices);
-    if (indices->size + additional_indices > indices->capacity) Index_List_Grow(indices, additional_indices);
-
+    // Pixel straddle offsets
     x1 += 0.5f;
     x2 += 0.5f;
     y1 += 0.5f;
     y2 += 0.5f;
-
-
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float length = sqrtf(dx * dx + dy * dy);
-    if (length == 0.0f) return; // avoid divide-by-zero
-    dx /= length;
-    dy /= length;
-    float px = -dy;
-    float py = dx;
-    float half_thick = thickness * 0.5f;
-    px *= half_thick;
-    py *= half_thick;
-
-
-    u32 vertex_offset = vertices->size;
-    vertices->array[vertex_offset] = (vertex_rgb){ x1 - px, y1 - py, z, col.r, col.g, col.b }; // V1 -> thick -
-    vertices->array[vertex_offset + 1] = (vertex_rgb){ x1 + px, y1 + py, z, col.r, col.g, col.b }; // V1 -> thick + 
-    vertices->array[vertex_offset + 2] = (vertex_rgb){ x2 - px, y2 - py, z, col.r, col.g, col.b }; // V2 -> thick -
-    vertices->array[vertex_offset + 3] = (vertex_rgb){ x2 + px, y2 + py, z, col.r, col.g, col.b }; // V2 -> thick + 
-
-    // Indices
-    u32* indices_write = indices->array + indices->size;
-    *indices_write++ = vertex_offset;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 1;
-    *indices_write++ = vertex_offset + 2;
-    *indices_write++ = vertex_offset + 3;
-
-    vertices->size += additional_vertices;
-    indices->size += additional_indices;
+    if (x1 == x2 && y1 == y2) return;
+    NU_Canvas_Push_Line_Primitive(ctx, buf, x1, y1, x2, y2, thickness, col);
 }
 
 void NU_Internal_Dashed_Line(
-    int contextID,
+    NU_Canvas_Context* ctx,
     float x1, float y1, float x2, float y2,
     float thickness,
     uint8_t* dash_pattern,
@@ -593,25 +729,27 @@ void NU_Internal_Dashed_Line(
     NU_RGB col
 )
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     float twoThick = thickness * 2.0f;
     float canvasWidth = ctx->canvasWidth;
     float canvasHeight = ctx->canvasHeight;
 
     // Skip if line is not visible on canvas
-    if ((x1 < -twoThick && x2 < -twoThick) || 
+    bool cull = NU_Canvas_Culling(buf);
+    if (cull && (
+        (x1 < -twoThick && x2 < -twoThick) || 
         (x1 > ctx->canvasWidth && x2 > ctx->canvasWidth) || 
         (y1 < -twoThick && y2 < -twoThick) || 
-        (y1 > ctx->canvasHeight + twoThick && y2 > ctx->canvasHeight + twoThick)) {
+        (y1 > ctx->canvasHeight + twoThick && y2 > ctx->canvasHeight + twoThick))) {
         return;
     }
 
-    bool coordsWithinLargeVirtualCanvas = x1 >= -twoThick && x1 <= canvasWidth + twoThick &&
+    bool coordsWithinLargeVirtualCanvas = !cull || (
+                                          x1 >= -twoThick && x1 <= canvasWidth + twoThick &&
                                           x2 >= -twoThick && x2 <= canvasWidth + twoThick &&
                                           y1 >= -twoThick && y1 <= canvasHeight + twoThick &&
-                                          y2 >= -twoThick && y2 <= canvasHeight + twoThick;
+                                          y2 >= -twoThick && y2 <= canvasHeight + twoThick);
 
     float ox1 = x1, oy1 = y1;
     float ox2 = x2, oy2 = y2;
@@ -762,21 +900,23 @@ void NU_Internal_Dashed_Line(
         pattern_offset += segment_len;
     }
     
+    // The pattern fits in a primitive -> dashes are evaluated in the shader
+    if (dash_pattern_len <= CANVAS_MAX_DASH_PATTERN) {
+        CanvasPrimitiveRenderData* line = NU_Canvas_Push_Line_Primitive(ctx, buf, x1, y1, x2, y2, thickness, col);
+        line->dashCount = (float)dash_pattern_len;
+        line->dashPhase = world_start;
+        for (u32 d=0; d<dash_pattern_len; d++) line->dash[d] = (float)dash_pattern[d];
+        return;
+    }
+
     float step_x = dx * inv_len;
     float step_y = dy * inv_len;
 
-
-    // Switching from text -> shape, increase depth
-    if (!ctx->isShapeLayer) {
-        ctx->isShapeLayer = true;
-        ctx->z++;
-    }
-
     // Get vertex and index lists
-    Vertex_RGB_List* vertices = &ctx->shapeLayer.vertices;
-    Index_List* indices = &ctx->shapeLayer.indices;
+    Vertex_RGB_List* vertices = &buf->shapeLayer.vertices;
+    Index_List* indices = &buf->shapeLayer.indices;
 
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
+    float z = NU_Canvas_Shape_Depth(ctx, buf, false);
 
     // Calculate number of vertices and indices are needed
     float pattern_len = 0.0f;
@@ -847,105 +987,448 @@ void NU_Internal_Dashed_Line(
     }
 }
 
-void NU_Internal_Set_Canvas_Font(int contextID, const char* fontName)
+// -----------------------------
+// --- Bulk Canvas Functions ---
+// -----------------------------
+// Each bulk call looks the context up once, reserves the worst case number of
+// primitives and writes them in place. Visibility is tested 4 items at a time
+
+// Bitmask of the 4 boxes (minX, minY) -> (maxX, maxY) that overlap [lo, hiX] x [lo, hiY]
+static inline int NU_Canvas_Visible_Mask(__m128 minX, __m128 minY, __m128 maxX, __m128 maxY, __m128 lo, __m128 hiX, __m128 hiY)
+{
+    __m128 outside = _mm_or_ps(
+        _mm_or_ps(_mm_cmplt_ps(maxX, lo), _mm_cmpgt_ps(minX, hiX)),
+        _mm_or_ps(_mm_cmplt_ps(maxY, lo), _mm_cmpgt_ps(minY, hiY)));
+    return _mm_movemask_ps(outside) ^ 0xF;
+}
+
+// M4 decimation: a series with non-decreasing x is reduced to the first, last, min y
+// and max y point of every pixel column it crosses, which rasterises the same as the
+// full series. Points left and right of the canvas collapse into one column each.
+// Writes at most 4 * (columns + 2) points and returns the count, or 0 if x decreases
+static u32 NU_Canvas_Decimate_M4(const float* xy, u32 count, int columns, float* out)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    u32 written = 0;
+    float prevX = -INFINITY;
+    u32 i = 0;
+    while (i < count) 
+    {
+        int column = (int)floorf(xy[i * 2] + 0.5f);
+        column = column < -1 ? -1 : (column > columns ? columns : column);
+        u32 first = i, minI = i, maxI = i, last = i;
+        for (; i < count; i++) {
+            float x = xy[i * 2];
+            if (x < prevX) return 0;
+            prevX = x;
+            int c = (int)floorf(x + 0.5f);
+            c = c < -1 ? -1 : (c > columns ? columns : c);
+            if (c != column) break;
+            float y = xy[i * 2 + 1];
+            if (y < xy[minI * 2 + 1]) minI = i;
+            if (y > xy[maxI * 2 + 1]) maxI = i;
+            last = i;
+        }
+
+        // Emit in series order, skipping repeats
+        u32 keep[4] = { first, minI < maxI ? minI : maxI, minI < maxI ? maxI : minI, last };
+        for (int k=0; k<4; k++) {
+            if (k > 0 && keep[k] == keep[k - 1]) continue;
+            out[written * 2] = xy[keep[k] * 2];
+            out[written * 2 + 1] = xy[keep[k] * 2 + 1];
+            written++;
+        }
+    }
+    return written;
+}
+
+void NU_Internal_Polyline(NU_Canvas_Context* ctx, const float* xy, u32 count, float thickness, NU_RGB col)
+{
+    if (xy == NULL || count < 2) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
+
+    // Far more points than pixel columns -> decimate before emitting segments
+    // (columns are only known without a transform)
+    bool cull = NU_Canvas_Culling(buf);
+    float* decimated = NULL;
+    int columns = (int)ceilf(ctx->canvasWidth);
+    if (ctx->decimate && cull && columns > 0 && count > (u32)columns * 4) {
+        decimated = malloc(sizeof(float) * 2 * 4 * (columns + 2));
+        u32 decimatedCount = NU_Canvas_Decimate_M4(xy, count, columns, decimated);
+        if (decimatedCount > 0) {
+            xy = decimated;
+            count = decimatedCount;
+        }
+    }
+
+    // Shared instance fields
+    CanvasPrimitiveRenderData line;
+    memset(&line, 0, sizeof(line));
+    line.z = NU_Canvas_Shape_Depth(ctx, buf, true);
+    line.thickness = thickness;
+    line.kind = CANVAS_PRIMITIVE_LINE;
+    line.strokeRGBA = NU_Canvas_Pack_RGB(col);
+
+    Array* primitives = &buf->shapeLayer.primitives;
+    Array_Reserve(primitives, count - 1);
+    CanvasPrimitiveRenderData* base = primitives->data;
+    CanvasPrimitiveRenderData* write = base + primitives->size;
+
+    float margin = thickness + 1.0f;
+    __m128 lo = _mm_set1_ps(cull ? -margin : -FLT_MAX);
+    __m128 hiX = _mm_set1_ps(cull ? ctx->canvasWidth + margin : FLT_MAX);
+    __m128 hiY = _mm_set1_ps(cull ? ctx->canvasHeight + margin : FLT_MAX);
+
+    // 4 segments (5 points) per iteration
+    u32 i = 0;
+    for (; i + 4 < count; i += 4) 
+    {
+        const float* p = xy + i * 2;
+        __m128 a = _mm_loadu_ps(p);     // x0 y0 x1 y1
+        __m128 b = _mm_loadu_ps(p + 4); // x2 y2 x3 y3
+        __m128 c = _mm_loadu_ps(p + 2); // x1 y1 x2 y2
+        __m128 d = _mm_loadu_ps(p + 6); // x3 y3 x4 y4
+        __m128 startX = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 startY = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 endX = _mm_shuffle_ps(c, d, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 endY = _mm_shuffle_ps(c, d, _MM_SHUFFLE(3, 1, 3, 1));
+        int visible = NU_Canvas_Visible_Mask(
+            _mm_min_ps(startX, endX), _mm_min_ps(startY, endY), 
+            _mm_max_ps(startX, endX), _mm_max_ps(startY, endY), 
+            lo, hiX, hiY);
+        while (visible) {
+            int k = __builtin_ctz(visible);
+            visible &= visible - 1;
+            const float* s = p + k * 2;
+            if (s[0] == s[2] && s[1] == s[3]) continue;
+            *write = line;
+            write->x0 = s[0] + 0.5f; write->y0 = s[1] + 0.5f;
+            write->x1 = s[2] + 0.5f; write->y1 = s[3] + 0.5f;
+            write++;
+        }
+    }
+
+    // Remaining segments
+    for (; i + 1 < count; i++) 
+    {
+        const float* s = xy + i * 2;
+        float minX = fminf(s[0], s[2]), maxX = fmaxf(s[0], s[2]);
+        float minY = fminf(s[1], s[3]), maxY = fmaxf(s[1], s[3]);
+        if (cull && (maxX < -margin || minX > ctx->canvasWidth + margin || maxY < -margin || minY > ctx->canvasHeight + margin)) continue;
+        if (s[0] == s[2] && s[1] == s[3]) continue;
+        *write = line;
+        write->x0 = s[0] + 0.5f; write->y0 = s[1] + 0.5f;
+        write->x1 = s[2] + 0.5f; write->y1 = s[3] + 0.5f;
+        write++;
+    }
+    primitives->size = write - base;
+    free(decimated);
+}
+
+void NU_Internal_Set_Canvas_Decimation(NU_Canvas_Context* ctx, bool enabled)
+{
+    ctx->decimate = enabled;
+}
+
+void NU_Internal_Points(NU_Canvas_Context* ctx, const float* xy, u32 count, float radius, NU_RGB col)
+{
+    if (xy == NULL || count == 0 || radius <= 0.0f) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
+
+    // Points are fully rounded rects
+    CanvasPrimitiveRenderData point;
+    memset(&point, 0, sizeof(point));
+    point.z = NU_Canvas_Shape_Depth(ctx, buf, true);
+    point.radius = radius;
+    point.kind = CANVAS_PRIMITIVE_RECT;
+    point.fillRGBA = NU_Canvas_Pack_RGB(col);
+    point.strokeRGBA = point.fillRGBA;
+
+    Array* primitives = &buf->shapeLayer.primitives;
+    Array_Reserve(primitives, count);
+    CanvasPrimitiveRenderData* base = primitives->data;
+    CanvasPrimitiveRenderData* write = base + primitives->size;
+
+    bool cull = NU_Canvas_Culling(buf);
+    __m128 lo = _mm_set1_ps(cull ? -radius : -FLT_MAX);
+    __m128 hiX = _mm_set1_ps(cull ? ctx->canvasWidth + radius : FLT_MAX);
+    __m128 hiY = _mm_set1_ps(cull ? ctx->canvasHeight + radius : FLT_MAX);
+
+    // 4 points per iteration
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) 
+    {
+        const float* p = xy + i * 2;
+        __m128 a = _mm_loadu_ps(p);
+        __m128 b = _mm_loadu_ps(p + 4);
+        __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        int visible = NU_Canvas_Visible_Mask(x, y, x, y, lo, hiX, hiY);
+        while (visible) {
+            int k = __builtin_ctz(visible);
+            visible &= visible - 1;
+            float cx = p[k * 2] + 0.5f, cy = p[k * 2 + 1] + 0.5f;
+            *write = point;
+            write->x0 = cx - radius; write->y0 = cy - radius;
+            write->x1 = cx + radius; write->y1 = cy + radius;
+            write++;
+        }
+    }
+
+    // Remaining points
+    for (; i < count; i++) 
+    {
+        float x = xy[i * 2], y = xy[i * 2 + 1];
+        if (cull && (x < -radius || x > ctx->canvasWidth + radius || y < -radius || y > ctx->canvasHeight + radius)) continue;
+        *write = point;
+        write->x0 = x + 0.5f - radius; write->y0 = y + 0.5f - radius;
+        write->x1 = x + 0.5f + radius; write->y1 = y + 0.5f + radius;
+        write++;
+    }
+    primitives->size = write - base;
+}
+
+void NU_Internal_Rects(NU_Canvas_Context* ctx, const NU_Rect* rects, u32 count, float thickness, NU_RGB border_col, NU_RGB fill_col)
+{
+    if (rects == NULL || count == 0) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
+
+    CanvasPrimitiveRenderData rect;
+    memset(&rect, 0, sizeof(rect));
+    rect.z = NU_Canvas_Shape_Depth(ctx, buf, true);
+    rect.thickness = thickness;
+    rect.kind = CANVAS_PRIMITIVE_RECT;
+    rect.fillRGBA = NU_Canvas_Pack_RGB(fill_col);
+    rect.strokeRGBA = NU_Canvas_Pack_RGB(border_col);
+
+    Array* primitives = &buf->shapeLayer.primitives;
+    Array_Reserve(primitives, count);
+    CanvasPrimitiveRenderData* base = primitives->data;
+    CanvasPrimitiveRenderData* write = base + primitives->size;
+
+    // Constrain dimensions based on thickness (as NU_Border_Rect)
+    __m128 minSize = _mm_set1_ps(thickness * 2.0f);
+    bool cull = NU_Canvas_Culling(buf);
+    __m128 lo = _mm_set1_ps(cull ? 0.0f : -FLT_MAX);
+    __m128 hiX = _mm_set1_ps(cull ? ctx->canvasWidth : FLT_MAX);
+    __m128 hiY = _mm_set1_ps(cull ? ctx->canvasHeight : FLT_MAX);
+
+    // 4 rects per iteration (transposed to x, y, w, h lanes)
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) 
+    {
+        __m128 x = _mm_loadu_ps(&rects[i].x);
+        __m128 y = _mm_loadu_ps(&rects[i + 1].x);
+        __m128 w = _mm_loadu_ps(&rects[i + 2].x);
+        __m128 h = _mm_loadu_ps(&rects[i + 3].x);
+        _MM_TRANSPOSE4_PS(x, y, w, h);
+        w = _mm_max_ps(w, minSize);
+        h = _mm_max_ps(h, minSize);
+        __m128 right = _mm_add_ps(x, w);
+        __m128 bottom = _mm_add_ps(y, h);
+        int visible = NU_Canvas_Visible_Mask(x, y, right, bottom, lo, hiX, hiY);
+        float rightArr[4], bottomArr[4];
+        _mm_storeu_ps(rightArr, right);
+        _mm_storeu_ps(bottomArr, bottom);
+        while (visible) {
+            int k = __builtin_ctz(visible);
+            visible &= visible - 1;
+            *write = rect;
+            write->x0 = rects[i + k].x; write->y0 = rects[i + k].y;
+            write->x1 = rightArr[k]; write->y1 = bottomArr[k];
+            write++;
+        }
+    }
+
+    // Remaining rects
+    for (; i < count; i++) 
+    {
+        float x = rects[i].x, y = rects[i].y;
+        float w = fmaxf(rects[i].w, thickness * 2.0f);
+        float h = fmaxf(rects[i].h, thickness * 2.0f);
+        if (cull && (x + w < 0.0f || x > ctx->canvasWidth || y + h < 0.0f || y > ctx->canvasHeight)) continue;
+        *write = rect;
+        write->x0 = x; write->y0 = y;
+        write->x1 = x + w; write->y1 = y + h;
+        write++;
+    }
+    primitives->size = write - base;
+}
+
+// ---------------------------
+// --- Canvas transforms -----
+// ---------------------------
+// Geometry recorded between push and pop keeps its canvas coordinates and is
+// transformed in the vertex shader, so NU_Internal_Canvas_Set_Transform can pan or
+// zoom it without re-recording. Returns the transform's ID (IDs are handed out in
+// push order from 1, so a re-recorded frame gets the same IDs)
+int NU_Internal_Canvas_Push_Transform(NU_Canvas_Context* ctx, float a, float b, float c, float d, float e, float f)
+{
+    CanvasDrawBuffer* buf = NU_Canvas_Back(ctx);
+
+    CanvasTransform transform = { a, b, c, d, e, f, buf->transformIndex };
+    Array_Push(&buf->transforms, &transform);
+    buf->transformIndex = (int)buf->transforms.size - 1;
+    return buf->transformIndex;
+}
+
+void NU_Internal_Canvas_Pop_Transform(NU_Canvas_Context* ctx)
+{
+    CanvasDrawBuffer* buf = NU_Canvas_Back(ctx);
+    CanvasTransform* top = Array_Get(&buf->transforms, buf->transformIndex);
+    buf->transformIndex = top->parent;
+}
+
+void NU_Internal_Canvas_Set_Transform(NU_Canvas_Context* ctx, int transformID, float a, float b, float c, float d, float e, float f)
+{
+    if (transformID <= 0) return;
+
+    // Only the shown frame is updated, a double buffered back buffer belongs to its recorder
+    SDL_LockMutex(ctx->swapMutex);
+    CanvasDrawBuffer* buf = NU_Canvas_Front(ctx);
+    if ((u32)transformID < buf->transforms.size) {
+        CanvasTransform* transform = Array_Get(&buf->transforms, transformID);
+        transform->a = a; transform->b = b;
+        transform->c = c; transform->d = d;
+        transform->e = e; transform->f = f;
+        SDL_SetAtomicInt(&ctx->dirty, 1);
+    }
+    SDL_UnlockMutex(ctx->swapMutex);
+}
+
+// Writes each transform composed with its parents (6 floats per transform ID)
+static void NU_Canvas_Resolve_Transforms(CanvasDrawBuffer* buf, float* out)
+{
+    for (u32 i=0; i<buf->transforms.size; i++) {
+        CanvasTransform* t = Array_Get(&buf->transforms, i);
+        float* r = out + i * 6;
+        if (i == 0) {
+            r[0] = 1.0f; r[1] = 0.0f; r[2] = 0.0f; r[3] = 1.0f; r[4] = 0.0f; r[5] = 0.0f;
+            continue;
+        }
+        const float* p = out + t->parent * 6;
+        r[0] = p[0] * t->a + p[2] * t->b;
+        r[1] = p[1] * t->a + p[3] * t->b;
+        r[2] = p[0] * t->c + p[2] * t->d;
+        r[3] = p[1] * t->c + p[3] * t->d;
+        r[4] = p[0] * t->e + p[2] * t->f + p[4];
+        r[5] = p[1] * t->e + p[3] * t->f + p[5];
+    }
+}
+
+void NU_Internal_Set_Canvas_Font(NU_Canvas_Context* ctx, const char* fontName)
+{
+    CanvasDrawBuffer* buf = NU_Canvas_Back(ctx);
 
     // Get fontID
     void* found = LinearStringmap_Get(&GUI.stylesheet.fontNameIndexMap, fontName);
     int fontID = *(int*)found;
 
     // If already using that font -> return early
-    if (ctx->fontID == fontID) return;
+    if (buf->fontID == fontID) return;
 
     // Update fontID in use
-    ctx->fontID = fontID;
-    ctx->textLayerIndex++;
+    buf->fontID = fontID;
+
+    // Text is batched per font, so switch back to the font's layer if it has one.
+    // Shape-over-text ordering is kept by depth, not by layer order
+    for (int l=0; l<buf->textLayerCount; l++) {
+        CanvasTextLayer* layer = Array_Get(&buf->textLayers, l);
+        if (layer->fontID == fontID) {
+            buf->textLayerIndex = l;
+            return;
+        }
+    }
+    buf->textLayerIndex = buf->textLayerCount++;
 
     // Create new text layer
-    if (ctx->textLayerIndex > ctx->textLayers.size-1) {
+    if ((u32)buf->textLayerIndex > buf->textLayers.size-1) {
         CanvasTextLayer textLayer;
         textLayer.fontID = fontID;
         Vertex_RGB_UV_List_Init(&textLayer.vertices, 512);
         Index_List_Init(&textLayer.indices, 1024);
-        Array_Push(&ctx->textLayers, &textLayer);
+        Array_Init(&textLayer.ranges, sizeof(CanvasDrawRange), 4);
+        Array_Push(&buf->textLayers, &textLayer);
     }
     // Reuse exising layer
     else {
-        CanvasTextLayer* existingLayer = Array_Get(&ctx->textLayers, ctx->textLayerIndex);
+        CanvasTextLayer* existingLayer = Array_Get(&buf->textLayers, buf->textLayerIndex);
         existingLayer->fontID = fontID;
     }
 }
 
 void NU_Internal_Text(
-    int contextID, 
+    NU_Canvas_Context* ctx, 
     float x, 
     float y, 
     float wrapWidth, 
     NU_RGB col,
     const char* string)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return;
+    CanvasDrawBuffer* buf = NU_Canvas_Record_Buffer(ctx);
 
     // Skip if text is not visible on large virtual canvas
-    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, ctx->fontID);
+    // Held for the whole mesh so a concurrent atlas resize can't shift its UVs
+    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, buf->fontID);
+    SDL_LockMutex(font->glyphMutex);
     float textWidth = NU_Calculate_Text_Unwrapped_Width(font, string); if (textWidth > wrapWidth) textWidth = wrapWidth;
     float textHeight = NU_Calculate_FreeText_Height_From_Wrap_Width(font, string, wrapWidth);
-    if (x > ctx->canvasWidth || x + textWidth < 0.0f || y > ctx->canvasHeight || y + textHeight < 0.0f) return;
+    if (NU_Canvas_Culling(buf) && (x > ctx->canvasWidth || x + textWidth < 0.0f || y > ctx->canvasHeight || y + textHeight < 0.0f)) {
+        SDL_UnlockMutex(font->glyphMutex);
+        return;
+    }
 
     // Switching from shape -> text, increase depth
-    if (ctx->isShapeLayer) {
-        ctx->isShapeLayer = false;
-        ctx->z++;
+    if (buf->isShapeLayer) {
+        buf->isShapeLayer = false;
+        buf->z++;
     }
 
     // Get text layer
-    CanvasTextLayer* textLayer = Array_Get(&ctx->textLayers, ctx->textLayerIndex);
+    CanvasTextLayer* textLayer = Array_Get(&buf->textLayers, buf->textLayerIndex);
 
     // Get vertex and index lists
     Vertex_RGB_UV_List* vertices = &textLayer->vertices;
     Index_List* indices = &textLayer->indices;
 
-    float z = (float)(ctx->node->layer) + ctx->z * 0.005f;
+    float z = (float)SDL_GetAtomicInt(&ctx->layer) + buf->z * 0.005f;
+    NU_Canvas_Mark_Range(&textLayer->ranges, indices->size, vertices->size, buf->transformIndex);
 
     // Generate text mesh
     NU_Generate_Text_Mesh(vertices, indices, font, string, x, y, z, col.r, col.g, col.b, wrapWidth);
+    SDL_UnlockMutex(font->glyphMutex);
 }
 
-float NU_Internal_Text_Height(int contextID, float wrapWidth, const char* string)
+// Measurements hold the font's glyphMutex throughout: workers may be adding glyphs
+// (and FreeType faces aren't thread safe)
+float NU_Internal_Text_Height(NU_Canvas_Context* ctx, float wrapWidth, const char* string)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return 0.0f; // node type is not valid therefore there is no context
-
-    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, ctx->fontID);
-    return NU_Calculate_FreeText_Height_From_Wrap_Width(font, string, wrapWidth);
+    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, NU_Canvas_Back(ctx)->fontID);
+    SDL_LockMutex(font->glyphMutex);
+    float height = NU_Calculate_FreeText_Height_From_Wrap_Width(font, string, wrapWidth);
+    SDL_UnlockMutex(font->glyphMutex);
+    return height;
 }
 
-float NU_Internal_Text_Width(int contextID, const char* string)
+float NU_Internal_Text_Width(NU_Canvas_Context* ctx, const char* string)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return 0.0f; // node type is not valid therefore there is no context
-
-    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, ctx->fontID);
-    return NU_Calculate_Text_Unwrapped_Width(font, string);
+    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, NU_Canvas_Back(ctx)->fontID);
+    SDL_LockMutex(font->glyphMutex);
+    float width = NU_Calculate_Text_Unwrapped_Width(font, string);
+    SDL_UnlockMutex(font->glyphMutex);
+    return width;
 }
 
-float NU_Internal_Codepoint_Width(int contextID, u32 codepoint)
+float NU_Internal_Codepoint_Width(NU_Canvas_Context* ctx, u32 codepoint)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return 0.0f; // node type is not valid therefore there is no context
-
-    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, ctx->fontID);
-    NU_Glyph* glyph = NU_Get_Glyph(font, codepoint);
-    return glyph->advance;
+    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, NU_Canvas_Back(ctx)->fontID);
+    SDL_LockMutex(font->glyphMutex);
+    float advance = NU_Get_Glyph(font, codepoint)->advance;
+    SDL_UnlockMutex(font->glyphMutex);
+    return advance;
 }
 
-float NU_Internal_Text_Line_Height(int contextID)
+float NU_Internal_Text_Line_Height(NU_Canvas_Context* ctx)
 {
-    NU_Canvas_Context* ctx = Container_Get(&GUI.canvasContexts, contextID); 
-    if (ctx == NULL) return 0.0f; // node type is not valid therefore there is no context
-    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, ctx->fontID);
+    NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, NU_Canvas_Back(ctx)->fontID);
     return font->line_height;
 }
\ No newline at end of file
@@ -1,282 +1,805 @@
 #pragma once
 
-#include <datastructures/Linear_Stringmap.h>
+#include <datastructures/Stringmap.h>
+#include <datastructures/Container.h>
 #include <utils/nu_int.h>
-#define STB_IMAGE_IMPLEMENTATION 
+#include <limits.h>
+#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-typedef struct AtlasImage {
-    float u0, v0;
-    float u1, v1;
-} AtlasImage;
+#define IMAGE_ATLAS_SIZE 512
+#define IMAGE_ATLAS_MAX_IMAGE_SIZE 128
+#define IMAGE_LARGE_MIN_CLASS 64     // Smallest large image layer side
+#define IMAGE_LARGE_POW2_CLASS 2048  // Layer sides round up to a power of two up to here...
+#define IMAGE_LARGE_CLASS_STEP 1024  // ...and to a multiple of this above it
 
-typedef struct StandaloneImageRenderData {
-    ImageRenderData renderData;
-    GLuint glImageHandle;
-} StandaloneImageRenderData;
+// CPU copy of uploaded RGBA pixels (read by the software renderer)
+typedef struct ImagePixels {
+    unsigned char* data;
+    int w, h;
+} ImagePixels;
 
+typedef struct AtlasRect {
+    u16 x, y, w, h;
+} AtlasRect;
+
+// Each atlas is one layer of the atlas texture array. Space is handed out by a guillotine
+// free-rectangle packer and returned (merged with free neighbours) when an image is evicted
 typedef struct Atlas {
-    Array images;
-    GLuint glImageHandle;
-    Array renderDataArray;
+    Array freeRects;
+    int imageCount;
+    ImagePixels pixels;
 } Atlas;
 
+// Large images are grouped by size class (both sides rounded up, see LargeImage_Size_Class()).
+// Each bucket is its own texture array, so a layer is never padded to more than 2x per side
+typedef struct LargeImageBucket {
+    int w, h;               // Layer size
+    Array pixels;           // ImagePixels per layer, data == NULL -> free layer
+    int imageCount;
+    GLuint arrayHandle;
+    int layerCapacity;
+} LargeImageBucket;
+
+// Where a loaded image lives
+#define IMAGE_LOCATION_LARGE  -1
+#define IMAGE_LOCATION_FAILED -2
+typedef struct ImageEntry {
+    int atlasIndex;  // Atlas index, IMAGE_LOCATION_LARGE or IMAGE_LOCATION_FAILED
+    int bucket;      // Large image bucket (large images only)
+    int index;       // Layer in the bucket (large images only)
+    AtlasRect rect;  // Atlas images only
+    int refCount;
+    String filepath;
+    int srcW, srcH;              // Decoded size (large images are resampled to their displayed size)
+    float displayW, displayH;    // Largest size drawn this frame (large images only)
+} ImageEntry;
+
+// Image handles are ids into the images container (slot 0 is reserved so 0 means "no image").
+// Large images get one layer each in the texture array of their size class bucket.
+// Render data for every image in a window is gathered into a single array and drawn with one
+// instanced call per run of large images sharing a bucket
 typedef struct ImageResourceManager {
-    Array largeImageGlHandles;
+    Container images;
+    Stringmap filepathToHandleMap;
     Array atlases;
-    Array standaloneImageRenderDatas;
+    Array largeImageBuckets;
+    Array renderDatas;
+    GLuint atlasArrayHandle;
+    int atlasLayerCapacity;
+    bool uploaded;           // GL arrays exist -> new images are uploaded as they are placed
+    bool cpuOnly;            // Headless gui -> nothing is uploaded, pixels are only kept for software rendering
 } ImageResourceManager;
 
-typedef struct AtlasBuild {
-    unsigned char* buffer;
-    u16 w, h;
-    u16 x, y, shelfHeight;
-} AtlasBuild;
+// ---------------------------------------
+// --- Atlas packing ---------------------
+// ---------------------------------------
+void Atlas_Init(Atlas* atlas)
+{
+    Array_Init(&atlas->freeRects, sizeof(AtlasRect), 16);
+    AtlasRect full = { 0, 0, IMAGE_ATLAS_SIZE, IMAGE_ATLAS_SIZE };
+    Array_Push(&atlas->freeRects, &full);
+    atlas->imageCount = 0;
+    atlas->pixels.w = IMAGE_ATLAS_SIZE;
+    atlas->pixels.h = IMAGE_ATLAS_SIZE;
+    atlas->pixels.data = calloc(IMAGE_ATLAS_SIZE * IMAGE_ATLAS_SIZE * 4, 1);
+}
 
-inline void AtlasBuild_Init(AtlasBuild* a, u16 w, u16 h)
+void Atlas_Free(Atlas* atlas)
 {
-    a->w = w;
-    a->h = h;
-    a->x = 0;
-    a->y = 0;
-    a->shelfHeight = 0;
-    a->buffer = (unsigned char*)malloc(w * h * 4);
-    memset(a->buffer, 0, w * h * 4);
+    Array_Free(&atlas->freeRects);
+    free(atlas->pixels.data);
 }
 
-bool AtlasBuild_CanFit(AtlasBuild* a, int w, int h)
+static int Atlas_Alloc(Atlas* atlas, int w, int h, AtlasRect* out)
 {
-    // new row if needed
-    if (a->x + w > a->w) {
-        if (a->y + a->shelfHeight + h > a->h) return 0;
+    // Best short side fit
+    int best = -1;
+    int bestShortSide = INT_MAX;
+    for (int i=0; i<atlas->freeRects.size; i++) {
+        AtlasRect* r = Array_Get(&atlas->freeRects, i);
+        if (r->w < w || r->h < h) continue;
+        int shortSide = min(r->w - w, r->h - h);
+        if (shortSide < bestShortSide) {
+            bestShortSide = shortSide;
+            best = i;
+        }
+    }
+    if (best == -1) return 0;
+
+    AtlasRect freeRect = *(AtlasRect*)Array_Get(&atlas->freeRects, best);
+    Array_DeleteBackfill(&atlas->freeRects, best);
+    out->x = freeRect.x; out->y = freeRect.y;
+    out->w = (u16)w;     out->h = (u16)h;
+
+    // Split the leftover along the shorter axis (keeps the larger leftover in one piece)
+    AtlasRect right, bottom;
+    if (freeRect.w - w < freeRect.h - h) {
+        right  = (AtlasRect){ freeRect.x + w, freeRect.y, freeRect.w - w, h };
+        bottom = (AtlasRect){ freeRect.x, freeRect.y + h, freeRect.w, freeRect.h - h };
     } else {
-        if (a->y + h > a->h) return 0;
+        right  = (AtlasRect){ freeRect.x + w, freeRect.y, freeRect.w - w, freeRect.h };
+        bottom = (AtlasRect){ freeRect.x, freeRect.y + h, w, freeRect.h - h };
     }
+    if (right.w > 0 && right.h > 0) Array_Push(&atlas->freeRects, &right);
+    if (bottom.w > 0 && bottom.h > 0) Array_Push(&atlas->freeRects, &bottom);
+    atlas->imageCount++;
     return 1;
 }
 
-static void AtlasBuild_AddImage(
-    AtlasBuild* a,
-    const unsigned char* src,
-    int imgW, int imgH,
-    int* outX, int* outY)
+static void Atlas_Release(Atlas* atlas, AtlasRect rect)
 {
-    // New row if needed
-    if (a->x + imgW > a->w) {
-        a->y += a->shelfHeight;
-        a->x = 0;
-        a->shelfHeight = 0;
+    atlas->imageCount--;
+    if (atlas->imageCount == 0) {
+        Array_Clear(&atlas->freeRects);
+        AtlasRect full = { 0, 0, IMAGE_ATLAS_SIZE, IMAGE_ATLAS_SIZE };
+        Array_Push(&atlas->freeRects, &full);
+        return;
     }
 
-    // Write position
-    int x = a->x;
-    int y = a->y;
+    // Merge with free neighbours that share a full edge until nothing merges
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i=0; i<atlas->freeRects.size; i++) {
+            AtlasRect* r = Array_Get(&atlas->freeRects, i);
+            if (r->x == rect.x && r->w == rect.w && (r->y + r->h == rect.y || rect.y + rect.h == r->y)) {
+                rect.y = min(r->y, rect.y);
+                rect.h += r->h;
+            }
+            else if (r->y == rect.y && r->h == rect.h && (r->x + r->w == rect.x || rect.x + rect.w == r->x)) {
+                rect.x = min(r->x, rect.x);
+                rect.w += r->w;
+            }
+            else continue;
+            Array_DeleteBackfill(&atlas->freeRects, i);
+            merged = true;
+            break;
+        }
+    }
+    Array_Push(&atlas->freeRects, &rect);
+}
 
-    // Blit
-    for (int row = 0; row < imgH; row++) {
-        unsigned char* dst = &a->buffer[((y + row) * a->w + x) * 4];
-        const unsigned char* srcRow = &src[row * imgW * 4];
-        memcpy(dst, srcRow, imgW * 4);
+static void Atlas_Blit(Atlas* atlas, AtlasRect rect, const unsigned char* src)
+{
+    for (int row = 0; row < rect.h; row++) {
+        unsigned char* dst = &atlas->pixels.data[((rect.y + row) * IMAGE_ATLAS_SIZE + rect.x) * 4];
+        memcpy(dst, &src[row * rect.w * 4], rect.w * 4);
     }
+}
 
-    // Advance cursor
-    a->x += imgW;
-    if (imgH > a->shelfHeight) a->shelfHeight = imgH;
-    *outX = x;
-    *outY = y;
+// ---------------------------------------
+// --- GL upload -------------------------
+// ---------------------------------------
+static void ImageResource_SetArrayTextureParams()
+{
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
 
-typedef struct ImageResourceLoader {
-    ImageResourceManager* resourceManager;
-    LinearStringmap imageFilepathToHandleMap;
-    Array atlasBuilds;
-} ImageResourceLoader;
+// (Re)creates the atlas array with atlasLayerCapacity layers and uploads every atlas
+static void ImageResourceManager_UploadAtlasArray(ImageResourceManager* resourceManager)
+{
+    if (resourceManager->atlasLayerCapacity == 0) return;
+    if (resourceManager->atlasArrayHandle == 0) glGenTextures(1, &resourceManager->atlasArrayHandle);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, resourceManager->atlasArrayHandle);
+    ImageResource_SetArrayTextureParams();
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, IMAGE_ATLAS_SIZE, IMAGE_ATLAS_SIZE, resourceManager->atlasLayerCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    for (int i=0; i<resourceManager->atlases.size; i++) {
+        Atlas* atlas = Array_Get(&resourceManager->atlases, i);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, IMAGE_ATLAS_SIZE, IMAGE_ATLAS_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, atlas->pixels.data);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// (Re)creates a bucket's array (layerCapacity layers of w x h) and uploads every image in it
+static void LargeImageBucket_Upload(LargeImageBucket* bucket)
+{
+    if (bucket->layerCapacity == 0) return;
+    if (bucket->arrayHandle == 0) glGenTextures(1, &bucket->arrayHandle);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, bucket->arrayHandle);
+    ImageResource_SetArrayTextureParams();
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, bucket->w, bucket->h, bucket->layerCapacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    for (int i=0; i<bucket->pixels.size; i++) {
+        ImagePixels* pixels = Array_Get(&bucket->pixels, i);
+        if (pixels->data == NULL) continue;
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, pixels->w, pixels->h, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// ---------------------------------------
+// --- Large image buckets ---------------
+// ---------------------------------------
+static int LargeImage_Size_Class(int size)
+{
+    if (size > IMAGE_LARGE_POW2_CLASS) {
+        return (size + IMAGE_LARGE_CLASS_STEP - 1) / IMAGE_LARGE_CLASS_STEP * IMAGE_LARGE_CLASS_STEP;
+    }
+    int sizeClass = IMAGE_LARGE_MIN_CLASS;
+    while (sizeClass < size) sizeClass *= 2;
+    return sizeClass;
+}
+
+// Returns the index of the bucket for a w x h image, creating the bucket if needed
+static int ImageResourceManager_GetLargeBucket(ImageResourceManager* resourceManager, int w, int h)
+{
+    int classW = LargeImage_Size_Class(w);
+    int classH = LargeImage_Size_Class(h);
+    for (int i=0; i<resourceManager->largeImageBuckets.size; i++) {
+        LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, i);
+        if (bucket->w == classW && bucket->h == classH) return i;
+    }
+    LargeImageBucket* bucket = Array_PushEmpty(&resourceManager->largeImageBuckets);
+    bucket->w = classW;
+    bucket->h = classH;
+    Array_Init(&bucket->pixels, sizeof(ImagePixels), 4);
+    bucket->imageCount = 0;
+    bucket->arrayHandle = 0;
+    bucket->layerCapacity = 0;
+    return resourceManager->largeImageBuckets.size - 1;
+}
+
+// Gives a large image (taking ownership of buffer) a layer in the bucket of its size class.
+// Once the GL arrays exist the layer is uploaded straight away
+static void ImageResourceManager_PlaceLargeImage(ImageResourceManager* resourceManager, ImageEntry* entry, unsigned char* buffer, int w, int h)
+{
+    int bucketIndex = ImageResourceManager_GetLargeBucket(resourceManager, w, h);
+    LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, bucketIndex);
+
+    // Reuse a free layer if there is one
+    int index = -1;
+    for (int i=0; i<bucket->pixels.size; i++) {
+        ImagePixels* pixels = Array_Get(&bucket->pixels, i);
+        if (pixels->data == NULL) { index = i; break; }
+    }
+    if (index == -1) {
+        Array_PushEmpty(&bucket->pixels);
+        index = bucket->pixels.size - 1;
+    }
 
+    // Keep pixels for upload (and afterwards for software rendering)
+    ImagePixels* pixels = Array_Get(&bucket->pixels, index);
+    pixels->data = buffer;
+    pixels->w = w;
+    pixels->h = h;
+    bucket->imageCount++;
+    entry->atlasIndex = IMAGE_LOCATION_LARGE;
+    entry->bucket = bucketIndex;
+    entry->index = index;
+
+    if (!resourceManager->uploaded) return;
+
+    // Out of layers -> grow the array and upload everything in the bucket again
+    if (index >= bucket->layerCapacity) {
+        bucket->layerCapacity = max(bucket->pixels.size, bucket->layerCapacity * 2);
+        LargeImageBucket_Upload(bucket);
+    }
+    else {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, bucket->arrayHandle);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, index, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+}
+
+// Frees a large image's layer. An emptied bucket drops its GL array (it is recreated if the size class is used again)
+static void ImageResourceManager_RemoveLargeImage(ImageResourceManager* resourceManager, ImageEntry* entry)
+{
+    LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, entry->bucket);
+    ImagePixels* pixels = Array_Get(&bucket->pixels, entry->index);
+    stbi_image_free(pixels->data);
+    pixels->data = NULL;
+    if (--bucket->imageCount > 0) return;
+    Array_Clear(&bucket->pixels);
+    if (bucket->arrayHandle) glDeleteTextures(1, &bucket->arrayHandle);
+    bucket->arrayHandle = 0;
+    bucket->layerCapacity = 0;
+}
+
+// ---------------------------------------
+// --- Resource manager ------------------
+// ---------------------------------------
 void ImageResourceManager_Init(ImageResourceManager* resourceManager)
 {
+    resourceManager->images = Container_Create(sizeof(ImageEntry));
+    ImageEntry reserved = {0};
+    reserved.atlasIndex = IMAGE_LOCATION_FAILED;
+    Container_Add(&resourceManager->images, &reserved);
+    Stringmap_Init(&resourceManager->filepathToHandleMap, sizeof(int), 64, 512);
     Array_Init(&resourceManager->atlases, sizeof(Atlas), 4);
-    Array_Init(&resourceManager->largeImageGlHandles, sizeof(GLuint), 16);
-    Array_Init(&resourceManager->standaloneImageRenderDatas, sizeof(StandaloneImageRenderData), 16);
+    Array_Init(&resourceManager->largeImageBuckets, sizeof(LargeImageBucket), 8);
+    Array_Init(&resourceManager->renderDatas, sizeof(ImageRenderData), 64);
+    resourceManager->atlasArrayHandle = 0;
+    resourceManager->atlasLayerCapacity = 0;
+    resourceManager->uploaded = false;
+    resourceManager->cpuOnly = false;
 }
 
 void ImageResourceManager_Free(ImageResourceManager* resourceManager)
 {
-    // Free large image GL memory
-    for (int i=0; i<resourceManager->largeImageGlHandles.size; i++) {
-        GLuint handle = *(GLuint*)Array_Get(&resourceManager->largeImageGlHandles, i);
-        glDeleteTextures(1, &handle);
+    // Free GL memory
+    if (resourceManager->atlasArrayHandle) glDeleteTextures(1, &resourceManager->atlasArrayHandle);
+
+    // Free large image memory
+    for (int b=0; b<resourceManager->largeImageBuckets.size; b++) {
+        LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, b);
+        if (bucket->arrayHandle) glDeleteTextures(1, &bucket->arrayHandle);
+        for (int i=0; i<bucket->pixels.size; i++) {
+            ImagePixels* pixels = Array_Get(&bucket->pixels, i);
+            if (pixels->data != NULL) stbi_image_free(pixels->data);
+        }
+        Array_Free(&bucket->pixels);
     }
 
     // Free atlas memory
     for (int i=0; i<resourceManager->atlases.size; i++) {
-        Atlas* atlas = Array_Get(&resourceManager->atlases, i);
-        glDeleteTextures(1, &atlas->glImageHandle);
-        Array_Free(&atlas->images);
-        Array_Free(&atlas->renderDataArray);
+        Atlas_Free(Array_Get(&resourceManager->atlases, i));
+    }
+
+    // Free image entries
+    for (int i=0; i<resourceManager->images.size; i++) {
+        ImageEntry* entry = Container_GetAt(&resourceManager->images, i);
+        if (entry->filepath != NULL) StringFree(entry->filepath);
     }
 
     // Free arrays
-    Array_Free(&resourceManager->largeImageGlHandles);
+    Container_Free(&resourceManager->images);
+    Stringmap_Free(&resourceManager->filepathToHandleMap);
+    Array_Free(&resourceManager->largeImageBuckets);
     Array_Free(&resourceManager->atlases);
-    Array_Free(&resourceManager->standaloneImageRenderDatas);
+    Array_Free(&resourceManager->renderDatas);
 }
 
-void ImageResourceManager_AddImageRenderData(ImageResourceManager* resourceManager, int imageHandle, ImageRenderData* renderData)
+int ImageResourceManager_GetHandle(ImageResourceManager* resourceManager, const char* filepath)
 {
-    // Image is standalone
-    if ((imageHandle & 0xFFFFu) == 0xFFFFu) {
-        int imageIndex = (imageHandle >> 16) & 0xFFFFu;
-        GLuint glHandle = *(GLuint*)Array_Get(&resourceManager->largeImageGlHandles, imageIndex);
-        StandaloneImageRenderData* sRenderData = Array_PushEmpty(&resourceManager->standaloneImageRenderDatas);  
-        sRenderData->glImageHandle = glHandle;
-        sRenderData->renderData = *renderData;
-    }
-    // Image is atlased
-    else {
-        int atlasIndex = ((imageHandle >> 16) & 0xFFFFu) - 1;
-        int imageIndex = (imageHandle & 0xFFFFu) - 1;
-        Atlas* atlas = Array_Get(&resourceManager->atlases, atlasIndex);
-        AtlasImage* img = Array_Get(&atlas->images, imageIndex);
-        renderData->u0 = img->u0;
-        renderData->v0 = img->v0;
-        renderData->u1 = img->u1;
-        renderData->v1 = img->v1;
-        Array_Push(&atlas->renderDataArray, renderData);
+    void* found = Stringmap_Get(&resourceManager->filepathToHandleMap, filepath);
+    if (found == NULL) {
+        return 0;
     }
+    return *(int*)found;
 }
 
-void ImageResourceManager_ClearAllImageRenderData(ImageResourceManager* resourceManager)
+// Creates an entry (one reference) for a filepath. The image is placed later with ImageResourceManager_PlaceImage()
+static int ImageResourceManager_CreateEntry(ImageResourceManager* resourceManager, const char* filepath)
+{
+    ImageEntry entry = {0};
+    entry.atlasIndex = IMAGE_LOCATION_FAILED;
+    entry.refCount = 1;
+    entry.filepath = StringCreate(filepath);
+    int imageHandle = Container_Add(&resourceManager->images, &entry);
+    Stringmap_Set(&resourceManager->filepathToHandleMap, filepath, &imageHandle);
+    return imageHandle;
+}
+
+// Places decoded RGBA pixels into an atlas (taking a copy) or a large image bucket (taking ownership).
+// Once the GL arrays exist the change is uploaded straight away
+static void ImageResourceManager_PlaceImage(ImageResourceManager* resourceManager, int imageHandle, unsigned char* buffer, int w, int h)
 {
+    ImageEntry* entry = Container_Get(&resourceManager->images, imageHandle);
+    entry->srcW = w;
+    entry->srcH = h;
+
+    // Too large to be added to an atlas -> own layer in the large image bucket of its size class
+    if (w > IMAGE_ATLAS_MAX_IMAGE_SIZE || h > IMAGE_ATLAS_MAX_IMAGE_SIZE)
+    {
+        ImageResourceManager_PlaceLargeImage(resourceManager, entry, buffer, w, h);
+        return;
+    }
+
+    // Pack image into the first atlas it fits in -> create an atlas if none have space
+    int atlasIndex = -1;
+    AtlasRect rect;
     for (int i=0; i<resourceManager->atlases.size; i++) {
-        Atlas* atlas = Array_Get(&resourceManager->atlases, i);
-        Array_Clear(&atlas->renderDataArray);
+        if (Atlas_Alloc(Array_Get(&resourceManager->atlases, i), w, h, &rect)) {
+            atlasIndex = i;
+            break;
+        }
+    }
+    if (atlasIndex == -1) {
+        Atlas* atlas = Array_PushEmpty(&resourceManager->atlases);
+        Atlas_Init(atlas);
+        Atlas_Alloc(atlas, w, h, &rect);
+        atlasIndex = resourceManager->atlases.size - 1;
+    }
+    Atlas* atlas = Array_Get(&resourceManager->atlases, atlasIndex);
+    Atlas_Blit(atlas, rect, buffer);
+    stbi_image_free(buffer);
+    entry->atlasIndex = atlasIndex;
+    entry->rect = rect;
+
+    if (resourceManager->uploaded) {
+        // Out of layers -> grow the array and upload everything again
+        if (atlasIndex >= resourceManager->atlasLayerCapacity) {
+            resourceManager->atlasLayerCapacity = max(resourceManager->atlases.size, resourceManager->atlasLayerCapacity * 2);
+            ImageResourceManager_UploadAtlasArray(resourceManager);
+        }
+        else {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, resourceManager->atlasArrayHandle);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, IMAGE_ATLAS_SIZE);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, rect.x, rect.y, atlasIndex, rect.w, rect.h, 1, GL_RGBA, GL_UNSIGNED_BYTE, atlas->pixels.data + (rect.y * IMAGE_ATLAS_SIZE + rect.x) * 4);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        }
     }
-    Array_Clear(&resourceManager->standaloneImageRenderDatas);
 }
 
-void ImageResourceLoader_Init(ImageResourceLoader* loader, ImageResourceManager* resourceManager)
+void ImageResourceManager_Retain(ImageResourceManager* resourceManager, int imageHandle)
 {
-    loader->resourceManager = resourceManager;
-    LinearStringmap_Init(&loader->imageFilepathToHandleMap, sizeof(int), 20, 512);
-    Array_Init(&loader->atlasBuilds, sizeof(AtlasBuild), 8);
+    if (imageHandle == 0) return;
+    ImageEntry* entry = Container_Get(&resourceManager->images, imageHandle);
+    if (entry != NULL) entry->refCount++;
 }
 
-int ImageResourceLoader_GetLoadedImageHandle(ImageResourceLoader* loader, const char* filepath)
+// Drops a reference. The last reference frees the image's atlas space or large image layer
+void ImageResourceManager_Release(ImageResourceManager* resourceManager, int imageHandle)
 {
-    void* found = LinearStringmap_Get(&loader->imageFilepathToHandleMap, filepath);
-    if (found == NULL) {
-        return 0;
+    if (imageHandle == 0) return;
+    ImageEntry* entry = Container_Get(&resourceManager->images, imageHandle);
+    if (entry == NULL || --entry->refCount > 0) return;
+
+    if (entry->atlasIndex == IMAGE_LOCATION_LARGE) {
+        ImageResourceManager_RemoveLargeImage(resourceManager, entry);
     }
-    return *(int*)found;
+    else if (entry->atlasIndex >= 0) {
+        Atlas_Release(Array_Get(&resourceManager->atlases, entry->atlasIndex), entry->rect);
+    }
+    Stringmap_Delete(&resourceManager->filepathToHandleMap, StringCstr(entry->filepath));
+    StringFree(entry->filepath);
+    Container_Remove(&resourceManager->images, imageHandle);
 }
 
-int ImageResourceLoader_LoadImage(ImageResourceLoader* loader, const char* filepath)
+// Loads an image after startup (decoded on the calling thread). Returns a handle holding one
+// reference, or 0 if the image could not be loaded. Loading an already loaded path adds a reference
+int ImageResourceManager_LoadImage(ImageResourceManager* resourceManager, const char* filepath)
 {
+    int imageHandle = ImageResourceManager_GetHandle(resourceManager, filepath);
+    if (imageHandle != 0) {
+        ImageResourceManager_Retain(resourceManager, imageHandle);
+        return imageHandle;
+    }
+
     int w, h, n;
     unsigned char* buffer = stbi_load(filepath, &w, &h, &n, 4); // Force RGBA
     if (!buffer) {
         return 0;
     }
+    imageHandle = ImageResourceManager_CreateEntry(resourceManager, filepath);
+    ImageResourceManager_PlaceImage(resourceManager, imageHandle, buffer, w, h);
+    return imageHandle;
+}
 
-    int imageHandle;
+// Assigns an image to a node, moving the node's reference from its previous image to the new one
+void ImageResourceManager_SetNodeImage(ImageResourceManager* resourceManager, NodeP* node, int imageHandle)
+{
+    if (node->typeData.image.imageHandle == imageHandle) return;
+    ImageResourceManager_Retain(resourceManager, imageHandle);
+    ImageResourceManager_Release(resourceManager, node->typeData.image.imageHandle);
+    node->typeData.image.imageHandle = imageHandle;
+}
 
-    // Too large to be added to an atlas -> keep as individual image
-    if (w > 128 || h > 128) 
-    {
-        // Upload to GPU
-        GLuint handle;
-        glGenTextures(1, &handle);
-        glBindTexture(GL_TEXTURE_2D, handle);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
-        stbi_image_free(buffer); // Free CPU memory
-
-        // Add handle to large image handles array
-        Array_Push(&loader->resourceManager->largeImageGlHandles, &handle);
-        int index = loader->resourceManager->largeImageGlHandles.size - 1;
-
-        // Create handle
-        imageHandle = (index << 16) | 0xFFFFu;
-    }
-    // Pack image into an atlas
-    else
-    {
-        u16 atlasSize = 512;
-
-        // Search the last 4 atlases to find one that the image can fit into
-        AtlasBuild* validAtlasBuild = NULL;
-        Atlas* atlas = NULL;
-        int atlasIndex = 0;
-        for (int i = 0; i < min(loader->atlasBuilds.size, 4); i++) {
-            AtlasBuild* atlasBuild = Array_Get(&loader->atlasBuilds, i);
-            if (AtlasBuild_CanFit(atlasBuild, w, h)) {
-                validAtlasBuild = atlasBuild;
-                atlas = Array_Get(&loader->resourceManager->atlases, i);
-                atlasIndex = i;
-                break;
+void ImageResourceManager_AddImageRenderData(ImageResourceManager* resourceManager, int imageHandle, ImageRenderData* renderData)
+{
+    ImageEntry* entry = Container_Get(&resourceManager->images, imageHandle);
+
+    // Image was evicted or could not be loaded
+    if (entry == NULL || entry->atlasIndex == IMAGE_LOCATION_FAILED) return;
+
+    // Image is standalone -> own layer in its large image bucket
+    if (entry->atlasIndex == IMAGE_LOCATION_LARGE) {
+        LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, entry->bucket);
+        ImagePixels* pixels = Array_Get(&bucket->pixels, entry->index);
+        renderData->u0 = 0.0f;
+        renderData->v0 = 0.0f;
+        renderData->u1 = (float)pixels->w / (float)bucket->w;
+        renderData->v1 = (float)pixels->h / (float)bucket->h;
+        renderData->layer = (float)entry->index;
+        renderData->largeImage = (float)(entry->bucket + 1);
+        entry->displayW = fmaxf(entry->displayW, renderData->w);
+        entry->displayH = fmaxf(entry->displayH, renderData->h);
+    }
+    // Image is atlased -> atlas index is the layer in the atlas array
+    else {
+        renderData->u0 = (float)entry->rect.x / (float)IMAGE_ATLAS_SIZE;
+        renderData->v0 = (float)entry->rect.y / (float)IMAGE_ATLAS_SIZE;
+        renderData->u1 = (float)(entry->rect.x + entry->rect.w) / (float)IMAGE_ATLAS_SIZE;
+        renderData->v1 = (float)(entry->rect.y + entry->rect.h) / (float)IMAGE_ATLAS_SIZE;
+        renderData->layer = (float)entry->atlasIndex;
+        renderData->largeImage = 0.0f;
+    }
+    Array_Push(&resourceManager->renderDatas, renderData);
+}
+
+void ImageResourceManager_ClearAllImageRenderData(ImageResourceManager* resourceManager)
+{
+    Array_Clear(&resourceManager->renderDatas);
+}
+
+// Draws the gathered render datas. Large images from different buckets need different arrays bound,
+// so one instanced call is made per run of consecutive images that share a bucket (order is kept)
+void ImageResourceManager_DrawImages(ImageResourceManager* resourceManager, float screenW, float screenH)
+{
+    ImageRenderData* renderDatas = resourceManager->renderDatas.data;
+    int count = resourceManager->renderDatas.size;
+    int begin = 0;
+    int runBucket = -1;
+    for (int i=0; i<=count; i++) {
+        int bucket = i < count ? (int)renderDatas[i].largeImage - 1 : -1;
+        if (i < count && (bucket == -1 || runBucket == -1 || bucket == runBucket)) {
+            if (bucket != -1) runBucket = bucket;
+            continue;
+        }
+        GLuint largeHandle = 0;
+        if (runBucket != -1) largeHandle = ((LargeImageBucket*)Array_Get(&resourceManager->largeImageBuckets, runBucket))->arrayHandle;
+        NU_Draw_Images(renderDatas + begin, i - begin, screenW, screenH, resourceManager->atlasArrayHandle, largeHandle);
+        begin = i;
+        runBucket = bucket;
+    }
+}
+
+// Resolves the CPU pixels behind a render data layer. Layer sizes can exceed the image size
+// (large image buckets), so the layer dimensions UVs are relative to are returned as well
+ImagePixels* ImageResourceManager_GetLayerPixels(ImageResourceManager* resourceManager, const ImageRenderData* renderData, int* layerW, int* layerH)
+{
+    int layer = (int)renderData->layer;
+    if (renderData->largeImage != 0.0f) {
+        LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, (int)renderData->largeImage - 1);
+        *layerW = bucket->w;
+        *layerH = bucket->h;
+        return Array_Get(&bucket->pixels, layer);
+    }
+    Atlas* atlas = Array_Get(&resourceManager->atlases, layer);
+    *layerW = atlas->pixels.w;
+    *layerH = atlas->pixels.h;
+    return &atlas->pixels;
+}
+
+// ---------------------------------------
+// --- Display size resampling -----------
+// ---------------------------------------
+
+// Area-averaging (box) resample of RGBA8 pixels to dstW x dstH (dst no larger than src).
+// Filtering is done on premultiplied colour so transparent texels do not darken edges
+static unsigned char* Image_Resample_Box(const unsigned char* src, int srcW, int srcH, int dstW, int dstH)
+{
+    unsigned char* dst = malloc(dstW * dstH * 4);
+    float* rows = malloc(sizeof(float) * dstW * srcH * 4);
+    if (dst == NULL || rows == NULL) {
+        free(dst); free(rows);
+        return NULL;
+    }
+    float scaleX = (float)srcW / (float)dstW;
+    float scaleY = (float)srcH / (float)dstH;
+
+    // Horizontal pass: src rows -> dstW premultiplied float texels
+    #pragma omp parallel for
+    for (int y = 0; y < srcH; y++) {
+        const unsigned char* srcRow = src + y * srcW * 4;
+        float* row = rows + y * dstW * 4;
+        for (int dx = 0; dx < dstW; dx++) {
+            float x0 = dx * scaleX;
+            float x1 = x0 + scaleX;
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int sx = (int)x0; sx < srcW && (float)sx < x1; sx++) {
+                float weight = fminf((float)(sx + 1), x1) - fmaxf((float)sx, x0);
+                const unsigned char* t = srcRow + sx * 4;
+                float a = (float)t[3] * weight;
+                acc[0] += (float)t[0] * a;
+                acc[1] += (float)t[1] * a;
+                acc[2] += (float)t[2] * a;
+                acc[3] += a;
+            }
+            row[dx * 4 + 0] = acc[0];
+            row[dx * 4 + 1] = acc[1];
+            row[dx * 4 + 2] = acc[2];
+            row[dx * 4 + 3] = acc[3];
+        }
+    }
+
+    // Vertical pass: average rows, then unpremultiply
+    #pragma omp parallel for
+    for (int dy = 0; dy < dstH; dy++) {
+        float y0 = dy * scaleY;
+        float y1 = y0 + scaleY;
+        unsigned char* dstRow = dst + dy * dstW * 4;
+        for (int dx = 0; dx < dstW; dx++) {
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int sy = (int)y0; sy < srcH && (float)sy < y1; sy++) {
+                float weight = fminf((float)(sy + 1), y1) - fmaxf((float)sy, y0);
+                const float* t = rows + (sy * dstW + dx) * 4;
+                acc[0] += t[0] * weight;
+                acc[1] += t[1] * weight;
+                acc[2] += t[2] * weight;
+                acc[3] += t[3] * weight;
             }
+            float alpha = acc[3];
+            float invAlpha = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+            dstRow[dx * 4 + 0] = (unsigned char)fminf(acc[0] * invAlpha + 0.5f, 255.0f);
+            dstRow[dx * 4 + 1] = (unsigned char)fminf(acc[1] * invAlpha + 0.5f, 255.0f);
+            dstRow[dx * 4 + 2] = (unsigned char)fminf(acc[2] * invAlpha + 0.5f, 255.0f);
+            dstRow[dx * 4 + 3] = (unsigned char)fminf(alpha / (scaleX * scaleY) + 0.5f, 255.0f);
         }
+    }
+
+    free(rows);
+    return dst;
+}
 
-        // Did not find a valid atlas build -> create one
-        if (!validAtlasBuild) {
-            validAtlasBuild = Array_PushEmpty(&loader->atlasBuilds);
-            AtlasBuild_Init(validAtlasBuild, atlasSize, atlasSize); // example size
+// Called after a frame is drawn. Large images drawn much smaller than their stored size are
+// box-filtered down to (1.25x) their largest displayed size, and images displayed larger than
+// their stored size are decoded again from file. Resampled images move to the bucket of their
+// new size class
+void ImageResourceManager_FitLargeImagesToDisplay(ImageResourceManager* resourceManager)
+{
+    for (int i=0; i<resourceManager->images.size; i++)
+    {
+        ImageEntry* entry = Container_GetAt(&resourceManager->images, i);
+        float displayW = entry->displayW;
+        float displayH = entry->displayH;
+        entry->displayW = 0.0f;
+        entry->displayH = 0.0f;
+        if (entry->atlasIndex != IMAGE_LOCATION_LARGE || displayW <= 0.0f || displayH <= 0.0f) continue;
+
+        // Keep the aspect ratio, never exceed the decoded size
+        LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, entry->bucket);
+        ImagePixels* pixels = Array_Get(&bucket->pixels, entry->index);
+        float scale = fminf(1.0f, fmaxf(displayW / (float)entry->srcW, displayH / (float)entry->srcH) * 1.25f);
+        int targetW = max(1, (int)ceilf((float)entry->srcW * scale));
+        int targetH = max(1, (int)ceilf((float)entry->srcH * scale));
+
+        bool shrink = pixels->w >= targetW * 2 && pixels->h >= targetH * 2;
+        bool grow = (displayW > (float)pixels->w || displayH > (float)pixels->h) && pixels->w < entry->srcW;
+        if (!shrink && !grow) continue;
+
+        // Resample from the stored pixels when shrinking, from the file when growing
+        unsigned char* source = pixels->data;
+        int sourceW = pixels->w, sourceH = pixels->h;
+        if (grow) {
+            int n;
+            source = stbi_load(StringCstr(entry->filepath), &sourceW, &sourceH, &n, 4); // Force RGBA
+            if (source == NULL) continue;
+            entry->srcW = sourceW; // The file may have changed on disk
+            entry->srcH = sourceH;
+        }
 
-            // Create a corresponding ImageResourceManager Atlas
-            atlas = Array_PushEmpty(&loader->resourceManager->atlases);
-            Array_Init(&atlas->images, sizeof(AtlasImage), 32);
-            Array_Init(&atlas->renderDataArray, sizeof(ImageRenderData), 32);
-            atlasIndex = loader->resourceManager->atlases.size - 1;
+        unsigned char* resampled = source;
+        int resampledW = sourceW, resampledH = sourceH;
+        if (targetW < sourceW || targetH < sourceH) {
+            unsigned char* boxed = Image_Resample_Box(source, sourceW, sourceH, min(targetW, sourceW), min(targetH, sourceH));
+            if (boxed != NULL) {
+                resampled = boxed;
+                resampledW = min(targetW, sourceW);
+                resampledH = min(targetH, sourceH);
+            }
         }
+        if (resampled == pixels->data) continue;
+        if (source != pixels->data && source != resampled) stbi_image_free(source);
+        ImageResourceManager_RemoveLargeImage(resourceManager, entry);
+        ImageResourceManager_PlaceLargeImage(resourceManager, entry, resampled, resampledW, resampledH);
+    }
+}
+
+// ---------------------------------------
+// --- Startup loader --------------------
+// ---------------------------------------
 
-        // Pack image into atlas build
-        int x, y;
-        AtlasBuild_AddImage(validAtlasBuild, buffer, w, h, &x, &y);
-        stbi_image_free(buffer);
+// Images are only registered while the xml and css are parsed. Decoding runs on worker
+// threads once parsing is done, then packing and GL upload happen on the main thread.
+// Images loaded this way keep their first reference for the lifetime of the gui
+typedef struct ImageDecodeJob {
+    const char* filepath;
+    int imageHandle;
+    unsigned char* buffer;
+    int w, h;
+} ImageDecodeJob;
+
+typedef struct ImageDecodeJobBatch {
+    ImageDecodeJob* jobs;
+    int start, stride, end;
+} ImageDecodeJobBatch;
+
+typedef struct ImageResourceLoader {
+    ImageResourceManager* resourceManager;
+    Array decodeJobs;
+} ImageResourceLoader;
 
-        // Add image to resource manager
-        AtlasImage* newImage = Array_PushEmpty(&atlas->images);
-        newImage->u0 = (float)x / (float)atlasSize;
-        newImage->v0 = (float)y / (float)atlasSize;
-        newImage->u1 = (float)(x + w) / (float)atlasSize;
-        newImage->v1 = (float)(y + h) / (float)atlasSize;
-        int imageIndex = atlas->images.size - 1;
+void ImageResourceLoader_Init(ImageResourceLoader* loader, ImageResourceManager* resourceManager)
+{
+    loader->resourceManager = resourceManager;
+    Array_Init(&loader->decodeJobs, sizeof(ImageDecodeJob), 32);
+}
 
-        // Create handle
-        imageHandle = (((atlasIndex + 1) & 0xFFFFu) << 16) | ((imageIndex + 1) & 0xFFFFu);
-    }   
+int ImageResourceLoader_GetLoadedImageHandle(ImageResourceLoader* loader, const char* filepath)
+{
+    return ImageResourceManager_GetHandle(loader->resourceManager, filepath);
+}
 
-    LinearStringmap_Set(&loader->imageFilepathToHandleMap, filepath, &imageHandle);
+int ImageResourceLoader_LoadImage(ImageResourceLoader* loader, const char* filepath)
+{
+    // Reserve a handle now, the image is decoded and placed in ImageResourceLoader_UploadImagesAndFree()
+    int imageHandle = ImageResourceManager_CreateEntry(loader->resourceManager, filepath);
+    ImageEntry* entry = Container_Get(&loader->resourceManager->images, imageHandle);
+
+    ImageDecodeJob* job = Array_PushEmpty(&loader->decodeJobs);
+    job->filepath = StringCstr(entry->filepath);
+    job->imageHandle = imageHandle;
+    job->buffer = NULL;
+    job->w = 0;
+    job->h = 0;
     return imageHandle;
 }
 
-void ImageResourceLoader_UploadImagesAndFree(ImageResourceLoader* loader)
+int ImageDecoderThread(void* data)
 {
-    for (int i=0; i<loader->atlasBuilds.size; i++) 
-    {
-        AtlasBuild* build = Array_Get(&loader->atlasBuilds, i);
+    ImageDecodeJobBatch* batch = (ImageDecodeJobBatch*)data;
+
+    for (int i=batch->start; i<batch->end; i+=batch->stride) {
+        ImageDecodeJob* job = &batch->jobs[i];
+        int n;
+        job->buffer = stbi_load(job->filepath, &job->w, &job->h, &n, 4); // Force RGBA
+    }
+
+    return 0;
+}
+
+static void ImageResourceLoader_DecodeAll(ImageResourceLoader* loader)
+{
+    int jobCount = loader->decodeJobs.size;
+    if (jobCount == 0) return;
+
+    int threadCount = SDL_GetNumLogicalCPUCores();
+    if (threadCount <= 0) threadCount = 1;
+    if (threadCount > 32) threadCount = 32;
+    if (threadCount > jobCount) threadCount = jobCount;
+    SDL_Thread* threads[32];
+    ImageDecodeJobBatch batches[32];
+
+    // Interleave jobs across threads (file sizes vary a lot, contiguous ranges balance badly)
+    for (int t=0; t<threadCount; t++) {
+        batches[t].jobs = loader->decodeJobs.data;
+        batches[t].start = t;
+        batches[t].stride = threadCount;
+        batches[t].end = jobCount;
+    }
 
-        // Upload to GPU
-        GLuint handle;
-        glGenTextures(1, &handle);
-        glBindTexture(GL_TEXTURE_2D, handle);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, build->w, build->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, build->buffer);
+    // Dispatch work (the main thread takes the first batch)
+    threads[0] = NULL;
+    for (int t=1; t<threadCount; t++) {
+        threads[t] = SDL_CreateThread(ImageDecoderThread, "ImageDecoder", &batches[t]);
+    }
+    ImageDecoderThread(&batches[0]);
+
+    // Wait for work to finish (decode on this thread if a worker could not be created)
+    for (int t=1; t<threadCount; t++) {
+        if (threads[t] != NULL) SDL_WaitThread(threads[t], NULL);
+        else ImageDecoderThread(&batches[t]);
+    }
+}
+
+void ImageResourceLoader_UploadImagesAndFree(ImageResourceLoader* loader)
+{
+    ImageResourceManager* resourceManager = loader->resourceManager;
 
-        // Set the handle of the corresponding ImageResourceManager Atlas
-        Atlas* atlas = Array_Get(&loader->resourceManager->atlases, i);
-        atlas->glImageHandle = handle;
+    // Decode in parallel, then pack in handle order so atlas layout is deterministic
+    ImageResourceLoader_DecodeAll(loader);
+    for (int i=0; i<loader->decodeJobs.size; i++) {
+        ImageDecodeJob* job = Array_Get(&loader->decodeJobs, i);
+        if (job->buffer != NULL) ImageResourceManager_PlaceImage(resourceManager, job->imageHandle, job->buffer, job->w, job->h);
+    }
 
-        // Free atlas memory
-        free(build->buffer);
+    // Upload atlases and each large image bucket as layers of texture arrays
+    if (!resourceManager->cpuOnly) {
+        resourceManager->atlasLayerCapacity = resourceManager->atlases.size;
+        ImageResourceManager_UploadAtlasArray(resourceManager);
+        for (int i=0; i<resourceManager->largeImageBuckets.size; i++) {
+            LargeImageBucket* bucket = Array_Get(&resourceManager->largeImageBuckets, i);
+            bucket->layerCapacity = bucket->pixels.size;
+            LargeImageBucket_Upload(bucket);
+        }
+        resourceManager->uploaded = true;
     }
 
     // Free memory
-    LinearStringmap_Free(&loader->imageFilepathToHandleMap);
-}
\ No newline at end of file
+    Array_Free(&loader->decodeJobs);
+}
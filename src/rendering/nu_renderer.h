@@ -16,7 +16,19 @@ GLint uSdfRectScreenWidthLoc, uSdfRectScreenHeightLoc;
 GLuint imageShader;
 GLuint imageVao, imageVbo;
 GLint uImageScreenWidthLoc, uImageScreenHeightLoc;
-GLint uImageTextureLoc;
+GLint uImageAtlasTexturesLoc, uImageLargeTexturesLoc;
+
+// Canvas SDF primitives
+GLuint canvasPrimitiveShader;
+GLuint canvasPrimitiveVao, canvasPrimitiveVbo;
+GLint uPrimitiveScreenWidthLoc, uPrimitiveScreenHeightLoc, uPrimitiveOffsetLoc, uPrimitiveClipLoc;
+GLint uPrimitiveTransformLoc;
+
+// Canvas cache composite
+GLuint canvasCompositeShader;
+GLuint canvasCompositeVao;
+GLint uCanvasScreenWidthLoc, uCanvasScreenHeightLoc, uCanvasRectLoc, uCanvasDepthLoc;
+GLint uCanvasScissorLoc, uCanvasTextureLoc;
 
 // gui 
 GLuint BorderRectShader;
@@ -27,6 +39,7 @@ GLuint imageVao, imageVbo, imageEbo;
 GLint uBorderScreenWidthLoc, uBorderScreenHeightLoc, uBorderOffsetXLoc, uBorderOffsetYLoc;
 GLint uClippedScreenWidthLoc, uClippedScreenHeightLoc, uClippedOffsetXLoc, uClippedOffsetYLoc;
 GLint uBorderClipTopLoc, uBorderClipBottomLoc, uBorderClipLeftLoc, uBorderClipRightLoc;
+GLint uBorderTransformLoc, uClippedTransformLoc;
 
 // text
 GLuint Text_Mono_Shader_Program;
@@ -36,11 +49,25 @@ GLint uMonoScreenWidthLoc, uMonoScreenHeightLoc, uMonoFontTextureLoc;
 GLint uSubpixelScreenWidthLoc, uSubpixelScreenHeightLoc, uSubpixelFontTextureLoc;
 GLint uSubpixelOffsetXLoc, uSubpixelOffsetYLoc;
 GLint uMonoOffsetXLoc, uMonoOffsetYLoc;
+GLint uMonoTransformLoc, uSubpixelTransformLoc;
 GLint uMonoClipTopLoc, uMonoClipBottomLoc, uMonoClipLeftLoc, uMonoClipRightLoc;
 GLint uSubpixelClipTopLoc, uSubpixelClipBottomLoc, uSubpixelClipLeftLoc, uSubpixelClipRightLoc;
 GLint uMonoClipTopLoc, uMonoClipBottomLoc, uMonoClipLeftLoc, uMonoClipRightLoc;
 GLint uSubpixelClipTopLoc, uSubpixelClipBottomLoc, uSubpixelClipLeftLoc, uSubpixelClipRightLoc;
 
+// Canvas transforms are 6 floats (a, b, c, d, e, f), NULL -> identity
+void Set_Transform_Uniform(GLint location, const float* t)
+{
+    static const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    if (t == NULL) t = identity;
+    float m[9] = {
+        t[0], t[1], 0.0f,
+        t[2], t[3], 0.0f,
+        t[4], t[5], 1.0f
+    };
+    glUniformMatrix3fv(location, 1, GL_FALSE, m);
+}
+
 void NU_Init_SDF_Border_Rect_Shader()
 {
     const char* sdfRect_VertSrc =
@@ -231,13 +258,15 @@ void NU_Init_Mesh_Border_Rect_Shader()
     "uniform float uScreenHeight;\n"
     "uniform float uOffsetX;\n"
     "uniform float uOffsetY;\n"
+    "uniform mat3 uTransform;\n"
     "void main() {\n"
     "    // Convert screen position (pixels) to NDC for gl_Position\n"
-    "    float ndc_x = ((aPos.x + uOffsetX) / uScreenWidth) * 2.0 - 1.0;\n"
-    "    float ndc_y = 1.0 - ((aPos.y + uOffsetY) / uScreenHeight) * 2.0;\n"
+    "    vec2 pos = (uTransform * vec3(aPos.xy, 1.0)).xy;\n"
+    "    float ndc_x = ((pos.x + uOffsetX) / uScreenWidth) * 2.0 - 1.0;\n"
+    "    float ndc_y = 1.0 - ((pos.y + uOffsetY) / uScreenHeight) * 2.0;\n"
     "    gl_Position = vec4(ndc_x, ndc_y, aPos.z * 0.015625f, 1.0);\n"
     "    vColor = aColor;\n"
-    "    vScreenPos = vec2(aPos.x + uOffsetX, aPos.y + uOffsetY);\n"
+    "    vScreenPos = vec2(pos.x + uOffsetX, pos.y + uOffsetY);\n"
     "}\n";
 
     const char* borderRectFragSrc =
@@ -282,6 +311,13 @@ void NU_Init_Mesh_Border_Rect_Shader()
     uBorderClipBottomLoc  = glGetUniformLocation(ClippedBorderRectShader, "uClipBottom");
     uBorderClipLeftLoc    = glGetUniformLocation(ClippedBorderRectShader, "uClipLeft");
     uBorderClipRightLoc   = glGetUniformLocation(ClippedBorderRectShader, "uClipRight");
+    uBorderTransformLoc   = glGetUniformLocation(BorderRectShader, "uTransform");
+    uClippedTransformLoc  = glGetUniformLocation(ClippedBorderRectShader, "uTransform");
+    glUseProgram(BorderRectShader);
+    Set_Transform_Uniform(uBorderTransformLoc, NULL);
+    glUseProgram(ClippedBorderRectShader);
+    Set_Transform_Uniform(uClippedTransformLoc, NULL);
+    glUseProgram(0);
 
     glGenVertexArrays(1, &borderVao);
     glBindVertexArray(borderVao);
@@ -305,10 +341,13 @@ void NU_Init_Image_Shader()
     "layout(location = 2) in vec2 iSize;\n"
     "layout(location = 3) in vec4 iUV;\n"
     "layout(location = 4) in vec4 iScissor;\n"
+    "layout(location = 5) in vec2 iLayer;\n"
     "\n"
     "out vec2 vUV;\n"
     "out vec2 vScreenPos;\n"
     "out vec4 vScissor;\n"
+    "flat out vec4 vUVBounds;\n"
+    "flat out vec2 vLayer;\n"
     "\n"
     "uniform float uScreenWidth;\n"
     "uniform float uScreenHeight;\n"
@@ -322,6 +361,8 @@ void NU_Init_Image_Shader()
     "\n"
     "    vScreenPos = worldPos;\n"
     "    vScissor = iScissor;\n"
+    "    vUVBounds = iUV;\n"
+    "    vLayer = iLayer;\n"
     "\n"
     "    vUV = vec2(\n"
     "        mix(iUV.x, iUV.z, aQuad.x),\n"
@@ -329,14 +370,20 @@ void NU_Init_Image_Shader()
     "    );\n"
     "}\n";
 
+    // Both arrays are sampled and the instance's array selected afterwards, so
+    // atlas and large images share one draw call. UVs are clamped half a texel
+    // inside the image so bilinear filtering does not bleed into neighbours
     const char* imageFragSrc =
     "#version 330 core\n"
     "in vec2 vUV;\n"
     "in vec2 vScreenPos;\n"
     "in vec4 vScissor;\n"
+    "flat in vec4 vUVBounds;\n"
+    "flat in vec2 vLayer;\n"
     "out vec4 FragColor;\n"
     "\n"
-    "uniform sampler2D uTexture;\n"
+    "uniform sampler2DArray uAtlasTextures;\n"
+    "uniform sampler2DArray uLargeTextures;\n"
     "\n"
     "void main()\n"
     "{\n"
@@ -347,13 +394,20 @@ void NU_Init_Image_Shader()
     "    {\n"
     "        discard;\n"
     "    }\n"
-    "    FragColor = texture(uTexture, vUV);\n"
+    "    bool large = vLayer.y > 0.5;\n"
+    "    vec2 texSize = large ? vec2(textureSize(uLargeTextures, 0).xy) : vec2(textureSize(uAtlasTextures, 0).xy);\n"
+    "    vec2 halfTexel = 0.5 / texSize;\n"
+    "    vec2 uv = clamp(vUV, vUVBounds.xy + halfTexel, vUVBounds.zw - halfTexel);\n"
+    "    vec4 atlasColour = texture(uAtlasTextures, vec3(uv, vLayer.x));\n"
+    "    vec4 largeColour = texture(uLargeTextures, vec3(uv, vLayer.x));\n"
+    "    FragColor = large ? largeColour : atlasColour;\n"
     "}\n";
 
     ImageShader = Create_Shader_Program(imageVertSrc, imageFragSrc);
     uImageScreenWidthLoc  = glGetUniformLocation(ImageShader, "uScreenWidth");
     uImageScreenHeightLoc = glGetUniformLocation(ImageShader, "uScreenHeight");
-    uImageTextureLoc = glGetUniformLocation(ImageShader, "uTexture");
+    uImageAtlasTexturesLoc = glGetUniformLocation(ImageShader, "uAtlasTextures");
+    uImageLargeTexturesLoc = glGetUniformLocation(ImageShader, "uLargeTextures");
 
     float imageQuad[] = {
         0.0f, 0.0f,
@@ -402,6 +456,307 @@ void NU_Init_Image_Shader()
     glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ImageRenderData), (void*)offsetof(ImageRenderData, scissorTop));
     glVertexAttribDivisor(4, 1);
 
+    // Texture array layer (layer, largeImage)
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(ImageRenderData), (void*)offsetof(ImageRenderData, layer));
+    glVertexAttribDivisor(5, 1);
+
+    glBindVertexArray(0);
+}
+
+// Instance attributes start at byte offset base of canvasPrimitiveVbo, so a
+// sub range of instances can be drawn without base instance support (GL 4.2)
+static void Bind_Canvas_Primitive_Attributes(size_t base)
+{
+    // Points (x0, y0, x1, y1)
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, x0)));
+    glVertexAttribDivisor(1, 1);
+
+    // Params (z, thickness, radius, kind)
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, z)));
+    glVertexAttribDivisor(2, 1);
+
+    // Fill RGBA
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, fillRGBA)));
+    glVertexAttribDivisor(3, 1);
+
+    // Stroke RGBA
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, strokeRGBA)));
+    glVertexAttribDivisor(4, 1);
+
+    // Dash count and phase
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, dashCount)));
+    glVertexAttribDivisor(5, 1);
+
+    // Dash pattern
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, dash[0])));
+    glVertexAttribDivisor(6, 1);
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(CanvasPrimitiveRenderData), (void*)(base + offsetof(CanvasPrimitiveRenderData, dash[4])));
+    glVertexAttribDivisor(7, 1);
+}
+
+void NU_Init_Canvas_Primitive_Shader()
+{
+    const char* primitiveVertSrc =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 aQuad;\n"
+    "layout(location = 1) in vec4 iPoints;\n"
+    "layout(location = 2) in vec4 iParams;\n" // z, thickness, radius, kind
+    "layout(location = 3) in uint iFillColor;\n"
+    "layout(location = 4) in uint iStrokeColor;\n"
+    "layout(location = 5) in vec2 iDash;\n"   // count, phase
+    "layout(location = 6) in vec4 iDashA;\n"
+    "layout(location = 7) in vec4 iDashB;\n"
+    "\n"
+    "out vec2 vLocalPos;\n"
+    "out vec2 vScreenPos;\n"
+    "flat out vec2 vHalfSize;\n"
+    "flat out float vPixel;\n"
+    "flat out vec3 vParams;\n"
+    "flat out vec4 vFillColor;\n"
+    "flat out vec4 vStrokeColor;\n"
+    "flat out vec2 vDash;\n"
+    "flat out vec4 vDashA;\n"
+    "flat out vec4 vDashB;\n"
+    "\n"
+    "uniform float uScreenWidth;\n"
+    "uniform float uScreenHeight;\n"
+    "uniform vec2 uOffset;\n"
+    "uniform mat3 uTransform;\n"
+    "\n"
+    "vec4 unpackRGBA(uint c)\n"
+    "{\n"
+    "    return vec4(\n"
+    "        float((c >> 0) & 255u) / 255.0,\n"
+    "        float((c >> 8) & 255u) / 255.0,\n"
+    "        float((c >> 16) & 255u) / 255.0,\n"
+    "        float((c >> 24) & 255u) / 255.0\n"
+    "    );\n"
+    "}\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    // Size of a screen pixel in local units (edges stay 1px wide when scaled)\n"
+    "    float px = inversesqrt(max(abs(determinant(mat2(uTransform))), 1e-12));\n"
+    "    vec2 worldPos;\n"
+    "    if (iParams.w < 0.5) {\n"
+    "        // Rect: bounds grown by a pixel for the antialiased edge, local space centred\n"
+    "        vec2 size = iPoints.zw - iPoints.xy;\n"
+    "        vec2 local = aQuad * (size + 2.0 * px) - px;\n"
+    "        worldPos = iPoints.xy + local;\n"
+    "        vLocalPos = local - size * 0.5;\n"
+    "        vHalfSize = size * 0.5;\n"
+    "    } else {\n"
+    "        // Line: quad aligned to the segment, local x along it and local y across it\n"
+    "        vec2 d = iPoints.zw - iPoints.xy;\n"
+    "        float len = length(d);\n"
+    "        vec2 dir = len > 0.0 ? d / len : vec2(1.0, 0.0);\n"
+    "        vec2 normal = vec2(-dir.y, dir.x);\n"
+    "        float halfThick = iParams.y * 0.5;\n"
+    "        float u = mix(-px, len + px, aQuad.x);\n"
+    "        float v = mix(-halfThick - px, halfThick + px, aQuad.y);\n"
+    "        worldPos = iPoints.xy + dir * u + normal * v;\n"
+    "        vLocalPos = vec2(u, v);\n"
+    "        vHalfSize = vec2(len, halfThick);\n"
+    "    }\n"
+    "    vec2 screenPos = (uTransform * vec3(worldPos, 1.0)).xy + uOffset;\n"
+    "    float ndc_x = (screenPos.x / uScreenWidth) * 2.0 - 1.0;\n"
+    "    float ndc_y = 1.0 - (screenPos.y / uScreenHeight) * 2.0;\n"
+    "    gl_Position = vec4(ndc_x, ndc_y, iParams.x * 0.015625f, 1.0);\n"
+    "    vScreenPos = screenPos;\n"
+    "    vPixel = px;\n"
+    "    vParams = iParams.yzw;\n"
+    "    vFillColor = unpackRGBA(iFillColor);\n"
+    "    vStrokeColor = unpackRGBA(iStrokeColor);\n"
+    "    vDash = iDash;\n"
+    "    vDashA = iDashA;\n"
+    "    vDashB = iDashB;\n"
+    "}\n";
+
+    const char* primitiveFragSrc =
+    "#version 330 core\n"
+    "in vec2 vLocalPos;\n"
+    "in vec2 vScreenPos;\n"
+    "flat in vec2 vHalfSize;\n"
+    "flat in float vPixel;\n"
+    "flat in vec3 vParams;\n"
+    "flat in vec4 vFillColor;\n"
+    "flat in vec4 vStrokeColor;\n"
+    "flat in vec2 vDash;\n"
+    "flat in vec4 vDashA;\n"
+    "flat in vec4 vDashB;\n"
+    "out vec4 FragColor;\n"
+    "\n"
+    "uniform vec4 uClip;\n" // top, bottom, left, right
+    "\n"
+    "float sdRoundRect(vec2 p, vec2 b, float r)\n"
+    "{\n"
+    "    vec2 q = abs(p) - b + r;\n"
+    "    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;\n"
+    "}\n"
+    "\n"
+    "// Distance along the line to the nearest dash (even pattern entries are drawn)\n"
+    "float sdDash(float t)\n"
+    "{\n"
+    "    float pattern[8] = float[8](vDashA.x, vDashA.y, vDashA.z, vDashA.w, vDashB.x, vDashB.y, vDashB.z, vDashB.w);\n"
+    "    int count = int(vDash.x + 0.5);\n"
+    "    float total = 0.0;\n"
+    "    for (int i = 0; i < count; i++) total += pattern[i];\n"
+    "    if (total <= 0.0) return -1.0;\n"
+    "    t = mod(t, total);\n"
+    "    float best = 1e6;\n"
+    "    float start = 0.0;\n"
+    "    for (int i = 0; i < count; i++) {\n"
+    "        float end = start + pattern[i];\n"
+    "        if ((i & 1) == 0 && pattern[i] > 0.0) {\n"
+    "            for (int k = -1; k <= 1; k++) {\n"
+    "                float wrap = float(k) * total;\n"
+    "                best = min(best, max(start + wrap - t, t - end - wrap));\n"
+    "            }\n"
+    "        }\n"
+    "        start = end;\n"
+    "    }\n"
+    "    return best;\n"
+    "}\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    if (vScreenPos.x < uClip.z || vScreenPos.x > uClip.w ||\n"
+    "        vScreenPos.y < uClip.x || vScreenPos.y > uClip.y) {\n"
+    "        discard;\n"
+    "    }\n"
+    "    vec4 color;\n"
+    "    float alpha;\n"
+    "    if (vParams.z < 0.5) {\n"
+    "        float thickness = vParams.x;\n"
+    "        float radius = min(vParams.y, min(vHalfSize.x, vHalfSize.y));\n"
+    "        vec2 innerHalf = vHalfSize - thickness;\n"
+    "        float outer = sdRoundRect(vLocalPos, vHalfSize, radius);\n"
+    "        float outerMask = smoothstep(0.5 * vPixel, -0.5 * vPixel, outer);\n"
+    "        float innerMask = 0.0;\n"
+    "        if (innerHalf.x > 0.0 && innerHalf.y > 0.0) {\n"
+    "            float inner = sdRoundRect(vLocalPos, innerHalf, max(radius - thickness, 0.0));\n"
+    "            innerMask = smoothstep(0.5 * vPixel, -0.5 * vPixel, inner);\n"
+    "        }\n"
+    "        color = mix(vStrokeColor, vFillColor, innerMask);\n"
+    "        alpha = outerMask * color.a;\n"
+    "    } else {\n"
+    "        float d = max(abs(vLocalPos.y) - vHalfSize.y, max(-vLocalPos.x, vLocalPos.x - vHalfSize.x));\n"
+    "        if (vDash.x > 0.5) d = max(d, sdDash(vLocalPos.x + vDash.y));\n"
+    "        color = vStrokeColor;\n"
+    "        alpha = smoothstep(0.5 * vPixel, -0.5 * vPixel, d) * color.a;\n"
+    "    }\n"
+    "    if (alpha <= 0.0) discard;\n"
+    "    FragColor = vec4(color.rgb, alpha);\n"
+    "}\n";
+
+    canvasPrimitiveShader = Create_Shader_Program(primitiveVertSrc, primitiveFragSrc);
+    uPrimitiveScreenWidthLoc  = glGetUniformLocation(canvasPrimitiveShader, "uScreenWidth");
+    uPrimitiveScreenHeightLoc = glGetUniformLocation(canvasPrimitiveShader, "uScreenHeight");
+    uPrimitiveOffsetLoc       = glGetUniformLocation(canvasPrimitiveShader, "uOffset");
+    uPrimitiveClipLoc         = glGetUniformLocation(canvasPrimitiveShader, "uClip");
+    uPrimitiveTransformLoc    = glGetUniformLocation(canvasPrimitiveShader, "uTransform");
+    glUseProgram(canvasPrimitiveShader);
+    Set_Transform_Uniform(uPrimitiveTransformLoc, NULL);
+    glUseProgram(0);
+
+    float primitiveQuad[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &canvasPrimitiveVao);
+    glBindVertexArray(canvasPrimitiveVao);
+
+    // Static quad Vbo
+    GLuint quadVbo;
+    glGenBuffers(1, &quadVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(primitiveQuad), primitiveQuad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+    // Primitive instance data
+    glGenBuffers(1, &canvasPrimitiveVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, canvasPrimitiveVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CanvasPrimitiveRenderData) * 256, NULL, GL_STREAM_DRAW);
+
+    Bind_Canvas_Primitive_Attributes(0);
+    glBindVertexArray(0);
+}
+
+void NU_Init_Canvas_Composite_Shader()
+{
+    const char* canvasVertSrc =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 aQuad;\n"
+    "out vec2 vUV;\n"
+    "out vec2 vScreenPos;\n"
+    "uniform float uScreenWidth;\n"
+    "uniform float uScreenHeight;\n"
+    "uniform vec4 uRect;\n"
+    "uniform float uDepth;\n"
+    "void main() {\n"
+    "    vec2 worldPos = uRect.xy + aQuad * uRect.zw;\n"
+    "    float ndc_x = (worldPos.x / uScreenWidth) * 2.0 - 1.0;\n"
+    "    float ndc_y = 1.0 - (worldPos.y / uScreenHeight) * 2.0;\n"
+    "    gl_Position = vec4(ndc_x, ndc_y, uDepth * 0.015625f, 1.0);\n"
+    "    vScreenPos = worldPos;\n"
+    "    vUV = vec2(aQuad.x, 1.0 - aQuad.y); // framebuffer rows are bottom up\n"
+    "}\n";
+
+    // Cache textures hold premultiplied colour
+    const char* canvasFragSrc =
+    "#version 330 core\n"
+    "in vec2 vUV;\n"
+    "in vec2 vScreenPos;\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D uCanvasTexture;\n"
+    "uniform vec4 uScissor;\n"
+    "void main() {\n"
+    "    if (vScreenPos.x < uScissor.z || vScreenPos.x > uScissor.w ||\n"
+    "        vScreenPos.y < uScissor.x || vScreenPos.y > uScissor.y) {\n"
+    "        discard;\n"
+    "    }\n"
+    "    FragColor = texture(uCanvasTexture, vUV);\n"
+    "}\n";
+
+    canvasCompositeShader = Create_Shader_Program(canvasVertSrc, canvasFragSrc);
+    uCanvasScreenWidthLoc  = glGetUniformLocation(canvasCompositeShader, "uScreenWidth");
+    uCanvasScreenHeightLoc = glGetUniformLocation(canvasCompositeShader, "uScreenHeight");
+    uCanvasRectLoc         = glGetUniformLocation(canvasCompositeShader, "uRect");
+    uCanvasDepthLoc        = glGetUniformLocation(canvasCompositeShader, "uDepth");
+    uCanvasScissorLoc      = glGetUniformLocation(canvasCompositeShader, "uScissor");
+    uCanvasTextureLoc      = glGetUniformLocation(canvasCompositeShader, "uCanvasTexture");
+
+    float canvasQuad[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &canvasCompositeVao);
+    glBindVertexArray(canvasCompositeVao);
+    GLuint quadVbo;
+    glGenBuffers(1, &quadVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(canvasQuad), canvasQuad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glBindVertexArray(0);
 }
 
@@ -419,13 +774,15 @@ void NU_Init_Text_Shader()
     "uniform float uScreenHeight;\n"
     "uniform float uOffsetX;\n"
     "uniform float uOffsetY;\n"
+    "uniform mat3 uTransform;\n"
     "void main() {\n"
-    "    float ndc_x = ((aPos.x + uOffsetX) / uScreenWidth) * 2.0 - 1.0;\n"
-    "    float ndc_y = 1.0 - ((aPos.y + uOffsetY) / uScreenHeight) * 2.0;\n"
+    "    vec2 pos = (uTransform * vec3(aPos.xy, 1.0)).xy;\n"
+    "    float ndc_x = ((pos.x + uOffsetX) / uScreenWidth) * 2.0 - 1.0;\n"
+    "    float ndc_y = 1.0 - ((pos.y + uOffsetY) / uScreenHeight) * 2.0;\n"
     "    gl_Position = vec4(ndc_x, ndc_y, aPos.z * 0.015625f, 1.0);\n"
     "    vColor = aColor;\n"
     "    vUV = aUV;\n"
-    "    vScreenPos = vec2(aPos.x + uOffsetX, aPos.y + uOffsetY);\n"
+    "    vScreenPos = vec2(pos.x + uOffsetX, pos.y + uOffsetY);\n"
     "}\n";
 
     const char* textMonoFragmentSrc = 
@@ -473,7 +830,7 @@ void NU_Init_Text_Shader()
     "       // FragColor contains the text color\n"
     "       // FragColor1 contains the coverage mask\n"
     "       FragColor = vec4(vColor, 1.0);                  // Pure text color\n"
-    "       FragColor1 = vec4(lcd, 1.0);                    // Pure coverage mask\n"
+    "       FragColor1 = vec4(lcd, max(lcd.r, max(lcd.g, lcd.b))); // Coverage mask (alpha -> canvas caches)\n"
     "    }\n"
     "}\n";
 
@@ -498,6 +855,13 @@ void NU_Init_Text_Shader()
     uSubpixelClipBottomLoc   = glGetUniformLocation(Text_Subpixel_Shader_Program, "uClipBottom");
     uSubpixelClipLeftLoc     = glGetUniformLocation(Text_Subpixel_Shader_Program, "uClipLeft");
     uSubpixelClipRightLoc    = glGetUniformLocation(Text_Subpixel_Shader_Program, "uClipRight");
+    uMonoTransformLoc        = glGetUniformLocation(Text_Mono_Shader_Program, "uTransform");
+    uSubpixelTransformLoc    = glGetUniformLocation(Text_Subpixel_Shader_Program, "uTransform");
+    glUseProgram(Text_Mono_Shader_Program);
+    Set_Transform_Uniform(uMonoTransformLoc, NULL);
+    glUseProgram(Text_Subpixel_Shader_Program);
+    Set_Transform_Uniform(uSubpixelTransformLoc, NULL);
+    glUseProgram(0);
     
     glGenVertexArrays(1, &text_vao);
     glBindVertexArray(text_vao);
@@ -516,14 +880,11 @@ void NU_Init_Text_Shader()
 
 int NU_Draw_Init()
 {   
-    if (FT_Init_FreeType(&nu_global_freetype)) {
-        printf("Could not init FreeType.\n");
-        return 0;
-    }
-
     NU_Init_SDF_Border_Rect_Shader();
     NU_Init_Mesh_Border_Rect_Shader();
     NU_Init_Image_Shader();
+    NU_Init_Canvas_Primitive_Shader();
+    NU_Init_Canvas_Composite_Shader();
     NU_Init_Text_Shader();
     return 1;
 }
@@ -594,7 +955,7 @@ void Draw_Clipped_Vertex_RGB_List
     float clip_right
 )
 {
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     glUseProgram(ClippedBorderRectShader);
     glUniform1f(uClippedScreenWidthLoc, screen_width);
     glUniform1f(uClippedScreenHeightLoc, screen_height);
@@ -613,38 +974,120 @@ void Draw_Clipped_Vertex_RGB_List
     glBindVertexArray(0);
 }
 
-void NU_Draw_Images(
-    Array imageRenderDatas,
-    float screenW, 
-    float screenH,
-    GLuint imageHandle
+// Splits [0, total) at each range start. Segment 0 is untransformed, segment i
+// uses the transform of range i - 1 (ranges may be NULL)
+static int Canvas_Range_Segment(Array* ranges, u32 i, u32 total, u32* begin, u32* end)
+{
+    u32 rangeCount = ranges ? ranges->size : 0;
+    *begin = i == 0 ? 0 : ((CanvasDrawRange*)Array_Get(ranges, i - 1))->start;
+    *end = i < rangeCount ? ((CanvasDrawRange*)Array_Get(ranges, i))->start : total;
+    return i == 0 ? 0 : ((CanvasDrawRange*)Array_Get(ranges, i - 1))->transform;
+}
+
+// transforms holds 6 resolved floats per canvas transform index
+static inline const float* Canvas_Transform_At(const float* transforms, int transform)
+{
+    return transform == 0 ? NULL : transforms + transform * 6;
+}
+
+void Draw_Canvas_Mesh(
+    Vertex_RGB_List* vertices,
+    Index_List* indices,
+    Array* ranges,
+    const float* transforms,
+    float screen_width, 
+    float screen_height,
+    float offsetX,
+    float offsetY,
+    float clip_top,
+    float clip_bottom,
+    float clip_left,
+    float clip_right
 )
 {
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glUseProgram(ImageShader);
-    glUniform1f(uImageScreenWidthLoc, screenW);
-    glUniform1f(uImageScreenHeightLoc, screenH);
-    glBindVertexArray(imageVao);
-    glBindBuffer(GL_ARRAY_BUFFER, imageVbo);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, imageHandle);
-    glUniform1i(uImageTextureLoc, 0);
-    glBufferSubData(
-        GL_ARRAY_BUFFER, 0,
-        (GLsizeiptr)(imageRenderDatas.size * imageRenderDatas.elementSize),
-        imageRenderDatas.data
+    if (indices->size == 0) return;
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(ClippedBorderRectShader);
+    glUniform1f(uClippedScreenWidthLoc, screen_width);
+    glUniform1f(uClippedScreenHeightLoc, screen_height);
+    glUniform1f(uClippedOffsetXLoc, offsetX);
+    glUniform1f(uClippedOffsetYLoc, offsetY);
+    glUniform1f(uBorderClipTopLoc, clip_top);
+    glUniform1f(uBorderClipBottomLoc, clip_bottom);
+    glUniform1f(uBorderClipLeftLoc, clip_left);
+    glUniform1f(uBorderClipRightLoc, clip_right);
+    glBindBuffer(GL_ARRAY_BUFFER, borderVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices->size * sizeof(vertex_rgb), vertices->array, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, borderEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices->size * sizeof(GLuint), indices->array, GL_DYNAMIC_DRAW);
+    glBindVertexArray(borderVao);
+    u32 segments = ranges ? ranges->size + 1 : 1;
+    for (u32 i=0; i<segments; i++) {
+        u32 begin, end;
+        int transform = Canvas_Range_Segment(ranges, i, indices->size, &begin, &end);
+        if (end <= begin) continue;
+        Set_Transform_Uniform(uClippedTransformLoc, Canvas_Transform_At(transforms, transform));
+        glDrawElements(GL_TRIANGLES, end - begin, GL_UNSIGNED_INT, (void*)(begin * sizeof(GLuint)));
+    }
+    Set_Transform_Uniform(uClippedTransformLoc, NULL);
+    glBindVertexArray(0);
+}
+
+void Draw_Canvas_Primitives(
+    Array* primitives,
+    Array* ranges,
+    const float* transforms,
+    float screen_width, 
+    float screen_height,
+    float offsetX,
+    float offsetY,
+    float clip_top,
+    float clip_bottom,
+    float clip_left,
+    float clip_right
+)
+{
+    if (primitives->size == 0) return;
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(canvasPrimitiveShader);
+    glUniform1f(uPrimitiveScreenWidthLoc, screen_width);
+    glUniform1f(uPrimitiveScreenHeightLoc, screen_height);
+    glUniform2f(uPrimitiveOffsetLoc, offsetX, offsetY);
+    glUniform4f(uPrimitiveClipLoc, clip_top, clip_bottom, clip_left, clip_right);
+    glBindVertexArray(canvasPrimitiveVao);
+    glBindBuffer(GL_ARRAY_BUFFER, canvasPrimitiveVbo);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        (GLsizeiptr)(primitives->size * primitives->elementSize),
+        primitives->data,
+        GL_STREAM_DRAW
     );
-    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, imageRenderDatas.size);
+    u32 segments = ranges ? ranges->size + 1 : 1;
+    for (u32 i=0; i<segments; i++) {
+        u32 begin, end;
+        int transform = Canvas_Range_Segment(ranges, i, primitives->size, &begin, &end);
+        if (end <= begin) continue;
+        Set_Transform_Uniform(uPrimitiveTransformLoc, Canvas_Transform_At(transforms, transform));
+        if (segments > 1) Bind_Canvas_Primitive_Attributes(begin * sizeof(CanvasPrimitiveRenderData));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, end - begin);
+    }
+    if (segments > 1) {
+        Set_Transform_Uniform(uPrimitiveTransformLoc, NULL);
+        Bind_Canvas_Primitive_Attributes(0);
+    }
     glBindVertexArray(0);
 }
 
-void NU_Draw_Image(
-    ImageRenderData* renderData,
+void NU_Draw_Images(
+    const ImageRenderData* renderDatas,
+    int count,
     float screenW, 
     float screenH,
-    GLuint imageHandle
+    GLuint atlasArrayHandle,
+    GLuint largeImageArrayHandle
 )
 {
+    if (count == 0) return;
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glUseProgram(ImageShader);
     glUniform1f(uImageScreenWidthLoc, screenW);
@@ -652,22 +1095,25 @@ void NU_Draw_Image(
     glBindVertexArray(imageVao);
     glBindBuffer(GL_ARRAY_BUFFER, imageVbo);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, imageHandle);
-    glUniform1i(uImageTextureLoc, 0);
-    glBufferSubData(
-        GL_ARRAY_BUFFER, 0,
-        (GLsizeiptr)(sizeof(ImageRenderData)),
-        renderData
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlasArrayHandle);
+    glUniform1i(uImageAtlasTexturesLoc, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, largeImageArrayHandle);
+    glUniform1i(uImageLargeTexturesLoc, 1);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        (GLsizeiptr)(count * sizeof(ImageRenderData)),
+        renderDatas,
+        GL_STREAM_DRAW
     );
-    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, 1);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
     glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
 }
 
 
-void NU_Render_Text
-(
-    Vertex_RGB_UV_List* vertices, 
-    Index_List* indices, 
+// Binds the mono or subpixel text program and returns its transform location
+static GLint Use_Text_Program(
     NU_Font* font, 
     float screen_width, 
     float screen_height,
@@ -679,10 +1125,11 @@ void NU_Render_Text
     float clip_right
 )
 {
-    if (font->subpixel_rendering) glBlendFunc(GL_SRC1_COLOR, GL_ONE_MINUS_SRC1_COLOR);
-    else glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Alpha is accumulated separately so canvas caches end up premultiplied
+    if (font->subpixel_rendering) glBlendFuncSeparate(GL_SRC1_COLOR, GL_ONE_MINUS_SRC1_COLOR, GL_SRC1_ALPHA, GL_ONE_MINUS_SRC1_ALPHA);
+    else glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Render
+    GLint transformLoc;
     if (font->subpixel_rendering)
     {
         glUseProgram(Text_Subpixel_Shader_Program);
@@ -695,6 +1142,7 @@ void NU_Render_Text
         glUniform1f(uSubpixelClipBottomLoc, clip_bottom);
         glUniform1f(uSubpixelClipLeftLoc, clip_left);
         glUniform1f(uSubpixelClipRightLoc, clip_right);
+        transformLoc = uSubpixelTransformLoc;
     }
     else
     {
@@ -708,9 +1156,29 @@ void NU_Render_Text
         glUniform1f(uMonoClipBottomLoc, clip_bottom);
         glUniform1f(uMonoClipLeftLoc, clip_left);
         glUniform1f(uMonoClipRightLoc, clip_right);
+        transformLoc = uMonoTransformLoc;
     }
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, font->atlas.handle);
+    return transformLoc;
+}
+
+void NU_Render_Text
+(
+    Vertex_RGB_UV_List* vertices, 
+    Index_List* indices, 
+    NU_Font* font, 
+    float screen_width, 
+    float screen_height,
+    float offset_x,
+    float offset_y,
+    float clip_top,
+    float clip_bottom,
+    float clip_left,
+    float clip_right
+)
+{
+    Use_Text_Program(font, screen_width, screen_height, offset_x, offset_y, clip_top, clip_bottom, clip_left, clip_right);
     glBindBuffer(GL_ARRAY_BUFFER, text_vbo);
     glBufferData(GL_ARRAY_BUFFER, vertices->size * sizeof(vertex_rgb_uv), vertices->array, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, text_ebo);
@@ -718,4 +1186,152 @@ void NU_Render_Text
     glBindVertexArray(text_vao);
     glDrawElements(GL_TRIANGLES, indices->size, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+void Draw_Canvas_Text
+(
+    Vertex_RGB_UV_List* vertices, 
+    Index_List* indices, 
+    Array* ranges,
+    const float* transforms,
+    NU_Font* font, 
+    float screen_width, 
+    float screen_height,
+    float offset_x,
+    float offset_y,
+    float clip_top,
+    float clip_bottom,
+    float clip_left,
+    float clip_right
+)
+{
+    if (indices->size == 0) return;
+    GLint transformLoc = Use_Text_Program(font, screen_width, screen_height, offset_x, offset_y, clip_top, clip_bottom, clip_left, clip_right);
+    glBindBuffer(GL_ARRAY_BUFFER, text_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices->size * sizeof(vertex_rgb_uv), vertices->array, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, text_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices->size * sizeof(GLuint), indices->array, GL_DYNAMIC_DRAW);
+    glBindVertexArray(text_vao);
+    u32 segments = ranges ? ranges->size + 1 : 1;
+    for (u32 i=0; i<segments; i++) {
+        u32 begin, end;
+        int transform = Canvas_Range_Segment(ranges, i, indices->size, &begin, &end);
+        if (end <= begin) continue;
+        Set_Transform_Uniform(transformLoc, Canvas_Transform_At(transforms, transform));
+        glDrawElements(GL_TRIANGLES, end - begin, GL_UNSIGNED_INT, (void*)(begin * sizeof(GLuint)));
+    }
+    Set_Transform_Uniform(transformLoc, NULL);
+    glBindVertexArray(0);
+}
+
+
+// --------------------------
+// --- Canvas Render Cache ---
+// --------------------------
+void CanvasRenderCache_Init(CanvasRenderCache* cache)
+{
+    cache->msaaFramebuffer = 0;
+    cache->msaaColorBuffer = 0;
+    cache->msaaDepthBuffer = 0;
+    cache->framebuffer = 0;
+    cache->texture = 0;
+    cache->width = 0;
+    cache->height = 0;
+}
+
+void CanvasRenderCache_Free(CanvasRenderCache* cache)
+{
+    if (cache->texture == 0) return;
+    glDeleteFramebuffers(1, &cache->msaaFramebuffer);
+    glDeleteFramebuffers(1, &cache->framebuffer);
+    glDeleteRenderbuffers(1, &cache->msaaColorBuffer);
+    glDeleteRenderbuffers(1, &cache->msaaDepthBuffer);
+    glDeleteTextures(1, &cache->texture);
+    CanvasRenderCache_Init(cache);
+}
+
+// Returns true if the cache had to be (re)created, in which case its content is undefined
+bool CanvasRenderCache_Resize(CanvasRenderCache* cache, int width, int height)
+{
+    if (cache->texture != 0 && cache->width == width && cache->height == height) return false;
+    CanvasRenderCache_Free(cache);
+    cache->width = width;
+    cache->height = height;
+
+    // Resolve target (sampled when compositing)
+    glGenTextures(1, &cache->texture);
+    glBindTexture(GL_TEXTURE_2D, cache->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenFramebuffers(1, &cache->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cache->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cache->texture, 0);
+
+    // Multisampled render target (matches the window's 4x MSAA)
+    glGenRenderbuffers(1, &cache->msaaColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, cache->msaaColorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &cache->msaaDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, cache->msaaDepthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH_COMPONENT24, width, height);
+    glGenFramebuffers(1, &cache->msaaFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cache->msaaFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, cache->msaaColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, cache->msaaDepthBuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// Redirects drawing into the cache. Returns the framebuffer to restore in CanvasRenderCache_End()
+GLint CanvasRenderCache_Begin(CanvasRenderCache* cache)
+{
+    GLint prevFramebuffer;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cache->msaaFramebuffer);
+    glViewport(0, 0, cache->width, cache->height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return prevFramebuffer;
+}
+
+void CanvasRenderCache_End(CanvasRenderCache* cache, GLint prevFramebuffer, float screenW, float screenH)
+{
+    // Resolve samples into the texture
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, cache->msaaFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache->framebuffer);
+    glBlitFramebuffer(0, 0, cache->width, cache->height, 0, 0, cache->width, cache->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prevFramebuffer);
+    glViewport(0, 0, (int)screenW, (int)screenH);
+}
+
+void NU_Draw_Canvas_Cache(
+    CanvasRenderCache* cache,
+    float x, float y, float z,
+    float screenW, 
+    float screenH,
+    float clip_top,
+    float clip_bottom,
+    float clip_left,
+    float clip_right
+)
+{
+    if (cache->texture == 0) return;
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(canvasCompositeShader);
+    glUniform1f(uCanvasScreenWidthLoc, screenW);
+    glUniform1f(uCanvasScreenHeightLoc, screenH);
+    glUniform4f(uCanvasRectLoc, x, y, (float)cache->width, (float)cache->height);
+    glUniform1f(uCanvasDepthLoc, z);
+    glUniform4f(uCanvasScissorLoc, clip_top, clip_bottom, clip_left, clip_right);
+    glUniform1i(uCanvasTextureLoc, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, cache->texture);
+    glBindVertexArray(canvasCompositeVao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+}
@@ -11,6 +11,10 @@ typedef struct {
     float r, g, b;
 } NU_RGB;
 
+typedef struct {
+    float x, y, w, h;
+} NU_Rect;
+
 typedef struct {
     float x, y, z; 
     float r, g, b;
@@ -67,31 +71,132 @@ typedef struct ImageRenderData {
     float u0, v0;
     float u1, v1;
     float scissorTop, scissorBottom, scissorLeft, scissorRight;
+    float layer;      // Layer in the texture array
+    float largeImage; // 0 -> atlas array, otherwise 1 + large image bucket
 } ImageRenderData;
 
+#define CANVAS_PRIMITIVE_RECT 0.0f
+#define CANVAS_PRIMITIVE_LINE 1.0f
+#define CANVAS_MAX_DASH_PATTERN 8
+
+// One instance per canvas rect or line segment, shaded by an SDF
+typedef struct CanvasPrimitiveRenderData {
+    float x0, y0, x1, y1; // rect top left / bottom right, or line end points
+    float z;
+    float thickness;      // rect border or line width
+    float radius;         // rect corner radius
+    float kind;           // CANVAS_PRIMITIVE_RECT or CANVAS_PRIMITIVE_LINE
+    u32 fillRGBA;
+    u32 strokeRGBA;
+    float dashCount;      // 0 -> solid line
+    float dashPhase;      // distance into the dash pattern at x0, y0
+    float dash[CANVAS_MAX_DASH_PATTERN];
+} CanvasPrimitiveRenderData;
+
+// 2D affine canvas transform: x' = a*x + c*y + e, y' = b*x + d*y + f
+typedef struct {
+    float a, b, c, d, e, f;
+    int parent; // transform it was pushed on top of (applied after it)
+} CanvasTransform;
+
+// Geometry from start (first index or instance) up to the next range's start is
+// drawn with the given transform. Geometry before the first range is untransformed
+typedef struct {
+    u32 start;
+    u32 vertexStart;
+    int transform;
+} CanvasDrawRange;
+
 typedef struct {
     Vertex_RGB_List vertices;
     Index_List indices;
+    Array primitives;      // CanvasPrimitiveRenderData
+    Array meshRanges;      // CanvasDrawRange over indices
+    Array primitiveRanges; // CanvasDrawRange over primitives
 } CanvasShapeLayer;
 
 typedef struct {
     Vertex_RGB_UV_List vertices;
     Index_List indices;
+    Array ranges; // CanvasDrawRange over indices
     int fontID;
 } CanvasTextLayer;
 
+// Offscreen copy of a canvas' content box. Content is rendered into a
+// multisampled framebuffer and resolved into the texture that is composited
+typedef struct {
+    GLuint msaaFramebuffer;
+    GLuint msaaColorBuffer;
+    GLuint msaaDepthBuffer;
+    GLuint framebuffer;
+    GLuint texture;
+    int width;
+    int height;
+} CanvasRenderCache;
+
+#define SCROLL_TILE_HEIGHT 512
+
+// Horizontal band of a scroll container's content, index * SCROLL_TILE_HEIGHT
+// pixels below the top of the content
+typedef struct {
+    CanvasRenderCache target;
+    int index;
+    bool dirty;
+} ScrollTile;
+
+// Content of a vertical scroll container, rendered once into tiles so scrolling
+// only moves the composited tiles. Tiles are re-rendered when a node inside the
+// container changed since they were drawn, or when scrolled into view for the first time
+typedef struct {
+    Array tiles; // ScrollTile
+    float subpixelX; // node x - tile origin the tiles were drawn with (moves with ancestors' layout)
+    bool dirty;     // a node inside changed (see NU_Scroll_Cache_Invalidate)
+    bool cacheable; // subtree can be drawn from tiles (checked again once dirty)
+    bool active;    // drawn from tiles in the last generated drawlists
+} ScrollRenderCache;
+
+// Offscreen texture holding the descendants of a node promoted with "layer: true"
+typedef struct LayerRenderCache
+{
+    CanvasRenderCache target;
+    u64 signature;        // paint signature of the subtree in the texture
+    u64 pendingSignature; // paint signature computed for the next frame
+    float originX, originY; // window position of the texture's top left corner
+    int width, height;
+    bool valid;
+} LayerRenderCache;
+
+// Geometry recorded by canvas draw calls, plus the state needed to keep recording
 typedef struct {
     CanvasShapeLayer shapeLayer;
     Array textLayers;
-
-    // State
+    Array transforms; // CanvasTransform, entry 0 is the identity
+    int transformIndex; // top of the transform stack
     bool isShapeLayer;
+    bool isPrimitive; // last shape was an SDF primitive (not mesh geometry)
     int fontID;
     int z;
-    int textLayerIndex;
+    int textLayerIndex; // layer of the current font
+    int textLayerCount; // one layer per font used since the last clear
+} CanvasDrawBuffer;
+
+// Contexts are heap allocated and reference counted so a worker thread can keep using one
+// while the UI thread adds or removes contexts (see NU_Canvas_Acquire). Double buffered
+// contexts record into the back buffer and only swap it with the rendered front buffer on commit.
+// front, doubleBuffered and dirty are shared by the recording and rendering threads, so atomic
+typedef struct {
+    CanvasDrawBuffer buffers[2];
+    SDL_AtomicInt front;
+    SDL_AtomicInt doubleBuffered;
+    SDL_Mutex* swapMutex; // held while the front buffer is read or swapped
+    CanvasRenderCache cache;
+    SDL_AtomicInt dirty; // front buffer changed since the cache was last rendered
+    bool decimate; // M4 decimation of dense polylines
     float canvasWidth;
     float canvasHeight;
-    NodeP* node;
+    NodeP* node;       // UI thread only
+    SDL_AtomicInt layer; // node's layer, kept by the UI thread for recording on workers
+    int refs;          // the context list's reference plus one per call in flight (guarded by GUI.canvasMutex)
 } NU_Canvas_Context;
 
 void RGB_From_Hex(const char* hexstring, NU_RGB* result)
@@ -0,0 +1,1044 @@
+#pragma once
+#include <emmintrin.h>
+#include <omp.h>
+#include <math.h>
+#include <rendering/nu_renderer_structures.h>
+#include <rendering/image/nu_image.h>
+
+// ----------------------------------------------------------------------------------
+// CPU rasterizer that mirrors the GL backend (SDF rects, glyph quads, image quads,
+// canvas SDF primitives and vertex_rgb meshes) into an RGBA8 framebuffer. Depth
+// follows the GL path: NDC z (z * 0.015625), cleared to -1, tested with >= and
+// clipped above 1. The frame is recorded into a command list and replayed per
+// 64x64 tile on the OpenMP pool.
+// ----------------------------------------------------------------------------------
+
+#define SOFTWARE_TILE_SIZE 64
+
+// Opaque in the public header (read through NU_Framebuffer_Pixels)
+typedef struct NU_Framebuffer
+{
+    u32* pixels;   // RGBA8, same byte order as PackRGBA()
+    float* depth;  // internal depth buffer
+    int width;
+    int height;
+    int fixedWidth, fixedHeight; // 0 -> follows the window size
+} NU_Framebuffer;
+
+typedef struct SoftwareTile
+{
+    int x0, y0; // inclusive
+    int x1, y1; // exclusive
+} SoftwareTile;
+
+typedef enum SoftwareCommandType
+{
+    SOFTWARE_CMD_BORDER_RECTS,
+    SOFTWARE_CMD_MESH,
+    SOFTWARE_CMD_TEXT,
+    SOFTWARE_CMD_IMAGES,
+    SOFTWARE_CMD_CANVAS_PRIMITIVES
+} SoftwareCommandType;
+
+typedef struct SoftwareCommand
+{
+    SoftwareCommandType type;
+    bool ownsData;
+    void* data;         // BorderRectRenderData*, vertex_rgb*, vertex_rgb_uv*, ImageRenderData* or CanvasPrimitiveRenderData*
+    GLuint* indices;    // Mesh and text only
+    u32 count;          // Instance count (rects, images, primitives) or index count (mesh, text)
+    const unsigned char* texture;
+    int texW, texH, texChannels;
+    ImageResourceManager* imageManager; // Images only (texture is resolved per instance)
+    bool subpixel;
+    float offsetX, offsetY;
+    NU_ClipBounds clip;
+} SoftwareCommand;
+
+int NU_Framebuffer_Resize(NU_Framebuffer* fb, int width, int height)
+{
+    if (fb->pixels != NULL && fb->width == width && fb->height == height) return 1;
+    free(fb->pixels);
+    free(fb->depth);
+    fb->pixels = malloc(sizeof(u32) * width * height);
+    fb->depth = malloc(sizeof(float) * width * height);
+    if (fb->pixels == NULL || fb->depth == NULL) {
+        free(fb->pixels); free(fb->depth);
+        fb->pixels = NULL; fb->depth = NULL;
+        fb->width = 0; fb->height = 0;
+        return 0;
+    }
+    fb->width = width;
+    fb->height = height;
+    return 1;
+}
+
+NU_Framebuffer* NU_Framebuffer_Create(int width, int height)
+{
+    NU_Framebuffer* fb = calloc(1, sizeof(NU_Framebuffer));
+    if (fb == NULL) return NULL;
+    if (width > 0 && height > 0) {
+        fb->fixedWidth = width;
+        fb->fixedHeight = height;
+    }
+    return fb;
+}
+
+void NU_Framebuffer_Free(NU_Framebuffer* fb)
+{
+    if (fb == NULL) return;
+    free(fb->pixels);
+    free(fb->depth);
+    free(fb);
+}
+
+// -----------------------
+// --- Pixel Functions ---
+// -----------------------
+static inline float Software_Clamp01(float x)
+{
+    return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+static inline float Software_Smoothstep(float edge0, float edge1, float x)
+{
+    float t = Software_Clamp01((x - edge0) / (edge1 - edge0));
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static inline float Software_SD_Round_Rect(float px, float py, float bx, float by, float r)
+{
+    float qx = fabsf(px) - bx + r;
+    float qy = fabsf(py) - by + r;
+    float mx = fmaxf(qx, 0.0f);
+    float my = fmaxf(qy, 0.0f);
+    return sqrtf(mx * mx + my * my) + fminf(fmaxf(qx, qy), 0.0f) - r;
+}
+
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), applied to alpha as well
+static inline u32 Software_Blend(u32 dst, float r, float g, float b, float a)
+{
+    float inv = 1.0f - a;
+    float outR = r * a * 255.0f + (float)((dst >> 0) & 255u) * inv;
+    float outG = g * a * 255.0f + (float)((dst >> 8) & 255u) * inv;
+    float outB = b * a * 255.0f + (float)((dst >> 16) & 255u) * inv;
+    float outA = a * a * 255.0f + (float)((dst >> 24) & 255u) * inv;
+    return PackRGBA((u8)(outR + 0.5f), (u8)(outG + 0.5f), (u8)(outB + 0.5f), (u8)(outA + 0.5f));
+}
+
+// glBlendFunc(GL_SRC1_COLOR, GL_ONE_MINUS_SRC1_COLOR) with the subpixel coverage as source 1
+static inline u32 Software_Blend_Subpixel(u32 dst, float r, float g, float b, float covR, float covG, float covB)
+{
+    float outR = r * covR * 255.0f + (float)((dst >> 0) & 255u) * (1.0f - covR);
+    float outG = g * covG * 255.0f + (float)((dst >> 8) & 255u) * (1.0f - covG);
+    float outB = b * covB * 255.0f + (float)((dst >> 16) & 255u) * (1.0f - covB);
+    return PackRGBA((u8)(outR + 0.5f), (u8)(outG + 0.5f), (u8)(outB + 0.5f), 255);
+}
+
+// Bilinear, clamp to edge (matches GL_LINEAR + GL_CLAMP_TO_EDGE). Output in [0, 1]
+static inline void Software_Sample_Bilinear(const unsigned char* tex, int w, int h, int channels, float u, float v, float* out)
+{
+    float tx = u * (float)w - 0.5f;
+    float ty = v * (float)h - 0.5f;
+    float fx0 = floorf(tx);
+    float fy0 = floorf(ty);
+    float fx = tx - fx0;
+    float fy = ty - fy0;
+    int x0 = (int)fx0, y0 = (int)fy0;
+    int x1 = x0 + 1, y1 = y0 + 1;
+    x0 = x0 < 0 ? 0 : (x0 >= w ? w - 1 : x0);
+    x1 = x1 < 0 ? 0 : (x1 >= w ? w - 1 : x1);
+    y0 = y0 < 0 ? 0 : (y0 >= h ? h - 1 : y0);
+    y1 = y1 < 0 ? 0 : (y1 >= h ? h - 1 : y1);
+    const unsigned char* t00 = tex + (y0 * w + x0) * channels;
+    const unsigned char* t10 = tex + (y0 * w + x1) * channels;
+    const unsigned char* t01 = tex + (y1 * w + x0) * channels;
+    const unsigned char* t11 = tex + (y1 * w + x1) * channels;
+    for (int c=0; c<channels; c++) {
+        float top = (float)t00[c] + ((float)t10[c] - (float)t00[c]) * fx;
+        float bottom = (float)t01[c] + ((float)t11[c] - (float)t01[c]) * fx;
+        out[c] = (top + (bottom - top) * fy) * 0.003921568627451f;
+    }
+}
+
+// Pixel centres inside [lo, hi) in screen space -> integer pixel range [*p0, *p1)
+static inline void Software_Pixel_Range(float lo, float hi, int tileLo, int tileHi, int* p0, int* p1)
+{
+    int a = (int)ceilf(lo - 0.5f);
+    int b = (int)ceilf(hi - 0.5f);
+    *p0 = a > tileLo ? a : tileLo;
+    *p1 = b < tileHi ? b : tileHi;
+}
+
+// Pixel centres inside the inclusive clip [lo, hi] (shader discard semantics)
+static inline void Software_Clip_Range(float lo, float hi, int* p0, int* p1)
+{
+    int a = (int)ceilf(fmaxf(lo, -1.0e8f) - 0.5f);
+    int b = (int)floorf(fminf(hi, 1.0e8f) - 0.5f) + 1;
+    if (a > *p0) *p0 = a;
+    if (b < *p1) *p1 = b;
+}
+
+// ---------------------------
+// --- SIMD Span Functions ---
+// ---------------------------
+static void Software_Fill_Span(u32* pixels, float* depth, int count, u32 colour, float z)
+{
+    __m128i c = _mm_set1_epi32((int)colour);
+    __m128 zv = _mm_set1_ps(z);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(depth + i);
+        __m128 pass = _mm_cmpge_ps(zv, d);
+        __m128i mask = _mm_castps_si128(pass);
+        __m128i p = _mm_loadu_si128((__m128i*)(pixels + i));
+        p = _mm_or_si128(_mm_and_si128(mask, c), _mm_andnot_si128(mask, p));
+        _mm_storeu_si128((__m128i*)(pixels + i), p);
+        _mm_storeu_ps(depth + i, _mm_or_ps(_mm_and_ps(pass, zv), _mm_andnot_ps(pass, d)));
+    }
+    for (; i < count; i++) {
+        if (z >= depth[i]) { pixels[i] = colour; depth[i] = z; }
+    }
+}
+
+static void Software_Blend_Span(u32* pixels, float* depth, int count, u32 colour, float z)
+{
+    int r = (int)(colour & 255u);
+    int g = (int)((colour >> 8) & 255u);
+    int b = (int)((colour >> 16) & 255u);
+    int a = (int)((colour >> 24) & 255u);
+
+    // out = (src * a + dst * (255 - a) + 128) / 255, per 16 bit lane
+    __m128i srcTerm = _mm_set_epi16(
+        (short)(a * a + 128), (short)(b * a + 128), (short)(g * a + 128), (short)(r * a + 128),
+        (short)(a * a + 128), (short)(b * a + 128), (short)(g * a + 128), (short)(r * a + 128));
+    __m128i invA = _mm_set1_epi16((short)(255 - a));
+    __m128i zero = _mm_setzero_si128();
+    __m128 zv = _mm_set1_ps(z);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(depth + i);
+        __m128 pass = _mm_cmpge_ps(zv, d);
+        __m128i mask = _mm_castps_si128(pass);
+        __m128i p = _mm_loadu_si128((__m128i*)(pixels + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), invA), srcTerm);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), invA), srcTerm);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        __m128i blended = _mm_packus_epi16(lo, hi);
+        p = _mm_or_si128(_mm_and_si128(mask, blended), _mm_andnot_si128(mask, p));
+        _mm_storeu_si128((__m128i*)(pixels + i), p);
+        _mm_storeu_ps(depth + i, _mm_or_ps(_mm_and_ps(pass, zv), _mm_andnot_ps(pass, d)));
+    }
+    float af = (float)a * 0.003921568627451f;
+    for (; i < count; i++) {
+        if (z < depth[i]) continue;
+        pixels[i] = Software_Blend(pixels[i], (float)r * 0.003921568627451f, (float)g * 0.003921568627451f, (float)b * 0.003921568627451f, af);
+        depth[i] = z;
+    }
+}
+
+// -----------------------------
+// --- Primitive Rasterizers ---
+// -----------------------------
+static void Software_Raster_Border_Rect(NU_Framebuffer* fb, SoftwareTile* tile, BorderRectRenderData* rect)
+{
+    float z = rect->z * 0.015625f;
+    if (z > 1.0f) return;
+
+    // Pixel bounds -> quad & scissor & tile
+    int x0, x1, y0, y1;
+    Software_Pixel_Range(rect->x, rect->x + rect->w, tile->x0, tile->x1, &x0, &x1);
+    Software_Pixel_Range(rect->y, rect->y + rect->h, tile->y0, tile->y1, &y0, &y1);
+    Software_Clip_Range(rect->scissorLeft, rect->scissorRight, &x0, &x1);
+    Software_Clip_Range(rect->scissorTop, rect->scissorBottom, &y0, &y1);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Shape (same terms as the sdfRect fragment shader)
+    float halfW = rect->w * 0.5f;
+    float halfH = rect->h * 0.5f;
+    float innerRTl = fmaxf(rect->radiusTl - fmaxf(rect->borderTop, rect->borderLeft), 0.0f);
+    float innerRTr = fmaxf(rect->radiusTr - fmaxf(rect->borderTop, rect->borderRight), 0.0f);
+    float innerRBl = fmaxf(rect->radiusBl - fmaxf(rect->borderBottom, rect->borderLeft), 0.0f);
+    float innerRBr = fmaxf(rect->radiusBr - fmaxf(rect->borderBottom, rect->borderRight), 0.0f);
+    float innerOffsetX = (rect->borderLeft - rect->borderRight) * 0.5f;
+    float innerOffsetY = (rect->borderTop - rect->borderBottom) * 0.5f;
+    float innerHalfW = fmaxf(halfW - (rect->borderLeft + rect->borderRight) * 0.5f, 0.0f);
+    float innerHalfH = fmaxf(halfH - (rect->borderTop + rect->borderBottom) * 0.5f, 0.0f);
+    int hasInner = innerHalfW > 0.0f && innerHalfH > 0.0f;
+
+    // Colours
+    u32 bg = rect->backgroundRGBA;
+    u32 border = rect->borderRGBA;
+    float bgR = (float)(bg & 255u) * 0.003921568627451f;
+    float bgG = (float)((bg >> 8) & 255u) * 0.003921568627451f;
+    float bgB = (float)((bg >> 16) & 255u) * 0.003921568627451f;
+    float bgA = (float)((bg >> 24) & 255u) * 0.003921568627451f;
+    float bR = (float)(border & 255u) * 0.003921568627451f;
+    float bG = (float)((border >> 8) & 255u) * 0.003921568627451f;
+    float bB = (float)((border >> 16) & 255u) * 0.003921568627451f;
+
+    // Interior (fill only, fully covered) region -> SIMD spans
+    float maxR = fmaxf(fmaxf(rect->radiusTl, rect->radiusTr), fmaxf(rect->radiusBl, rect->radiusBr));
+    float innerLeft = rect->x + rect->borderLeft;
+    float innerRight = rect->x + rect->w - rect->borderRight;
+    float innerTop = rect->y + rect->borderTop;
+    float innerBottom = rect->y + rect->h - rect->borderBottom;
+    int spanX0 = max(x0, (int)ceilf(innerLeft));
+    int spanX1 = min(x1, (int)floorf(innerRight));
+    u32 bgAlpha = bg >> 24;
+
+    for (int py = y0; py < y1; py++)
+    {
+        u32* pixelRow = fb->pixels + py * fb->width;
+        float* depthRow = fb->depth + py * fb->width;
+        float cy = (float)py + 0.5f;
+        int interiorRow = hasInner && spanX0 < spanX1 &&
+            cy >= innerTop + maxR + 0.5f && cy <= innerBottom - maxR - 0.5f;
+
+        for (int px = x0; px < x1; px++)
+        {
+            if (interiorRow && px == spanX0) {
+                if (bgAlpha == 255u) Software_Fill_Span(pixelRow + spanX0, depthRow + spanX0, spanX1 - spanX0, bg, z);
+                else if (bgAlpha != 0u) Software_Blend_Span(pixelRow + spanX0, depthRow + spanX0, spanX1 - spanX0, bg, z);
+                px = spanX1 - 1;
+                continue;
+            }
+
+            float lx = (float)px + 0.5f - rect->x - halfW;
+            float ly = cy - rect->y - halfH;
+            float outerR = lx > 0.0f ? (ly > 0.0f ? rect->radiusBr : rect->radiusTr) : (ly > 0.0f ? rect->radiusBl : rect->radiusTl);
+            float innerR = lx > 0.0f ? (ly > 0.0f ? innerRBr : innerRTr) : (ly > 0.0f ? innerRBl : innerRTl);
+            float outer = Software_SD_Round_Rect(lx, ly, halfW, halfH, outerR);
+            float inner = Software_SD_Round_Rect(lx - innerOffsetX, ly - innerOffsetY, innerHalfW, innerHalfH, innerR);
+            float outerMask = Software_Smoothstep(0.5f, -0.5f, outer);
+            float innerMask = hasInner ? Software_Smoothstep(0.5f, -0.5f, inner) : 1.0f;
+            float fillMask = innerMask * bgA;
+            float borderMask = Software_Clamp01(outerMask - innerMask);
+            float alpha = Software_Clamp01(fillMask + borderMask);
+            if (alpha <= 0.0f || z < depthRow[px]) continue;
+
+            if (borderMask > fillMask) pixelRow[px] = Software_Blend(pixelRow[px], bR, bG, bB, alpha);
+            else pixelRow[px] = Software_Blend(pixelRow[px], bgR, bgG, bgB, alpha);
+            depthRow[px] = z;
+        }
+    }
+}
+
+static void Software_Raster_Triangle(NU_Framebuffer* fb, SoftwareTile* tile, vertex_rgb* a, vertex_rgb* b, vertex_rgb* c, float offsetX, float offsetY, NU_ClipBounds* clip)
+{
+    float ax = a->x + offsetX, ay = a->y + offsetY;
+    float bx = b->x + offsetX, by = b->y + offsetY;
+    float cx = c->x + offsetX, cy = c->y + offsetY;
+    float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if (fabsf(area) < 1e-6f) return;
+    float invArea = 1.0f / area;
+
+    int x0, x1, y0, y1;
+    Software_Pixel_Range(fminf(ax, fminf(bx, cx)), fmaxf(ax, fmaxf(bx, cx)), tile->x0, tile->x1, &x0, &x1);
+    Software_Pixel_Range(fminf(ay, fminf(by, cy)), fmaxf(ay, fmaxf(by, cy)), tile->y0, tile->y1, &y0, &y1);
+    Software_Clip_Range(clip->left, clip->right, &x0, &x1);
+    Software_Clip_Range(clip->top, clip->bottom, &y0, &y1);
+
+    for (int py = y0; py < y1; py++)
+    {
+        u32* pixelRow = fb->pixels + py * fb->width;
+        float* depthRow = fb->depth + py * fb->width;
+        float sy = (float)py + 0.5f;
+        for (int px = x0; px < x1; px++)
+        {
+            float sx = (float)px + 0.5f;
+
+            // Barycentric weights (sign normalised by the triangle's winding)
+            float w0 = ((bx - sx) * (cy - sy) - (by - sy) * (cx - sx)) * invArea;
+            float w1 = ((cx - sx) * (ay - sy) - (cy - sy) * (ax - sx)) * invArea;
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+            float z = (w0 * a->z + w1 * b->z + w2 * c->z) * 0.015625f;
+            if (z > 1.0f || z < depthRow[px]) continue;
+            float r = Software_Clamp01(w0 * a->r + w1 * b->r + w2 * c->r);
+            float g = Software_Clamp01(w0 * a->g + w1 * b->g + w2 * c->g);
+            float bl = Software_Clamp01(w0 * a->b + w1 * b->b + w2 * c->b);
+            pixelRow[px] = PackRGBA((u8)(r * 255.0f + 0.5f), (u8)(g * 255.0f + 0.5f), (u8)(bl * 255.0f + 0.5f), 255);
+            depthRow[px] = z;
+        }
+    }
+}
+
+static void Software_Raster_Glyph(NU_Framebuffer* fb, SoftwareTile* tile, SoftwareCommand* cmd, vertex_rgb_uv* tl, vertex_rgb_uv* br)
+{
+    float z = tl->z * 0.015625f;
+    if (z > 1.0f) return;
+    float left = tl->x + cmd->offsetX;
+    float top = tl->y + cmd->offsetY;
+    float right = br->x + cmd->offsetX;
+    float bottom = br->y + cmd->offsetY;
+    if (right <= left || bottom <= top) return;
+
+    int x0, x1, y0, y1;
+    Software_Pixel_Range(left, right, tile->x0, tile->x1, &x0, &x1);
+    Software_Pixel_Range(top, bottom, tile->y0, tile->y1, &y0, &y1);
+    Software_Clip_Range(cmd->clip.left, cmd->clip.right, &x0, &x1);
+    Software_Clip_Range(cmd->clip.top, cmd->clip.bottom, &y0, &y1);
+    float du = (br->u - tl->u) / (right - left);
+    float dv = (br->v - tl->v) / (bottom - top);
+
+    for (int py = y0; py < y1; py++)
+    {
+        u32* pixelRow = fb->pixels + py * fb->width;
+        float* depthRow = fb->depth + py * fb->width;
+        float v = tl->v + ((float)py + 0.5f - top) * dv;
+        for (int px = x0; px < x1; px++)
+        {
+            if (z < depthRow[px]) continue;
+            float u = tl->u + ((float)px + 0.5f - left) * du;
+            float coverage[3];
+            Software_Sample_Bilinear(cmd->texture, cmd->texW, cmd->texH, cmd->texChannels, u, v, coverage);
+            if (cmd->subpixel) {
+                pixelRow[px] = Software_Blend_Subpixel(pixelRow[px], tl->r, tl->g, tl->b, coverage[0], coverage[1], coverage[2]);
+            } else {
+                if (coverage[0] <= 0.0f) continue; // Blending a zero alpha is a no-op apart from depth
+                pixelRow[px] = Software_Blend(pixelRow[px], tl->r, tl->g, tl->b, coverage[0]);
+            }
+            depthRow[px] = z;
+        }
+    }
+}
+
+static void Software_Raster_Image(NU_Framebuffer* fb, SoftwareTile* tile, SoftwareCommand* cmd, ImageRenderData* image)
+{
+    float z = image->z * 0.015625f;
+    if (z > 1.0f || image->w <= 0.0f || image->h <= 0.0f) return;
+
+    // UVs are relative to the texture array layer, which can be larger than the image
+    int layerW, layerH;
+    ImagePixels* pixels = ImageResourceManager_GetLayerPixels(cmd->imageManager, image, &layerW, &layerH);
+    if (pixels->data == NULL) return;
+    float uScale = (float)layerW / (float)pixels->w;
+    float vScale = (float)layerH / (float)pixels->h;
+
+    int x0, x1, y0, y1;
+    Software_Pixel_Range(image->x, image->x + image->w, tile->x0, tile->x1, &x0, &x1);
+    Software_Pixel_Range(image->y, image->y + image->h, tile->y0, tile->y1, &y0, &y1);
+    Software_Clip_Range(image->scissorLeft, image->scissorRight, &x0, &x1);
+    Software_Clip_Range(image->scissorTop, image->scissorBottom, &y0, &y1);
+    float du = (image->u1 - image->u0) / image->w;
+    float dv = (image->v1 - image->v0) / image->h;
+
+    // Clamp half a texel inside the image (matches the image shader)
+    float uMin = image->u0 + 0.5f / (float)layerW, uMax = image->u1 - 0.5f / (float)layerW;
+    float vMin = image->v0 + 0.5f / (float)layerH, vMax = image->v1 - 0.5f / (float)layerH;
+
+    for (int py = y0; py < y1; py++)
+    {
+        u32* pixelRow = fb->pixels + py * fb->width;
+        float* depthRow = fb->depth + py * fb->width;
+        float v = image->v0 + ((float)py + 0.5f - image->y) * dv;
+        v = fminf(fmaxf(v, vMin), vMax);
+        for (int px = x0; px < x1; px++)
+        {
+            if (z < depthRow[px]) continue;
+            float u = image->u0 + ((float)px + 0.5f - image->x) * du;
+            u = fminf(fmaxf(u, uMin), uMax);
+            float texel[4];
+            Software_Sample_Bilinear(pixels->data, pixels->w, pixels->h, 4, u * uScale, v * vScale, texel);
+            pixelRow[px] = Software_Blend(pixelRow[px], texel[0], texel[1], texel[2], texel[3]);
+            depthRow[px] = z;
+        }
+    }
+}
+
+// Distance along a line to the nearest dash (same as sdDash in the primitive shader)
+static float Software_SD_Dash(CanvasPrimitiveRenderData* line, float t)
+{
+    int count = (int)(line->dashCount + 0.5f);
+    float total = 0.0f;
+    for (int i=0; i<count; i++) total += line->dash[i];
+    if (total <= 0.0f) return -1.0f;
+    t = t - total * floorf(t / total);
+    float best = 1e6f;
+    float start = 0.0f;
+    for (int i=0; i<count; i++) {
+        float end = start + line->dash[i];
+        if ((i & 1) == 0 && line->dash[i] > 0.0f) {
+            for (int k=-1; k<=1; k++) {
+                float wrap = (float)k * total;
+                best = fminf(best, fmaxf(start + wrap - t, t - end - wrap));
+            }
+        }
+        start = end;
+    }
+    return best;
+}
+
+static void Software_Raster_Canvas_Primitive(NU_Framebuffer* fb, SoftwareTile* tile, SoftwareCommand* cmd, CanvasPrimitiveRenderData* prim)
+{
+    float z = prim->z * 0.015625f;
+    if (z > 1.0f) return;
+    float ax = prim->x0 + cmd->offsetX, ay = prim->y0 + cmd->offsetY;
+    float bx = prim->x1 + cmd->offsetX, by = prim->y1 + cmd->offsetY;
+    bool isRect = prim->kind < 0.5f;
+    float halfThick = prim->thickness * 0.5f;
+
+    // Line frame (direction along the segment, normal across it)
+    float dx = bx - ax, dy = by - ay;
+    float len = sqrtf(dx * dx + dy * dy);
+    float dirX = len > 0.0f ? dx / len : 1.0f;
+    float dirY = len > 0.0f ? dy / len : 0.0f;
+
+    // Pixel bounds (grown by a pixel for the antialiased edge)
+    float margin = isRect ? 1.0f : halfThick + 1.0f;
+    int x0, x1, y0, y1;
+    Software_Pixel_Range(fminf(ax, bx) - margin, fmaxf(ax, bx) + margin, tile->x0, tile->x1, &x0, &x1);
+    Software_Pixel_Range(fminf(ay, by) - margin, fmaxf(ay, by) + margin, tile->y0, tile->y1, &y0, &y1);
+    Software_Clip_Range(cmd->clip.left, cmd->clip.right, &x0, &x1);
+    Software_Clip_Range(cmd->clip.top, cmd->clip.bottom, &y0, &y1);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Rect terms
+    float halfW = (bx - ax) * 0.5f, halfH = (by - ay) * 0.5f;
+    float radius = fminf(prim->radius, fminf(halfW, halfH));
+    float innerHalfW = halfW - prim->thickness, innerHalfH = halfH - prim->thickness;
+    bool hasInner = innerHalfW > 0.0f && innerHalfH > 0.0f;
+    float innerRadius = fmaxf(radius - prim->thickness, 0.0f);
+
+    float fill[4], stroke[4];
+    for (int c=0; c<4; c++) {
+        fill[c] = (float)((prim->fillRGBA >> (c * 8)) & 255u) * 0.003921568627451f;
+        stroke[c] = (float)((prim->strokeRGBA >> (c * 8)) & 255u) * 0.003921568627451f;
+    }
+
+    for (int py = y0; py < y1; py++)
+    {
+        u32* pixelRow = fb->pixels + py * fb->width;
+        float* depthRow = fb->depth + py * fb->width;
+        float sy = (float)py + 0.5f;
+        for (int px = x0; px < x1; px++)
+        {
+            if (z < depthRow[px]) continue;
+            float sx = (float)px + 0.5f;
+            float colour[4];
+            float alpha;
+            if (isRect) {
+                float lx = sx - ax - halfW;
+                float ly = sy - ay - halfH;
+                float outerMask = Software_Smoothstep(0.5f, -0.5f, Software_SD_Round_Rect(lx, ly, halfW, halfH, radius));
+                float innerMask = hasInner ? Software_Smoothstep(0.5f, -0.5f, Software_SD_Round_Rect(lx, ly, innerHalfW, innerHalfH, innerRadius)) : 0.0f;
+                for (int c=0; c<4; c++) colour[c] = stroke[c] + (fill[c] - stroke[c]) * innerMask;
+                alpha = outerMask * colour[3];
+            } else {
+                float u = (sx - ax) * dirX + (sy - ay) * dirY;
+                float v = (sy - ay) * dirX - (sx - ax) * dirY;
+                float d = fmaxf(fabsf(v) - halfThick, fmaxf(-u, u - len));
+                if (prim->dashCount > 0.5f) d = fmaxf(d, Software_SD_Dash(prim, u + prim->dashPhase));
+                for (int c=0; c<4; c++) colour[c] = stroke[c];
+                alpha = Software_Smoothstep(0.5f, -0.5f, d) * colour[3];
+            }
+            if (alpha <= 0.0f) continue;
+            pixelRow[px] = Software_Blend(pixelRow[px], colour[0], colour[1], colour[2], alpha);
+            depthRow[px] = z;
+        }
+    }
+}
+
+static void Software_Execute_Command(NU_Framebuffer* fb, SoftwareTile* tile, SoftwareCommand* cmd)
+{
+    switch (cmd->type)
+    {
+        case SOFTWARE_CMD_BORDER_RECTS: {
+            BorderRectRenderData* rects = cmd->data;
+            for (u32 i=0; i<cmd->count; i++) Software_Raster_Border_Rect(fb, tile, &rects[i]);
+            break;
+        }
+        case SOFTWARE_CMD_MESH: {
+            vertex_rgb* vertices = cmd->data;
+            for (u32 i=0; i+2<cmd->count; i+=3) {
+                Software_Raster_Triangle(fb, tile,
+                    &vertices[cmd->indices[i]], &vertices[cmd->indices[i + 1]], &vertices[cmd->indices[i + 2]],
+                    cmd->offsetX, cmd->offsetY, &cmd->clip);
+            }
+            break;
+        }
+        case SOFTWARE_CMD_TEXT: {
+            // Glyph quads are emitted as (tl, tr, bl, tr, bl, br) -> index 0 is tl and index 5 is br
+            vertex_rgb_uv* vertices = cmd->data;
+            for (u32 i=0; i+5<cmd->count; i+=6) {
+                Software_Raster_Glyph(fb, tile, cmd, &vertices[cmd->indices[i]], &vertices[cmd->indices[i + 5]]);
+            }
+            break;
+        }
+        case SOFTWARE_CMD_IMAGES: {
+            ImageRenderData* images = cmd->data;
+            for (u32 i=0; i<cmd->count; i++) Software_Raster_Image(fb, tile, cmd, &images[i]);
+            break;
+        }
+        case SOFTWARE_CMD_CANVAS_PRIMITIVES: {
+            CanvasPrimitiveRenderData* primitives = cmd->data;
+            for (u32 i=0; i<cmd->count; i++) Software_Raster_Canvas_Primitive(fb, tile, cmd, &primitives[i]);
+            break;
+        }
+    }
+}
+
+void Software_Rasterize(NU_Framebuffer* fb, Array* commands)
+{
+    int tilesX = (fb->width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    int tilesY = (fb->height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    int tileCount = tilesX * tilesY;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t=0; t<tileCount; t++)
+    {
+        SoftwareTile tile;
+        tile.x0 = (t % tilesX) * SOFTWARE_TILE_SIZE;
+        tile.y0 = (t / tilesX) * SOFTWARE_TILE_SIZE;
+        tile.x1 = min(tile.x0 + SOFTWARE_TILE_SIZE, fb->width);
+        tile.y1 = min(tile.y0 + SOFTWARE_TILE_SIZE, fb->height);
+
+        // Clear (opaque black, depth -1 == GL clear depth 0)
+        for (int py = tile.y0; py < tile.y1; py++) {
+            u32* pixelRow = fb->pixels + py * fb->width;
+            float* depthRow = fb->depth + py * fb->width;
+            for (int px = tile.x0; px < tile.x1; px++) {
+                pixelRow[px] = PackRGBA(0, 0, 0, 255);
+                depthRow[px] = -1.0f;
+            }
+        }
+
+        // Replay the frame's commands in submission order
+        for (u32 c=0; c<commands->size; c++) {
+            Software_Execute_Command(fb, &tile, (SoftwareCommand*)Array_Get(commands, c));
+        }
+    }
+}
+
+// -----------------------------
+// --- Command Recording -------
+// -----------------------------
+static const NU_ClipBounds SOFTWARE_NO_CLIP = { -1.0f, 100000.0f, -1.0f, 100000.0f };
+
+void Software_Record_Border_Rects(Array* commands, Array* borderRects)
+{
+    if (borderRects->size == 0) return;
+    SoftwareCommand* cmd = Array_PushEmpty(commands);
+    memset(cmd, 0, sizeof(SoftwareCommand));
+    cmd->type = SOFTWARE_CMD_BORDER_RECTS;
+    cmd->ownsData = true;
+    cmd->count = (u32)borderRects->size;
+    cmd->data = malloc(borderRects->size * sizeof(BorderRectRenderData));
+    memcpy(cmd->data, borderRects->data, borderRects->size * sizeof(BorderRectRenderData));
+    Array_Clear(borderRects);
+}
+
+void Software_Record_Mesh(Array* commands, Vertex_RGB_List* vertices, Index_List* indices, bool takeOwnership, float offsetX, float offsetY, NU_ClipBounds clip)
+{
+    if (indices->size == 0) {
+        if (takeOwnership) { Vertex_RGB_List_Free(vertices); Index_List_Free(indices); }
+        return;
+    }
+    SoftwareCommand* cmd = Array_PushEmpty(commands);
+    memset(cmd, 0, sizeof(SoftwareCommand));
+    cmd->type = SOFTWARE_CMD_MESH;
+    cmd->ownsData = takeOwnership;
+    cmd->data = vertices->array;
+    cmd->indices = indices->array;
+    cmd->count = indices->size;
+    cmd->offsetX = offsetX;
+    cmd->offsetY = offsetY;
+    cmd->clip = clip;
+}
+
+void Software_Record_Text(Array* commands, Vertex_RGB_UV_List* vertices, Index_List* indices, NU_Font* font, bool takeOwnership, float offsetX, float offsetY, NU_ClipBounds clip)
+{
+    if (indices->size == 0) {
+        if (takeOwnership) { Vertex_RGB_UV_List_Free(vertices); Index_List_Free(indices); }
+        return;
+    }
+    SoftwareCommand* cmd = Array_PushEmpty(commands);
+    memset(cmd, 0, sizeof(SoftwareCommand));
+    cmd->type = SOFTWARE_CMD_TEXT;
+    cmd->ownsData = takeOwnership;
+    cmd->data = vertices->array;
+    cmd->indices = indices->array;
+    cmd->count = indices->size;
+    cmd->texture = font->atlas.buffer;
+    cmd->texW = font->atlas.width;
+    cmd->texH = font->atlas.height;
+    cmd->texChannels = font->atlas.channels;
+    cmd->subpixel = font->subpixel_rendering && font->atlas.channels == 3;
+    cmd->offsetX = offsetX;
+    cmd->offsetY = offsetY;
+    cmd->clip = clip;
+}
+
+void Software_Record_Images(Array* commands, ImageResourceManager* imageManager)
+{
+    if (imageManager->renderDatas.size == 0) return;
+    SoftwareCommand* cmd = Array_PushEmpty(commands);
+    memset(cmd, 0, sizeof(SoftwareCommand));
+    cmd->type = SOFTWARE_CMD_IMAGES;
+    cmd->ownsData = false;
+    cmd->data = imageManager->renderDatas.data;
+    cmd->count = (u32)imageManager->renderDatas.size;
+    cmd->texChannels = 4;
+    cmd->imageManager = imageManager;
+}
+
+void Software_Record_Canvas_Primitives(Array* commands, Array* primitives, bool takeOwnership, float offsetX, float offsetY, NU_ClipBounds clip)
+{
+    if (primitives->size == 0) {
+        if (takeOwnership) Array_Free(primitives);
+        return;
+    }
+    SoftwareCommand* cmd = Array_PushEmpty(commands);
+    memset(cmd, 0, sizeof(SoftwareCommand));
+    cmd->type = SOFTWARE_CMD_CANVAS_PRIMITIVES;
+    cmd->ownsData = takeOwnership;
+    cmd->data = primitives->data;
+    cmd->count = (u32)primitives->size;
+    cmd->offsetX = offsetX;
+    cmd->offsetY = offsetY;
+    cmd->clip = clip;
+}
+
+void Software_Free_Commands(Array* commands)
+{
+    for (u32 i=0; i<commands->size; i++) {
+        SoftwareCommand* cmd = Array_Get(commands, i);
+        if (!cmd->ownsData) continue;
+        free(cmd->data);
+        free(cmd->indices);
+    }
+    Array_Free(commands);
+}
+
+// ---------------------------------------
+// --- Node Content -> Commands ----------
+// ---------------------------------------
+static void Software_Record_Node_Image(NodeP* node, float z, NU_ClipBounds* clip)
+{
+    ImageRenderData renderData;
+    renderData.x = node->node.x + node->node.borderLeft + node->node.padLeft;
+    renderData.y = node->node.y + node->node.borderTop + node->node.padTop;
+    renderData.z = z + 0.75f;
+    renderData.w = node->node.width - node->node.borderLeft - node->node.borderRight - node->node.padLeft - node->node.padRight;
+    renderData.h = node->node.height - node->node.borderTop - node->node.borderBottom - node->node.padTop - node->node.padBottom;
+    renderData.scissorTop = clip ? clip->top : 0.0f;
+    renderData.scissorBottom = clip ? clip->bottom : 1000000.0f;
+    renderData.scissorLeft = clip ? clip->left : 0.0f;
+    renderData.scissorRight = clip ? clip->right : 1000000.0f;
+    ImageResourceManager_AddImageRenderData(&GUI.imageResourceManager, node->typeData.image.imageHandle, &renderData);
+}
+
+static void Software_Record_Input_Content(Array* commands, NodeP* node, float z, NU_ClipBounds* clip)
+{
+    NU_Font* node_font = Stylesheet_Get_Font(&GUI.stylesheet, node->fontId);
+    InputText* inputText = Container_Get(&GUI.textInputs, node->typeData.input.textInputHandle);
+    if (inputText->updateOffsetsPostLayout) {
+        inputText->updateOffsetsPostLayout = false;
+        InputText_ComputeCursorTextOffset_PlaceEnd(inputText, node, node_font);
+    }
+    NU_ClipBounds cursorClip = *clip; cursorClip.right += 1;
+    bool focused = GUI.focused_node != NULL && node == GUI.focused_node;
+
+    // Highlight
+    if (focused && InputText_IsHighlighting(inputText)) {
+        Vertex_RGB_List vertices; Vertex_RGB_List_Init(&vertices, 4);
+        Index_List indices; Index_List_Init(&indices, 6);
+        NU_ConstructInputHighlightMesh(node, z + 0.25f, inputText, &vertices, &indices);
+        Software_Record_Mesh(commands, &vertices, &indices, true, 0, 0, cursorClip);
+    }
+
+    // Text
+    Vertex_RGB_UV_List textVertices; Vertex_RGB_UV_List_Init(&textVertices, 1000);
+    Index_List textIndices; Index_List_Init(&textIndices, 600);
+    float textPosX = node->node.x + node->node.borderLeft + node->node.padLeft + inputText->textOffset;
+    float textPosY = node->node.y + node->node.borderTop  + node->node.padTop;
+    float r = (float)node->node.textR * 0.003921568627451f;
+    float g = (float)node->node.textG * 0.003921568627451f;
+    float b = (float)node->node.textB * 0.003921568627451f;
+    NU_Generate_Text_Mesh(&textVertices, &textIndices, node_font, inputText->buffer, floorf(textPosX), floorf(textPosY), z + 0.5f, r, g, b, 10000000.0f);
+    Software_Record_Text(commands, &textVertices, &textIndices, node_font, true, 0, 0, *clip);
+
+    // Cursor
+    if (focused && !InputText_IsHighlighting(inputText)) {
+        Vertex_RGB_List vertices; Vertex_RGB_List_Init(&vertices, 4);
+        Index_List indices; Index_List_Init(&indices, 6);
+        NU_ConstructInputCursorMesh(node, z + 0.5f, inputText, &vertices, &indices);
+        Software_Record_Mesh(commands, &vertices, &indices, true, 0, 0, cursorClip);
+    }
+}
+
+// ---------------------------------------
+// --- Canvas transforms (baked on CPU) --
+// ---------------------------------------
+static void Software_Transform_Vertices(float* xy, size_t stride, u32 vertexCount, Array* ranges, const float* transforms)
+{
+    for (u32 i=0; i<ranges->size+1; i++) {
+        u32 begin = i == 0 ? 0 : ((CanvasDrawRange*)Array_Get(ranges, i - 1))->vertexStart;
+        u32 end = i < ranges->size ? ((CanvasDrawRange*)Array_Get(ranges, i))->vertexStart : vertexCount;
+        int transform = i == 0 ? 0 : ((CanvasDrawRange*)Array_Get(ranges, i - 1))->transform;
+        if (transform == 0) continue;
+        const float* t = transforms + transform * 6;
+        for (u32 v=begin; v<end; v++) {
+            float* p = (float*)((char*)xy + v * stride);
+            float x = p[0], y = p[1];
+            p[0] = t[0] * x + t[2] * y + t[4];
+            p[1] = t[1] * x + t[3] * y + t[5];
+        }
+    }
+}
+
+// Rects are replaced by the bounds of their transformed corners, so rotation
+// and skew are lost for rects in the software path (lines keep them)
+static void Software_Transform_Primitives(Array* primitives, Array* ranges, const float* transforms)
+{
+    u32 begin, end;
+    for (u32 i=0; i<ranges->size+1; i++) {
+        int transform = Canvas_Range_Segment(ranges, i, (u32)primitives->size, &begin, &end);
+        if (transform == 0) continue;
+        const float* t = transforms + transform * 6;
+        float scale = sqrtf(fabsf(t[0] * t[3] - t[1] * t[2]));
+        for (u32 p=begin; p<end; p++) {
+            CanvasPrimitiveRenderData* prim = Array_Get(primitives, p);
+            float x0 = t[0] * prim->x0 + t[2] * prim->y0 + t[4];
+            float y0 = t[1] * prim->x0 + t[3] * prim->y0 + t[5];
+            float x1 = t[0] * prim->x1 + t[2] * prim->y1 + t[4];
+            float y1 = t[1] * prim->x1 + t[3] * prim->y1 + t[5];
+            if (prim->kind == CANVAS_PRIMITIVE_RECT) {
+                float x2 = t[0] * prim->x1 + t[2] * prim->y0 + t[4];
+                float y2 = t[1] * prim->x1 + t[3] * prim->y0 + t[5];
+                float x3 = t[0] * prim->x0 + t[2] * prim->y1 + t[4];
+                float y3 = t[1] * prim->x0 + t[3] * prim->y1 + t[5];
+                prim->x0 = fminf(fminf(x0, x1), fminf(x2, x3));
+                prim->y0 = fminf(fminf(y0, y1), fminf(y2, y3));
+                prim->x1 = fmaxf(fmaxf(x0, x1), fmaxf(x2, x3));
+                prim->y1 = fmaxf(fmaxf(y0, y1), fmaxf(y2, y3));
+                prim->radius *= scale;
+            } else {
+                prim->x0 = x0; prim->y0 = y0;
+                prim->x1 = x1; prim->y1 = y1;
+                prim->dashPhase *= scale;
+                for (int d=0; d<CANVAS_MAX_DASH_PATTERN; d++) prim->dash[d] *= scale;
+            }
+            prim->thickness *= scale;
+        }
+    }
+}
+
+static void Software_Record_Canvas_Transformed(Array* commands, CanvasDrawBuffer* buf, float offsetX, float offsetY, NU_ClipBounds clip)
+{
+    float* transforms = malloc(sizeof(float) * 6 * buf->transforms.size);
+    NU_Canvas_Resolve_Transforms(buf, transforms);
+
+    // Shape mesh
+    CanvasShapeLayer* shapes = &buf->shapeLayer;
+    Vertex_RGB_List vertices; Vertex_RGB_List_Init(&vertices, shapes->vertices.size + 1);
+    Index_List indices; Index_List_Init(&indices, shapes->indices.size + 1);
+    memcpy(vertices.array, shapes->vertices.array, shapes->vertices.size * sizeof(vertex_rgb));
+    memcpy(indices.array, shapes->indices.array, shapes->indices.size * sizeof(GLuint));
+    vertices.size = shapes->vertices.size;
+    indices.size = shapes->indices.size;
+    Software_Transform_Vertices(&vertices.array[0].x, sizeof(vertex_rgb), vertices.size, &shapes->meshRanges, transforms);
+    Software_Record_Mesh(commands, &vertices, &indices, true, offsetX, offsetY, clip);
+
+    // Primitives
+    Array primitives; Array_Init(&primitives, sizeof(CanvasPrimitiveRenderData), shapes->primitives.size + 1);
+    memcpy(primitives.data, shapes->primitives.data, shapes->primitives.size * sizeof(CanvasPrimitiveRenderData));
+    primitives.size = shapes->primitives.size;
+    Software_Transform_Primitives(&primitives, &shapes->primitiveRanges, transforms);
+    Software_Record_Canvas_Primitives(commands, &primitives, true, offsetX, offsetY, clip);
+
+    // Text
+    for (int l=0; l<buf->textLayerCount; l++) {
+        CanvasTextLayer* layer = Array_Get(&buf->textLayers, l);
+        NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, layer->fontID);
+        Vertex_RGB_UV_List textVertices; Vertex_RGB_UV_List_Init(&textVertices, layer->vertices.size + 1);
+        Index_List textIndices; Index_List_Init(&textIndices, layer->indices.size + 1);
+        memcpy(textVertices.array, layer->vertices.array, layer->vertices.size * sizeof(vertex_rgb_uv));
+        memcpy(textIndices.array, layer->indices.array, layer->indices.size * sizeof(GLuint));
+        textVertices.size = layer->vertices.size;
+        textIndices.size = layer->indices.size;
+        Software_Transform_Vertices(&textVertices.array[0].x, sizeof(vertex_rgb_uv), textVertices.size, &layer->ranges, transforms);
+        Software_Record_Text(commands, &textVertices, &textIndices, font, true, offsetX, offsetY, clip);
+    }
+    free(transforms);
+}
+
+static void Software_Record_Canvas_Content(Array* commands, Array* lockedCanvases, NodeP* canvas_node, NU_ClipBounds* clip)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Get(canvas_node->typeData.canvas.ctxHandle);
+    if (ctx == NULL) return;
+
+    // Commands reference the front buffer, so it can't be swapped until rasterized
+    SDL_LockMutex(ctx->swapMutex);
+    Array_Push(lockedCanvases, &ctx);
+    CanvasDrawBuffer* buf = NU_Canvas_Front(ctx);
+
+    float offsetX = roundf(canvas_node->node.x + canvas_node->node.borderLeft + canvas_node->node.padLeft);
+    float offsetY = roundf(canvas_node->node.y + canvas_node->node.borderTop + canvas_node->node.padTop);
+    NU_ClipBounds canvasClip;
+    canvasClip.top    = canvas_node->node.y + canvas_node->node.borderTop + canvas_node->node.padTop;
+    canvasClip.bottom = canvas_node->node.y + canvas_node->node.height - canvas_node->node.borderBottom - canvas_node->node.padBottom;
+    canvasClip.left   = canvas_node->node.x + canvas_node->node.borderLeft + canvas_node->node.padLeft;
+    canvasClip.right  = canvas_node->node.x + canvas_node->node.width - canvas_node->node.borderRight - canvas_node->node.padRight;
+    if (clip) {
+        canvasClip.top    = fmaxf(canvasClip.top, clip->top);
+        canvasClip.bottom = fminf(canvasClip.bottom, clip->bottom);
+        canvasClip.left   = fmaxf(canvasClip.left, clip->left);
+        canvasClip.right  = fminf(canvasClip.right, clip->right);
+    }
+    ctx->canvasWidth = canvas_node->node.width;
+    ctx->canvasHeight = canvas_node->node.height;
+
+    // Transformed canvases are recorded from transformed copies
+    if (buf->transforms.size > 1) {
+        Software_Record_Canvas_Transformed(commands, buf, offsetX, offsetY, canvasClip);
+        return;
+    }
+
+    // Canvas lists are owned by the context and outlive the frame
+    Software_Record_Mesh(commands, &buf->shapeLayer.vertices, &buf->shapeLayer.indices, false, offsetX, offsetY, canvasClip);
+    Software_Record_Canvas_Primitives(commands, &buf->shapeLayer.primitives, false, offsetX, offsetY, canvasClip);
+    for (int l=0; l<buf->textLayerCount; l++) {
+        CanvasTextLayer* layer = Array_Get(&buf->textLayers, l);
+        NU_Font* font = Stylesheet_Get_Font(&GUI.stylesheet, layer->fontID);
+        Software_Record_Text(commands, &layer->vertices, &layer->indices, font, false, offsetX, offsetY, canvasClip);
+    }
+}
+
+// ---------------------------------------------------------------------
+// --- Render a window into a framebuffer (follows NU_Draw step order) ---
+// ---------------------------------------------------------------------
+int NU_Internal_Render_To_Framebuffer(Node* windowNode, NU_Framebuffer* fb)
+{
+    if (windowNode == NULL || fb == NULL) return 0;
+    NodeP* windowNodeP = NODEP_OF(windowNode);
+    NU_Window* win = Container_Get(&GUI.winManager.windows, windowNodeP->windowID);
+    if (win == NULL) return 0;
+
+    // Headless windows take the size of a sized framebuffer
+    if (win->window == NULL && fb->fixedWidth > 0 && (win->width != fb->fixedWidth || win->height != fb->fixedHeight)) {
+        win->width = fb->fixedWidth;
+        win->height = fb->fixedHeight;
+        GUI.awaiting_redraw = true;
+    }
+
+    // Layout waits for the outermost NU_End_Update, the framebuffer keeps the last committed frame
+    if (GUI.updateDepth > 0) return fb->pixels != NULL;
+    if (GUI.awaiting_redraw) NU_Layout();
+    else if (GUI.layoutDirtyRoots.itemCount > 0) NU_Layout_Contained();
+    if (GUI.headless) GUI.awaiting_redraw = false; // Nothing else will draw (NU_Draw clears it otherwise)
+
+    // Render at the window node's laid out size
+    int winW = (int)windowNodeP->node.width;
+    int winH = (int)windowNodeP->node.height;
+    if (winW <= 0 || winH <= 0 || !NU_Framebuffer_Resize(fb, winW, winH)) return 0;
+    NU_GenerateDrawlists(false);
+    NU_WindowDrawlist* drawList = &win->drawlist;
+
+    Array commands; Array_Init(&commands, sizeof(SoftwareCommand), 64);
+    Array rects; Array_Init(&rects, sizeof(BorderRectRenderData), 512);
+    Array lockedCanvases; Array_Init(&lockedCanvases, sizeof(NU_Canvas_Context*), 4);
+    ImageResourceManager_ClearAllImageRenderData(&GUI.imageResourceManager);
+
+    // Text vertex and index buffers (per font). Text commands keep a pointer to the
+    // atlas buffer, so canvas workers can't grow an atlas until rasterization is done
+    u32 fontCount = GUI.stylesheet.fonts.size;
+    for (u32 t=0; t<fontCount; t++) SDL_LockMutex(Stylesheet_Get_Font(&GUI.stylesheet, t)->glyphMutex);
+    Vertex_RGB_UV_List* textVertices = malloc(sizeof(Vertex_RGB_UV_List) * fontCount);
+    Index_List* textIndices = malloc(sizeof(Index_List) * fontCount);
+    for (u32 i=0; i<fontCount; i++) {
+        Vertex_RGB_UV_List_Init(&textVertices[i], 512);
+        Index_List_Init(&textIndices[i], 512);
+    }
+
+    // 1. Unclipped nodes
+    for (u32 n=0; n<drawList->drawNodes.size; n++)
+    {
+        NodeP* node = *(NodeP**)Array_Get(&drawList->drawNodes, n);
+        float z = (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node);
+        Add_NodeRectRenderData(node, z, 0.0f, (float)winH, 0.0f, (float)winW, &rects);
+        if (node->layoutFlags & OVERFLOW_VERTICAL_SCROLL
+            && node->node.contentHeight > (node->node.height - node->node.padTop - node->node.padBottom - node->node.borderTop - node->node.borderBottom)) {
+            Add_ScrollbarRenderData(node, z + 0.5f, &GUI.stylesheet.scrollbarStyle, &rects);
+        }
+        if (node->node.textContent != NULL) {
+            NU_AddTextMesh(node, z, node->node.textContent, &textVertices[node->fontId], &textIndices[node->fontId]);
+        }
+        else if (node->type == NU_INPUT) {
+            NU_ClipBounds clip;
+            clip.top = node->node.y;
+            clip.left = node->node.x + node->node.borderLeft + node->node.padLeft;
+            clip.right = node->node.x + node->node.width - node->node.borderRight - node->node.padRight;
+            clip.bottom = node->node.y + node->node.height + 1000;
+            Software_Record_Input_Content(&commands, node, z, &clip);
+        }
+        if (node->typeData.image.imageHandle != 0 && node->type != NU_CANVAS && node->type != NU_INPUT) {
+            Software_Record_Node_Image(node, z, NULL);
+        }
+        if (node->type == NU_CANVAS) Software_Record_Canvas_Content(&commands, &lockedCanvases, node, NULL);
+    }
+
+    // 2. Unclipped border rects
+    Software_Record_Border_Rects(&commands, &rects);
+
+    // 3. Unclipped text (per font)
+    for (u32 t=0; t<fontCount; t++) {
+        Software_Record_Text(&commands, &textVertices[t], &textIndices[t], Stylesheet_Get_Font(&GUI.stylesheet, t), false, 0, 0, SOFTWARE_NO_CLIP);
+    }
+
+    // 4. Clipped nodes
+    for (u32 n=0; n<drawList->clippedDrawNodes.size; n++)
+    {
+        NodeP* node = *(NodeP**)Array_Get(&drawList->clippedDrawNodes, n);
+        float z = (float)(node->layer) + 32.0f * NodeStatePosAbsolute(node);
+        NU_ClipBounds* clip = (NU_ClipBounds*)Hashmap_Get(&GUI.winManager.clipMap, &node->clippedAncestor);
+        Add_NodeRectRenderData(node, z, clip->top, clip->bottom, clip->left, clip->right, &rects);
+        Software_Record_Border_Rects(&commands, &rects);
+
+        if (node->node.textContent != NULL) {
+            Vertex_RGB_UV_List vertices; Vertex_RGB_UV_List_Init(&vertices, 1000);
+            Index_List indices; Index_List_Init(&indices, 600);
+            NU_AddTextMesh(node, z + 0.5f, node->node.textContent, &vertices, &indices);
+            Software_Record_Text(&commands, &vertices, &indices, Stylesheet_Get_Font(&GUI.stylesheet, node->fontId), true, 0, 0, *clip);
+        }
+        else if (node->type == NU_INPUT) {
+            InputText* inputText = Container_Get(&GUI.textInputs, node->typeData.input.textInputHandle);
+            if (inputText->numBytes > 0) {
+                NU_ClipBounds innerClip = *clip;
+                innerClip.left += node->node.borderLeft + node->node.padLeft;
+                innerClip.right -= node->node.borderRight + node->node.padRight;
+                Software_Record_Input_Content(&commands, node, z, &innerClip);
+            }
+        }
+        if (node->typeData.image.imageHandle != 0 && node->type != NU_CANVAS && node->type != NU_INPUT) {
+            Software_Record_Node_Image(node, z, clip);
+        }
+        if (node->type == NU_CANVAS) Software_Record_Canvas_Content(&commands, &lockedCanvases, node, clip);
+    }
+
+    // 5. Images
+    Software_Record_Images(&commands, &GUI.imageResourceManager);
+
+    // Rasterize tiles in parallel
+    Software_Rasterize(fb, &commands);
+    for (u32 i=0; i<lockedCanvases.size; i++) {
+        NU_Canvas_Context* ctx = *(NU_Canvas_Context**)Array_Get(&lockedCanvases, i);
+        SDL_UnlockMutex(ctx->swapMutex);
+    }
+    Array_Free(&lockedCanvases);
+    for (u32 t=0; t<fontCount; t++) SDL_UnlockMutex(Stylesheet_Get_Font(&GUI.stylesheet, t)->glyphMutex);
+
+    // Free memory
+    Software_Free_Commands(&commands);
+    Array_Free(&rects);
+    for (u32 i=0; i<fontCount; i++) {
+        Vertex_RGB_UV_List_Free(&textVertices[i]);
+        Index_List_Free(&textIndices[i]);
+    }
+    free(textVertices);
+    free(textIndices);
+    return 1;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+// Defined in nu_draw.h
+void NU_Scroll_Cache_Invalidate(NodeP* node);
+
 // ---------------------------------------
 // --- Macros to reduce code verbosity ---
 // ---------------------------------------
@@ -17,6 +20,8 @@ static void NU_Apply_Style_Item_To_Node(NodeP* node, Stylesheet_Item* item)
     STYLE_APPLY_LAYOUT_FLAG(PROPERTY_FLAG_POSITION_ABSOLUTE, POSITION_ABSOLUTE);          // Absolute positioning (or not)
     STYLE_APPLY_LAYOUT_FLAG(PROPERTY_FLAG_HIDDEN, HIDDEN);                                // Hidden or not
     STYLE_APPLY_LAYOUT_FLAG(PROPERTY_FLAG_IGNORE_MOUSE, IGNORE_MOUSE);                    // Ignore mouse or not
+    STYLE_APPLY_LAYOUT_FLAG(PROPERTY_FLAG_LAYER, LAYER_PROMOTED);                         // Composited layer or not
+    STYLE_APPLY_LAYOUT_FLAG(PROPERTY_FLAG_CONTAIN, LAYOUT_CONTAIN);                       // Layout boundary or not
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_GAP)) node->node.gap = item->gap;
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_PREFERRED_WIDTH)) node->node.prefWidth = item->prefWidth;
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_MIN_WIDTH)) node->node.minWidth = item->minWidth;
@@ -61,7 +66,7 @@ static void NU_Apply_Style_Item_To_Node(NodeP* node, Stylesheet_Item* item)
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_PAD_LEFT)) node->node.padLeft = item->padLeft;
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_PAD_RIGHT)) node->node.padRight = item->padRight;
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_IMAGE) && node->type != NU_CANVAS && node->type != NU_INPUT) {
-        node->typeData.image.imageHandle = item->imageHandle;
+        ImageResourceManager_SetNodeImage(&GUI.imageResourceManager, node, item->imageHandle);
     }
     if (STYLE_SHOULD_APPLY_TO_NODE(PROPERTY_FLAG_INPUT_TYPE) && node->type == NU_INPUT) {
         InputText* inputText = Container_Get(&GUI.textInputs, node->typeData.input.textInputHandle);
@@ -72,6 +77,8 @@ static void NU_Apply_Style_Item_To_Node(NodeP* node, Stylesheet_Item* item)
 
 void NU_Apply_Stylesheet_To_Node(NodeP* node, Stylesheet* ss)
 {   
+    NU_Scroll_Cache_Invalidate(node);
+
     // 1. Apply default style
     NU_Apply_Style_Item_To_Node(node, &ss->defaultStyleItem);
 
@@ -110,6 +117,7 @@ void NU_Apply_Stylesheet_To_Node(NodeP* node, Stylesheet* ss)
 void NU_Apply_Pseudo_Style_To_Node(NodeP* node, Stylesheet* ss, enum NU_Pseudo_Class pseudo)
 {   
     if (node == NULL) return;
+    NU_Scroll_Cache_Invalidate(node);
 
     bool appliedBase = false;
 
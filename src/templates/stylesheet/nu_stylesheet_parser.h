@@ -15,6 +15,8 @@ void Stylesheet_Overwrite_Style_Item(Stylesheet_Item* item, Stylesheet_Item* ove
     item->layoutFlags = (item->layoutFlags & ~POSITION_ABSOLUTE)               | ((overwriter->layoutFlags & POSITION_ABSOLUTE)               * !!(overwriter->propertyFlags & PROPERTY_FLAG_POSITION_ABSOLUTE));
     item->layoutFlags = (item->layoutFlags & ~HIDDEN)                          | ((overwriter->layoutFlags & HIDDEN)                          * !!(overwriter->propertyFlags & PROPERTY_FLAG_HIDDEN));
     item->layoutFlags = (item->layoutFlags & ~IGNORE_MOUSE)                    | ((overwriter->layoutFlags & IGNORE_MOUSE)                    * !!(overwriter->propertyFlags & PROPERTY_FLAG_IGNORE_MOUSE));
+    item->layoutFlags = (item->layoutFlags & ~LAYER_PROMOTED)                  | ((overwriter->layoutFlags & LAYER_PROMOTED)                  * !!(overwriter->propertyFlags & PROPERTY_FLAG_LAYER));
+    item->layoutFlags = (item->layoutFlags & ~LAYOUT_CONTAIN)                  | ((overwriter->layoutFlags & LAYOUT_CONTAIN)                  * !!(overwriter->propertyFlags & PROPERTY_FLAG_CONTAIN));
     item->layoutFlags = (item->layoutFlags & ~HIDE_BACKGROUND)                 | ((overwriter->layoutFlags & HIDE_BACKGROUND)                 * !!(overwriter->propertyFlags & PROPERTY_FLAG_HIDE_BACKGROUND));
 
     // Overwrite gap and size fields (branchless)
@@ -159,6 +161,28 @@ static void Stylesheet_Parse_Property(Stylesheet* ss, const enum NU_Style_Token
                 item->propertyFlags |= PROPERTY_FLAG_IGNORE_MOUSE;
             }
             break;
+
+        // Composited layer
+        case STYLE_LAYER_PROPERTY:
+            if (strcmp(text, "true") == 0) {
+                item->layoutFlags |= LAYER_PROMOTED;
+                item->propertyFlags |= PROPERTY_FLAG_LAYER;
+            }
+            else if (strcmp(text, "false") == 0) {
+                item->propertyFlags |= PROPERTY_FLAG_LAYER;
+            }
+            break;
+
+        // Layout containment boundary
+        case STYLE_CONTAIN_PROPERTY:
+            if (strcmp(text, "true") == 0) {
+                item->layoutFlags |= LAYOUT_CONTAIN;
+                item->propertyFlags |= PROPERTY_FLAG_CONTAIN;
+            }
+            else if (strcmp(text, "false") == 0) {
+                item->propertyFlags |= PROPERTY_FLAG_CONTAIN;
+            }
+            break;
         
         // Set gap
         case STYLE_GAP_PROPERTY:
@@ -594,7 +618,8 @@ static int Stylesheet_Parse_Fonts(Stylesheet* ss, char* src, TokenArray* tokens,
         i += 1;
     }
 
-    // Create fonts in parallel
+    // Create fonts in parallel (no @font rules -> only the default font is created)
+    if (fontJobCount == 0) return 1;
     int threadCount = SDL_GetNumLogicalCPUCores();
     if (threadCount <= 0) threadCount = 1;
     if (threadCount > fontJobCount) threadCount = fontJobCount;
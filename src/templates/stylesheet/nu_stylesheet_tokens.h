@@ -16,7 +16,7 @@ static const char* style_keywords[] = {
     "dir", "grow",
     "overflow-v", "overflow-h", 
     "position", "hide", 
-    "ignore-mouse", "gap",
+    "ignore-mouse", "layer", "contain", "gap",
     "width", "min-width", "max-width", 
     "height", "min-height", "max-height",
     "align-h", "align-v", "text-align-h", "text-align-v",
@@ -48,6 +48,8 @@ enum NU_Style_Token
     STYLE_POSITION_PROPERTY,
     STYLE_HIDE_PROPERTY,
     STYLE_IGNORE_MOUSE_PROPERTY,
+    STYLE_LAYER_PROPERTY,
+    STYLE_CONTAIN_PROPERTY,
     STYLE_GAP_PROPERTY,
     STYLE_WIDTH_PROPERTY,
     STYLE_MIN_WIDTH_PROPERTY,
@@ -143,6 +145,8 @@ void PrintStyleTokenLine(enum NU_Style_Token token)
         case STYLE_POSITION_PROPERTY:              name = "STYLE_POSITION_PROPERTY"; break;
         case STYLE_HIDE_PROPERTY:                  name = "STYLE_HIDE_PROPERTY"; break;
         case STYLE_IGNORE_MOUSE_PROPERTY:          name = "STYLE_IGNORE_MOUSE_PROPERTY"; break;
+        case STYLE_LAYER_PROPERTY:                 name = "STYLE_LAYER_PROPERTY"; break;
+        case STYLE_CONTAIN_PROPERTY:               name = "STYLE_CONTAIN_PROPERTY"; break;
         case STYLE_GAP_PROPERTY:                   name = "STYLE_GAP_PROPERTY"; break;
         case STYLE_WIDTH_PROPERTY:                 name = "STYLE_WIDTH_PROPERTY"; break;
         case STYLE_MIN_WIDTH_PROPERTY:             name = "STYLE_MIN_WIDTH_PROPERTY"; break;
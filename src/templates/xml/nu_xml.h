@@ -115,6 +115,22 @@ void NU_Parse_Property(const enum NU_XML_TOKEN token, NodeP* currentNode, char*
                 currentNode->layoutFlags |= IGNORE_MOUSE;
             }
             break;
+
+        // Composited layer
+        case LAYER_PROPERTY:
+            if (strcmp(ptext, "true") == 0) {
+                currentNode->overrideStyleFlags |= PROPERTY_FLAG_LAYER;
+                currentNode->layoutFlags |= LAYER_PROMOTED;
+            }
+            break;
+
+        // Layout containment boundary
+        case CONTAIN_PROPERTY:
+            if (strcmp(ptext, "true") == 0) {
+                currentNode->overrideStyleFlags |= PROPERTY_FLAG_CONTAIN;
+                currentNode->layoutFlags |= LAYOUT_CONTAIN;
+            }
+            break;
         
         // Set gap 
         case GAP_PROPERTY:
@@ -404,18 +420,18 @@ void NU_Parse_Property(const enum NU_XML_TOKEN token, NodeP* currentNode, char*
 
         // Image source
         case IMAGE_SOURCE_PROPERTY:
-            if (currentNode->type == NU_CANVAS && currentNode->type == NU_INPUT) break;
+            if (currentNode->type == NU_CANVAS || currentNode->type == NU_INPUT) break;
 
             int imageHandle = ImageResourceLoader_GetLoadedImageHandle(imageResourceLoader, ptext);
 
             // Image not loaded yet
             if (imageHandle == 0) {
                 imageHandle = ImageResourceLoader_LoadImage(imageResourceLoader, ptext);
-                currentNode->typeData.image.imageHandle = imageHandle;
+                ImageResourceManager_SetNodeImage(imageResourceLoader->resourceManager, currentNode, imageHandle);
                 currentNode->overrideStyleFlags |= PROPERTY_FLAG_IMAGE;
             }
             else { 
-                currentNode->typeData.image.imageHandle = imageHandle;
+                ImageResourceManager_SetNodeImage(imageResourceLoader->resourceManager, currentNode, imageHandle);
                 currentNode->overrideStyleFlags |= PROPERTY_FLAG_IMAGE;
             }
             break;
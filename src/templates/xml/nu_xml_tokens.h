@@ -8,7 +8,7 @@
 
 const char* nu_xml_keywords[] = {
     "id", "class",
-    "dir", "grow", "overflow-v", "overflow-h", "position", "hide", "ignore-mouse", "gap",
+    "dir", "grow", "overflow-v", "overflow-h", "position", "hide", "ignore-mouse", "layer", "contain", "gap",
     "width", "min-width", "max-width", "height", "min-height", "max-height",
     "align-h", "align-v", "text-align-h", "text-align-v",
     "left", "right", "top", "bottom",
@@ -38,6 +38,8 @@ typedef enum NU_XML_TOKEN
     POSITION_PROPERTY,
     HIDE_PROPERTY,
     IGNORE_MOUSE_PROPERTY,
+    LAYER_PROPERTY,
+    CONTAIN_PROPERTY,
     GAP_PROPERTY,
     WIDTH_PROPERTY, MIN_WIDTH_PROPERTY, MAX_WIDTH_PROPERTY,
     HEIGHT_PROPERTY, MIN_HEIGHT_PROPERTY, MAX_HEIGHT_PROPERTY,
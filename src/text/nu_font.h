@@ -33,7 +33,8 @@ typedef struct NU_Font
 {
     FT_Face face;
     Array Ascii_Glyphs;
-    Hashmap UTF8_Glyphs;
+    Hashmap UTF8_Glyphs;      // codepoint -> NU_Glyph* (heap allocated so pointers stay valid)
+    SDL_Mutex* glyphMutex;    // guards UTF8_Glyphs and the atlas buffer (canvas text may be recorded off the UI thread)
     int height_pixels;
     int fontWeight;
     float y_max;
@@ -169,7 +170,8 @@ int NU_Create_Font_From_Face(NU_Font* font, FT_Face face, int height_pixels, boo
 
     // Init font storage
     Array_Init(&font->Ascii_Glyphs, sizeof(NU_Glyph), 128);
-    Hashmap_Init(&font->UTF8_Glyphs, sizeof(u32), sizeof(NU_Glyph), 256);
+    Hashmap_Init(&font->UTF8_Glyphs, sizeof(u32), sizeof(NU_Glyph*), 256);
+    font->glyphMutex = SDL_CreateMutex();
     NU_Font_Atlas_Create(&font->atlas, 512, 512, channels);
 
     // Render and save each ASCII glyph 32..126
@@ -196,8 +198,7 @@ int NU_Create_Font_From_Face(NU_Font* font, FT_Face face, int height_pixels, boo
         NU_Font_Atlas_Add_Glyph(&font->atlas, stored_glyph, bmp);
     }
 
-    NU_Font_Atlas_Upload_Or_Modify_GPU(&font->atlas);
-
+    // The atlas is uploaded by NU_Draw before its first use (never when headless)
     font->face = face;
     return 1; // Success
 }
@@ -214,18 +215,17 @@ NU_Glyph* NU_Add_Uncached_Glyph(NU_Font* font, u32 codepoint)
     if (font->subpixel_rendering) channels = 3;
 
     // Store glyph metrics
-    NU_Glyph glyph;
-    glyph.index    = glyph_index;
-    glyph.width    = (u16)bmp->width / channels;
-    glyph.height   = (u16)bmp->rows;
-    glyph.bearingX = font->face->glyph->bitmap_left;
-    glyph.bearingY = font->face->glyph->bitmap_top;
-    glyph.advance  = (float)(font->face->glyph->advance.x >> 6);
-    Hashmap_Set(&font->UTF8_Glyphs, &codepoint, &glyph);
-    NU_Glyph* stored_glyph = Hashmap_Get(&font->UTF8_Glyphs, &codepoint);
+    NU_Glyph* stored_glyph = malloc(sizeof(NU_Glyph));
+    stored_glyph->index    = glyph_index;
+    stored_glyph->width    = (u16)bmp->width / channels;
+    stored_glyph->height   = (u16)bmp->rows;
+    stored_glyph->bearingX = font->face->glyph->bitmap_left;
+    stored_glyph->bearingY = font->face->glyph->bitmap_top;
+    stored_glyph->advance  = (float)(font->face->glyph->advance.x >> 6);
 
     // Store bitmap in font atlas
     NU_Font_Atlas_Add_Glyph(&font->atlas, stored_glyph, bmp);
+    Hashmap_Set(&font->UTF8_Glyphs, &codepoint, &stored_glyph);
     return stored_glyph;
 }
 
@@ -255,7 +255,11 @@ void NU_Font_Free(NU_Font* font)
 {
     FT_Done_Face(font->face);
     Array_Free(&font->Ascii_Glyphs);
+    HashmapIterator it = Hashmap_CreateIterator(&font->UTF8_Glyphs);
+    void* key; void* val;
+    while (Hashmap_IteratorNext(&it, &key, &val)) free(*(NU_Glyph**)val);
     Hashmap_Free(&font->UTF8_Glyphs);
+    SDL_DestroyMutex(font->glyphMutex);
     free(font->atlas.buffer);
 }
 
@@ -271,11 +275,13 @@ NU_Glyph* NU_Get_Glyph(NU_Font* font, u32 codepoint)
     }
 
     // Slower non-ascii lookup
-    NU_Glyph* glyph = (NU_Glyph*)Hashmap_Get(&font->UTF8_Glyphs, &codepoint);
-    if (glyph) return glyph;
+    SDL_LockMutex(font->glyphMutex);
+    NU_Glyph** found = (NU_Glyph**)Hashmap_Get(&font->UTF8_Glyphs, &codepoint);
 
     // Really slow non-ascii non-cached glyph
-    return NU_Add_Uncached_Glyph(font, codepoint);
+    NU_Glyph* glyph = found ? *found : NU_Add_Uncached_Glyph(font, codepoint);
+    SDL_UnlockMutex(font->glyphMutex);
+    return glyph;
 }
 
 inline float NU_Get_Kerning(NU_Font* font, FT_UInt leftIndex, FT_UInt rightIndex)
@@ -11,11 +11,16 @@
 #define POSITION_ABSOLUTE               (1ULL << 6)
 #define HIDDEN                          (1ULL << 7)
 #define IGNORE_MOUSE                    (1ULL << 8)
+#define LAYER_PROMOTED                  (1ULL << 9)
+#define VIRTUAL_ROWS                    (1ULL << 10) // rows are a recycled pool (see nu_virtual_rows.h)
+#define LAYOUT_CONTAIN                  (1ULL << 11) // size ignores content, inner changes relayout only this subtree
 
 // State flags
-#define STATE_FLAG_HIDDEN       (1 << 0)
-#define STATE_FLAG_POS_ABSOLUTE (1 << 1)
-#define STATE_FLAG_DELETED      (1 << 2)
+#define STATE_FLAG_HIDDEN        (1 << 0)
+#define STATE_FLAG_POS_ABSOLUTE  (1 << 1)
+#define STATE_FLAG_DELETED       (1 << 2)
+#define STATE_FLAG_CACHED        (1 << 3) // drawn from an ancestor's scroll tiles or layer
+#define STATE_FLAG_STYLE_PENDING (1 << 4) // restyle deferred until NU_End_Update (kept by the layout prepass)
 
 // Property flags
 #define PROPERTY_FLAG_LAYOUT_VERTICAL   (1ULL << 0)
@@ -58,6 +63,8 @@
 #define PROPERTY_FLAG_PAD_RIGHT         (1ULL << 37)
 #define PROPERTY_FLAG_IMAGE             (1ULL << 38)
 #define PROPERTY_FLAG_INPUT_TYPE        (1ULL << 39)
+#define PROPERTY_FLAG_LAYER             (1ULL << 40)
+#define PROPERTY_FLAG_CONTAIN           (1ULL << 41)
 
 
 #define NODEP_OF(ptr) ((NodeP *)((char *)(ptr) - offsetof(NodeP, node)))
@@ -120,10 +127,12 @@ typedef struct NodeP
     char* id;
     u64 overrideStyleFlags;
     float scrollX, scrollV;
+    u32 preOrder, postOrder; // depth first interval, numbered by the node index on demand
     u16 childCount;
     u16 eventFlags;
     u16 layoutFlags;
     u8 layer;
+    u8 allocLayer; // layer allocator the node record lives in
     u8 stateFlags;
     u8 fontId;
     u8 windowID;
@@ -4,7 +4,7 @@
 typedef union NallocChunk NallocChunk;
 union NallocChunk {
     NallocChunk* next;
-    char buffer[184];
+    char buffer[192];
 };
 
 typedef struct ArrayStart ArrayStart;
@@ -12,6 +12,7 @@ typedef struct ArrayStart
 { 
     NallocChunk* array;
     ArrayStart* next;
+    u32 count; // chunks in array
 } ArrayStart;
 
 typedef struct Nalloc
@@ -19,6 +20,8 @@ typedef struct Nalloc
     NallocChunk* freeChunk;
     ArrayStart* arrayStart;
     u32 chunksPerArray;
+    u32 freeCount;         // chunks on the free list
+    u32 freedSinceRelease; // frees since Nalloc_Release_Empty_Blocks last ran
 } Nalloc;
 
 int Nalloc_Init(Nalloc* pool, u32 itemsPerBlock)
@@ -41,8 +44,11 @@ int Nalloc_Init(Nalloc* pool, u32 itemsPerBlock)
     pool->freeChunk       = array;
     pool->arrayStart      = node;
     pool->chunksPerArray  = itemsPerBlock;
+    pool->freeCount       = itemsPerBlock;
+    pool->freedSinceRelease = 0;
     node->array = array;
     node->next  = NULL;
+    node->count = itemsPerBlock;
     return 1;
 }
 
@@ -68,7 +74,9 @@ int Nalloc_Expand(Nalloc* pool, u32 extraChunks)
 
     arrayStart->array = extraArray;
     arrayStart->next = pool->arrayStart;
+    arrayStart->count = extraChunks;
     pool->arrayStart = arrayStart;
+    pool->freeCount += extraChunks;
     return 1;
 }
 
@@ -81,6 +89,7 @@ void* Nalloc_Alloc(Nalloc* pool) {
 
     NallocChunk* result = pool->freeChunk;
     pool->freeChunk = pool->freeChunk->next;
+    pool->freeCount--;
     return result;
 }
 
@@ -89,6 +98,89 @@ void Nalloc_Free(Nalloc* pool, void* ptr) {
     NallocChunk* freed = (NallocChunk*)ptr;
     freed->next = pool->freeChunk;
     pool->freeChunk = freed;
+    pool->freeCount++;
+    pool->freedSinceRelease++;
+}
+
+static int Nalloc_Compare_Blocks(const void* a, const void* b)
+{
+    const NallocChunk* pa = (*(ArrayStart* const*)a)->array;
+    const NallocChunk* pb = (*(ArrayStart* const*)b)->array;
+    return (pa > pb) - (pa < pb);
+}
+
+// Index of the block (sorted by address) that holds chunk
+static u32 Nalloc_Find_Block(ArrayStart** blocks, u32 blockCount, NallocChunk* chunk)
+{
+    u32 lo = 0, hi = blockCount;
+    while (hi - lo > 1) {
+        u32 mid = (lo + hi) / 2;
+        if (blocks[mid]->array <= chunk) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Returns arrays whose chunks are all free to the system. Costs O(free chunks * log arrays),
+// so call it after many frees (see freedSinceRelease). Returns the number of arrays released
+u32 Nalloc_Release_Empty_Blocks(Nalloc* pool)
+{
+    if (pool == NULL) return 0;
+    pool->freedSinceRelease = 0;
+    if (pool->freeCount == 0) return 0;
+
+    u32 blockCount = 0;
+    for (ArrayStart* block = pool->arrayStart; block != NULL; block = block->next) blockCount++;
+    ArrayStart** blocks = malloc(sizeof(ArrayStart*) * blockCount);
+    u32* freeInBlock = calloc(blockCount, sizeof(u32));
+    u32 i = 0;
+    for (ArrayStart* block = pool->arrayStart; block != NULL; block = block->next) blocks[i++] = block;
+    qsort(blocks, blockCount, sizeof(ArrayStart*), Nalloc_Compare_Blocks);
+
+    // Count free chunks per block
+    for (NallocChunk* chunk = pool->freeChunk; chunk != NULL; chunk = chunk->next) {
+        freeInBlock[Nalloc_Find_Block(blocks, blockCount, chunk)]++;
+    }
+    u32 released = 0;
+    for (i=0; i<blockCount; i++) {
+        if (freeInBlock[i] == blocks[i]->count) released++;
+    }
+
+    if (released > 0) {
+        // Drop chunks of empty blocks from the free list
+        NallocChunk** link = &pool->freeChunk;
+        NallocChunk* chunk = pool->freeChunk;
+        while (chunk != NULL) {
+            NallocChunk* next = chunk->next;
+            u32 b = Nalloc_Find_Block(blocks, blockCount, chunk);
+            if (freeInBlock[b] != blocks[b]->count) {
+                *link = chunk;
+                link = &chunk->next;
+            }
+            chunk = next;
+        }
+        *link = NULL;
+
+        // Free the empty blocks (marked by a zero count)
+        for (i=0; i<blockCount; i++) {
+            if (freeInBlock[i] != blocks[i]->count) continue;
+            pool->freeCount -= blocks[i]->count;
+            blocks[i]->count = 0;
+        }
+        ArrayStart** blockLink = &pool->arrayStart;
+        while (*blockLink != NULL) {
+            ArrayStart* block = *blockLink;
+            if (block->count == 0) {
+                *blockLink = block->next;
+                free(block->array);
+                free(block);
+            }
+            else blockLink = &block->next;
+        }
+    }
+    free(blocks);
+    free(freeInBlock);
+    return released;
 }
 
 void Nalloc_Destroy(Nalloc* pool) {
@@ -0,0 +1,102 @@
+#pragma once
+
+// Generational node handles. A handle names a slot, the slot's generation is bumped when its
+// node is deleted, so stale handles resolve to NULL instead of a reused or moved node record.
+// Slots are only created for nodes that a handle was asked for
+typedef struct NU_Handle
+{
+    u32 index;
+    u32 generation; // 0 is never issued (zeroed handles are invalid)
+} NU_Handle;
+
+typedef struct NodeSlot
+{
+    NodeP* node;     // NULL when the slot is free
+    u32 generation;
+    u32 nextFree;
+} NodeSlot;
+
+typedef struct NodeHandles
+{
+    Array slots;       // NodeSlot
+    Hashmap nodeSlots; // NodeP* -> u32 slot index
+    u32 freeHead;      // UINT32_MAX when no slot is free
+} NodeHandles;
+
+void NodeHandles_Init(NodeHandles* handles)
+{
+    Array_Init(&handles->slots, sizeof(NodeSlot), 16);
+    Hashmap_Init(&handles->nodeSlots, sizeof(NodeP*), sizeof(u32), 16);
+    handles->freeHead = UINT32_MAX;
+}
+
+void NodeHandles_Free(NodeHandles* handles)
+{
+    Array_Free(&handles->slots);
+    Hashmap_Free(&handles->nodeSlots);
+}
+
+// Returns the node's handle, giving it a slot on first use
+NU_Handle NodeHandles_Get(NodeHandles* handles, NodeP* node)
+{
+    u32* found = Hashmap_Get(&handles->nodeSlots, &node);
+    if (found != NULL) {
+        NodeSlot* slot = Array_Get(&handles->slots, *found);
+        return (NU_Handle){ *found, slot->generation };
+    }
+
+    u32 index;
+    NodeSlot* slot;
+    if (handles->freeHead != UINT32_MAX) {
+        index = handles->freeHead;
+        slot = Array_Get(&handles->slots, index);
+        handles->freeHead = slot->nextFree;
+    }
+    else {
+        NodeSlot empty = { NULL, 1, UINT32_MAX };
+        index = handles->slots.size;
+        Array_Push(&handles->slots, &empty);
+        slot = Array_Get(&handles->slots, index);
+    }
+    slot->node = node;
+    Hashmap_Set(&handles->nodeSlots, &node, &index);
+    return (NU_Handle){ index, slot->generation };
+}
+
+NodeP* NodeHandles_Resolve(NodeHandles* handles, NU_Handle handle)
+{
+    if (handle.index >= handles->slots.size) return NULL;
+    NodeSlot* slot = Array_Get(&handles->slots, handle.index);
+    if (slot->node == NULL || slot->generation != handle.generation) return NULL;
+    return slot->node;
+}
+
+// Call when a node is deleted. Outstanding handles to it go stale
+void NodeHandles_Release(NodeHandles* handles, NodeP* node)
+{
+    if (handles->nodeSlots.itemCount == 0) return;
+    u32* found = Hashmap_Get(&handles->nodeSlots, &node);
+    if (found == NULL) return;
+    u32 index = *found;
+    Hashmap_Delete(&handles->nodeSlots, &node);
+
+    NodeSlot* slot = Array_Get(&handles->slots, index);
+    slot->node = NULL;
+    slot->generation++;
+    if (slot->generation == 0) slot->generation = 1;
+    slot->nextFree = handles->freeHead;
+    handles->freeHead = index;
+}
+
+// Points slots at relocated node records (see TreeCompact)
+void NodeHandles_Remap(NodeHandles* handles, Hashmap* remap)
+{
+    if (handles->nodeSlots.itemCount == 0) return;
+    Hashmap_Clear(&handles->nodeSlots);
+    for (u32 i=0; i<handles->slots.size; i++) {
+        NodeSlot* slot = Array_Get(&handles->slots, i);
+        if (slot->node == NULL) continue;
+        slot->node = TreeRemapNode(remap, slot->node);
+        Hashmap_Set(&handles->nodeSlots, &slot->node, &i);
+    }
+}
@@ -0,0 +1,498 @@
+#pragma once
+
+// Live query results, kept current by the index's mutation hooks (see NodeIndex_Watch_Class).
+// nodes is in no particular order and may move whenever generation changes
+typedef struct NU_Query
+{
+    Node** nodes;
+    u32 count;
+    u32 generation; // bumped on every change to the matches
+} NU_Query;
+
+typedef struct NodeQuery
+{
+    NU_Query query;    // handed to the application, must stay the first member
+    u32 capacity;
+    u32 watchers;      // watch calls not yet matched by NodeIndex_Unwatch
+    Hashmap positions; // NodeP* -> u32 index into query.nodes
+    char* class;       // interned class, NULL for a type query
+    NodeType type;
+} NodeQuery;
+
+// Inverted indexes for node queries (interned class -> nodes, type -> nodes).
+// Descendant queries filter an index by the pre/post order interval of the ancestor
+typedef struct NodeIndex
+{
+    Hashmap classNodes;    // interned char* -> Set* of NodeP*
+    Set typeNodes[NU_NAT]; // Set of NodeP* per NodeType
+    bool intervalsValid;   // pre/post order numbers match the tree, kept up to date once numbered
+    Hashmap classQueries;  // interned char* -> NodeQuery*
+    NodeQuery* typeQueries[NU_NAT]; // NULL unless watched
+    u32 queryCount;
+} NodeIndex;
+
+static void NodeQuery_Insert(NodeQuery* q, NodeP* node)
+{
+    if (Hashmap_Get(&q->positions, &node) != NULL) return;
+    if (q->query.count == q->capacity) {
+        q->capacity *= 2;
+        q->query.nodes = realloc(q->query.nodes, sizeof(Node*) * q->capacity);
+    }
+    u32 position = q->query.count++;
+    q->query.nodes[position] = &node->node;
+    Hashmap_Set(&q->positions, &node, &position);
+    q->query.generation++;
+}
+
+// Backfills the node's slot with the last match
+static void NodeQuery_Erase(NodeQuery* q, NodeP* node)
+{
+    u32* found = Hashmap_Get(&q->positions, &node);
+    if (found == NULL) return;
+    u32 position = *found;
+    Hashmap_Delete(&q->positions, &node);
+
+    u32 last = --q->query.count;
+    if (position != last) {
+        NodeP* moved = NODEP_OF(q->query.nodes[last]);
+        q->query.nodes[position] = &moved->node;
+        Hashmap_Set(&q->positions, &moved, &position);
+    }
+    q->query.generation++;
+}
+
+static void NodeQuery_Clear(NodeQuery* q)
+{
+    q->query.count = 0;
+    Hashmap_Clear(&q->positions);
+    q->query.generation++;
+}
+
+static void NodeQuery_Free(NodeQuery* q)
+{
+    Hashmap_Free(&q->positions);
+    free(q->query.nodes);
+    free(q);
+}
+
+void NodeIndex_Init(NodeIndex* index)
+{
+    Hashmap_Init(&index->classNodes, sizeof(char*), sizeof(Set*), 16);
+    for (int t=0; t<NU_NAT; t++) {
+        Set_Init(&index->typeNodes[t], sizeof(NodeP*), 16);
+        index->typeQueries[t] = NULL;
+    }
+    Hashmap_Init(&index->classQueries, sizeof(char*), sizeof(NodeQuery*), 8);
+    index->queryCount = 0;
+    index->intervalsValid = false;
+}
+
+static void NodeIndex_Free_Class_Sets(NodeIndex* index)
+{
+    HashmapIterator it = Hashmap_CreateIterator(&index->classNodes);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        Set* nodes = *(Set**)value;
+        Set_Free(nodes);
+        free(nodes);
+    }
+}
+
+void NodeIndex_Free(NodeIndex* index)
+{
+    NodeIndex_Free_Class_Sets(index);
+    Hashmap_Free(&index->classNodes);
+    for (int t=0; t<NU_NAT; t++) {
+        Set_Free(&index->typeNodes[t]);
+        if (index->typeQueries[t] != NULL) NodeQuery_Free(index->typeQueries[t]);
+    }
+    HashmapIterator it = Hashmap_CreateIterator(&index->classQueries);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        NodeQuery_Free(*(NodeQuery**)value);
+    }
+    Hashmap_Free(&index->classQueries);
+}
+
+static void NodeIndex_Add_Class(NodeIndex* index, NodeP* node)
+{
+    if (node->class == NULL) return;
+    Set* nodes;
+    Set** found = Hashmap_Get(&index->classNodes, &node->class);
+    if (found == NULL) {
+        nodes = malloc(sizeof(Set));
+        Set_Init(nodes, sizeof(NodeP*), 16);
+        Hashmap_Set(&index->classNodes, &node->class, &nodes);
+    }
+    else nodes = *found;
+    Set_Insert(nodes, &node);
+
+    if (index->classQueries.itemCount > 0) {
+        NodeQuery** query = Hashmap_Get(&index->classQueries, &node->class);
+        if (query != NULL) NodeQuery_Insert(*query, node);
+    }
+}
+
+static void NodeIndex_Remove_Class(NodeIndex* index, NodeP* node)
+{
+    if (node->class == NULL) return;
+    Set** found = Hashmap_Get(&index->classNodes, &node->class);
+    if (found != NULL) Set_Delete(*found, &node);
+
+    if (index->classQueries.itemCount > 0) {
+        NodeQuery** query = Hashmap_Get(&index->classQueries, &node->class);
+        if (query != NULL) NodeQuery_Erase(*query, node);
+    }
+}
+
+// ---------------------------
+// --- Interval numbering ----
+// ---------------------------
+// Every node owns two labels, preOrder when its subtree opens and postOrder when it closes.
+// Labels increase along the depth first tour and are spread over the u32 range, so a node
+// inserted or moved into the tree takes labels from the gap around it. When the gap is used up
+// only the smallest aligned label range that is sparse enough is spread out again
+// (order maintenance, amortized O(log n) labels rewritten per insert)
+
+#define NODE_INDEX_DENSITY_GROWTH 1.6 // items a label range of size 2^i may hold: 1.6^i
+
+typedef struct NodeIndexItem
+{
+    NodeP* node;
+    bool post; // postOrder label, else preOrder
+} NodeIndexItem;
+
+static inline u32 NodeIndexItem_Label(NodeIndexItem item)
+{
+    return item.post ? item.node->postOrder : item.node->preOrder;
+}
+
+static inline void NodeIndexItem_Set_Label(NodeIndexItem item, u32 label)
+{
+    if (item.post) item.node->postOrder = label;
+    else item.node->preOrder = label;
+}
+
+// Next item of the depth first tour (node NULL past the end)
+static inline NodeIndexItem NodeIndexItem_Next(NodeIndexItem item)
+{
+    NodeP* node = item.node;
+    if (!item.post) {
+        if (node->firstChild != NULL) return (NodeIndexItem){ node->firstChild, false };
+        return (NodeIndexItem){ node, true };
+    }
+    if (node->nextSibling != NULL) return (NodeIndexItem){ node->nextSibling, false };
+    return (NodeIndexItem){ node->parent, true };
+}
+
+// Previous item of the depth first tour (node NULL before the start)
+static inline NodeIndexItem NodeIndexItem_Prev(NodeIndexItem item)
+{
+    NodeP* node = item.node;
+    if (item.post) {
+        if (node->lastChild != NULL) return (NodeIndexItem){ node->lastChild, true };
+        return (NodeIndexItem){ node, false };
+    }
+    if (node->prevSibling != NULL) return (NodeIndexItem){ node->prevSibling, true };
+    return (NodeIndexItem){ node->parent, false };
+}
+
+// Numbers every node in depth first order, evenly spread over the label range.
+// A node descends from (or is) an ancestor if
+// ancestor->preOrder <= node->preOrder && node->postOrder <= ancestor->postOrder
+static void NodeIndex_Number_Tree(NodeIndex* index, Tree* tree)
+{
+    u64 step = max(((u64)UINT32_MAX + 1) / ((u64)tree->nodeCount * 2), 1);
+    u64 label = 0;
+    DepthFirstSearch dfs = DepthFirstSearch_Create(tree->root);
+    tree->root->preOrder = (u32)label; label += step;
+    while (dfs.size > 0) {
+        DFSFrame* top = &dfs.stack[dfs.size - 1];
+
+        // Open the next child
+        if (top->nextChild != NULL) {
+            NodeP* child = top->nextChild;
+            top->nextChild = child->nextSibling;
+            if (dfs.size == dfs.capacity) {
+                dfs.capacity *= 2;
+                dfs.stack = realloc(dfs.stack, sizeof(DFSFrame) * dfs.capacity);
+            }
+            child->preOrder = (u32)label; label += step;
+            dfs.stack[dfs.size++] = (DFSFrame){ .node = child, .nextChild = child->firstChild, .visited = 1 };
+            continue;
+        }
+
+        // All children numbered -> close the node
+        top->node->postOrder = (u32)label; label += step;
+        dfs.size--;
+    }
+    DepthFirstSearch_Free(&dfs);
+    index->intervalsValid = true;
+}
+
+// Labels count tour items starting at first evenly over [lo, lo + size)
+static void NodeIndex_Spread(NodeIndexItem first, u32 count, u64 lo, u64 size)
+{
+    NodeIndexItem item = first;
+    for (u32 i=0; i<count; i++) {
+        NodeIndexItem_Set_Label(item, (u32)(lo + size * i / count));
+        item = NodeIndexItem_Next(item);
+    }
+}
+
+// The count tour items after anchor carry anchor's label as a placeholder (they were just
+// inserted or moved there). Gives them real labels, relabelling neighbours if there's no room
+static void NodeIndex_Label_Run(NodeIndex* index, NodeIndexItem anchor, u32 count)
+{
+    if (count == 0) return;
+    u32 label = NodeIndexItem_Label(anchor);
+    NodeIndexItem last = anchor;
+    for (u32 i=0; i<count; i++) last = NodeIndexItem_Next(last);
+
+    // Room between the anchor and the item after the run
+    NodeIndexItem after = NodeIndexItem_Next(last);
+    u64 gap = (after.node != NULL ? (u64)NodeIndexItem_Label(after) : (u64)UINT32_MAX + 1) - label;
+    if (gap > count) {
+        NodeIndex_Spread(NodeIndexItem_Next(anchor), count, (u64)label + gap / (count + 1), gap - gap / (count + 1));
+        return;
+    }
+
+    // Grow an aligned label range around the anchor until it is sparse enough to respread
+    NodeIndexItem first = anchor;
+    u32 items = count + 1;
+    double capacity = 1.0;
+    for (u32 bits=1; bits<=32; bits++) {
+        capacity *= NODE_INDEX_DENSITY_GROWTH;
+        u64 size = (u64)1 << bits;
+        u64 lo = (u64)label & ~(size - 1);
+        u64 hi = lo + size - 1;
+        for (NodeIndexItem prev = NodeIndexItem_Prev(first); prev.node != NULL && NodeIndexItem_Label(prev) >= lo; prev = NodeIndexItem_Prev(first)) {
+            first = prev;
+            items++;
+        }
+        for (NodeIndexItem next = NodeIndexItem_Next(last); next.node != NULL && NodeIndexItem_Label(next) <= hi; next = NodeIndexItem_Next(last)) {
+            last = next;
+            items++;
+        }
+        if ((double)items <= capacity && items <= size) {
+            NodeIndex_Spread(first, items, lo, size);
+            return;
+        }
+    }
+    index->intervalsValid = false; // too many nodes to keep gaps, number the tree again when queried
+}
+
+// Labels a subtree that was just created, moved or reordered into place. Free until the
+// tree is first numbered for a descendant query
+void NodeIndex_Place(NodeIndex* index, NodeP* node)
+{
+    if (!index->intervalsValid || node->parent == NULL) return;
+    NodeIndexItem anchor = NodeIndexItem_Prev((NodeIndexItem){ node, false });
+    u32 label = NodeIndexItem_Label(anchor);
+    u32 count = 0;
+    DepthFirstSearch dfs = DepthFirstSearch_Create(node);
+    NodeP* descendant;
+    while (DepthFirstSearch_Next(&dfs, &descendant)) {
+        descendant->preOrder = label;
+        descendant->postOrder = label;
+        count += 2;
+    }
+    DepthFirstSearch_Free(&dfs);
+    NodeIndex_Label_Run(index, anchor, count);
+}
+
+// Labels all descendants of a parent whose children were reordered
+void NodeIndex_Place_Children(NodeIndex* index, NodeP* parent)
+{
+    if (!index->intervalsValid || parent->firstChild == NULL) return;
+    u32 count = 0;
+    DepthFirstSearch dfs = DepthFirstSearch_Create(parent);
+    NodeP* descendant;
+    while (DepthFirstSearch_Next(&dfs, &descendant)) {
+        if (descendant == parent) continue;
+        descendant->preOrder = parent->preOrder;
+        descendant->postOrder = parent->preOrder;
+        count += 2;
+    }
+    DepthFirstSearch_Free(&dfs);
+    NodeIndex_Label_Run(index, (NodeIndexItem){ parent, false }, count);
+}
+
+static void NodeIndex_Insert(NodeIndex* index, NodeP* node)
+{
+    Set_Insert(&index->typeNodes[node->type], &node);
+    if (index->typeQueries[node->type] != NULL) NodeQuery_Insert(index->typeQueries[node->type], node);
+    NodeIndex_Add_Class(index, node);
+}
+
+// Call after a node is created or copied into the tree
+void NodeIndex_Add(NodeIndex* index, NodeP* node)
+{
+    NodeIndex_Insert(index, node);
+    NodeIndex_Place(index, node);
+}
+
+// Call when a node is deleted from the tree. Removing nodes keeps the numbering valid
+void NodeIndex_Remove(NodeIndex* index, NodeP* node)
+{
+    Set_Delete(&index->typeNodes[node->type], &node);
+    if (index->typeQueries[node->type] != NULL) NodeQuery_Erase(index->typeQueries[node->type], node);
+    NodeIndex_Remove_Class(index, node);
+}
+
+// Call when a subtree is detached for deletion. Its nodes stay indexed until the sweep
+// removes them, but live queries must drop them now. Free when nothing is watched
+void NodeIndex_Detach(NodeIndex* index, NodeP* root)
+{
+    if (index->queryCount == 0) return;
+    DepthFirstSearch dfs = DepthFirstSearch_Create(root);
+    NodeP* node;
+    while (DepthFirstSearch_Next(&dfs, &node)) {
+        if (index->typeQueries[node->type] != NULL) NodeQuery_Erase(index->typeQueries[node->type], node);
+        if (node->class != NULL && index->classQueries.itemCount > 0) {
+            NodeQuery** query = Hashmap_Get(&index->classQueries, &node->class);
+            if (query != NULL) NodeQuery_Erase(*query, node);
+        }
+    }
+    DepthFirstSearch_Free(&dfs);
+}
+
+// Call instead of assigning node->class directly
+void NodeIndex_Set_Class(NodeIndex* index, NodeP* node, char* class)
+{
+    NodeIndex_Remove_Class(index, node);
+    node->class = class;
+    NodeIndex_Add_Class(index, node);
+}
+
+// Indexes every node of a tree built without the index (xml loading)
+void NodeIndex_Build(NodeIndex* index, NodeP* root)
+{
+    DepthFirstSearch dfs = DepthFirstSearch_Create(root);
+    NodeP* node;
+    while(DepthFirstSearch_Next(&dfs, &node)) {
+        NodeIndex_Insert(index, node);
+    }
+    DepthFirstSearch_Free(&dfs);
+}
+
+// Indexes the tree again after its nodes moved (see TreeCompact). Live queries
+// stay valid and are refilled, the numbering moved with the nodes
+void NodeIndex_Rebuild(NodeIndex* index, NodeP* root)
+{
+    NodeIndex_Free_Class_Sets(index);
+    Hashmap_Clear(&index->classNodes);
+    for (int t=0; t<NU_NAT; t++) {
+        Set_Clear(&index->typeNodes[t]);
+        if (index->typeQueries[t] != NULL) NodeQuery_Clear(index->typeQueries[t]);
+    }
+    HashmapIterator it = Hashmap_CreateIterator(&index->classQueries);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        NodeQuery_Clear(*(NodeQuery**)value);
+    }
+    NodeIndex_Build(index, root);
+}
+
+static int NodeIndex_Compare_Pre_Order(const void* a, const void* b)
+{
+    u32 pa = NODEP_OF(*(Node* const*)a)->preOrder;
+    u32 pb = NODEP_OF(*(Node* const*)b)->preOrder;
+    return (pa > pb) - (pa < pb);
+}
+
+// Pushes the nodes of a set that are inside ancestor's subtree (the whole tree without an
+// ancestor) to the result in document order. Deleted subtrees still waiting for the sweep are skipped
+static void NodeIndex_Collect(NodeIndex* index, Tree* tree, Set* nodes, NodeP* ancestor, NU_Nodelist_Internal* result)
+{
+    if (nodes == NULL || nodes->itemCount == 0) return;
+    if (!index->intervalsValid) NodeIndex_Number_Tree(index, tree);
+    SetIterator it = Set_CreateIterator(nodes);
+    void* key;
+    while (Set_IteratorNext(&it, &key)) {
+        NodeP* node = *(NodeP**)key;
+        if (ancestor != NULL && (node->preOrder < ancestor->preOrder || node->postOrder > ancestor->postOrder)) continue;
+        if (TreeNodeDetached(tree, node)) continue;
+        NU_Nodelist_Push(result, &node->node);
+    }
+    qsort(result->nodelist.nodes, result->nodelist.count, sizeof(Node*), NodeIndex_Compare_Pre_Order);
+}
+
+// Nodes with an interned class (ancestor may be NULL for the whole tree)
+void NodeIndex_Query_Class(NodeIndex* index, Tree* tree, char* class, NodeP* ancestor, NU_Nodelist_Internal* result)
+{
+    if (class == NULL) return;
+    Set** found = Hashmap_Get(&index->classNodes, &class);
+    if (found != NULL) NodeIndex_Collect(index, tree, *found, ancestor, result);
+}
+
+// Nodes of a type (ancestor may be NULL for the whole tree)
+void NodeIndex_Query_Type(NodeIndex* index, Tree* tree, NodeType type, NodeP* ancestor, NU_Nodelist_Internal* result)
+{
+    if (type < 0 || type >= NU_NAT) return;
+    NodeIndex_Collect(index, tree, &index->typeNodes[type], ancestor, result);
+}
+
+static NodeQuery* NodeQuery_Create(Tree* tree, Set* nodes, char* class, NodeType type)
+{
+    NodeQuery* q = malloc(sizeof(NodeQuery));
+    q->capacity = max(nodes->itemCount, 8);
+    q->query.nodes = malloc(sizeof(Node*) * q->capacity);
+    q->query.count = 0;
+    q->query.generation = 0;
+    q->watchers = 1;
+    Hashmap_Init(&q->positions, sizeof(NodeP*), sizeof(u32), q->capacity);
+    q->class = class;
+    q->type = type;
+
+    SetIterator it = Set_CreateIterator(nodes);
+    void* key;
+    while (Set_IteratorNext(&it, &key)) {
+        NodeP* node = *(NodeP**)key;
+        if (!TreeNodeDetached(tree, node)) NodeQuery_Insert(q, node);
+    }
+    return q;
+}
+
+// Live nodes with an interned class. Watching the same class again shares the query
+NU_Query* NodeIndex_Watch_Class(NodeIndex* index, Tree* tree, char* class)
+{
+    if (class == NULL) return NULL;
+    NodeQuery** found = Hashmap_Get(&index->classQueries, &class);
+    if (found != NULL) {
+        (*found)->watchers++;
+        return &(*found)->query;
+    }
+
+    Set empty; Set_Init(&empty, sizeof(NodeP*), 1);
+    Set** nodes = Hashmap_Get(&index->classNodes, &class);
+    NodeQuery* q = NodeQuery_Create(tree, nodes != NULL ? *nodes : &empty, class, NU_NAT);
+    Set_Free(&empty);
+    Hashmap_Set(&index->classQueries, &class, &q);
+    index->queryCount++;
+    return &q->query;
+}
+
+// Live nodes of a type
+NU_Query* NodeIndex_Watch_Type(NodeIndex* index, Tree* tree, NodeType type)
+{
+    if (type < 0 || type >= NU_NAT) return NULL;
+    if (index->typeQueries[type] != NULL) {
+        index->typeQueries[type]->watchers++;
+        return &index->typeQueries[type]->query;
+    }
+    index->typeQueries[type] = NodeQuery_Create(tree, &index->typeNodes[type], NULL, type);
+    index->queryCount++;
+    return &index->typeQueries[type]->query;
+}
+
+// Frees the query once every watch of it is released
+void NodeIndex_Unwatch(NodeIndex* index, NU_Query* query)
+{
+    NodeQuery* q = (NodeQuery*)query;
+    if (--q->watchers > 0) return;
+    if (q->class != NULL) Hashmap_Delete(&index->classQueries, &q->class);
+    else index->typeQueries[q->type] = NULL;
+    NodeQuery_Free(q);
+    index->queryCount--;
+}
@@ -14,11 +14,22 @@ typedef struct Tree
     u32 layerAllocsCapacity;
     u32 depth;
     u32 nodeCount;
-    Array deleteStack; // preallocated (reduce fragmentation)
-    Array deletedButNotFreedNodes;
+    Array deleteStack; // detached nodes waiting for TreeSweepDeleted
+    Hashmap childArrays; // parent NodeP* -> TreeChildArray* (built on first indexed access)
 } Tree;
 
+// Children of a parent in sibling order, kept in sync with the sibling chain once built
+typedef struct TreeChildArray
+{
+    NodeP** children; // parent->childCount entries
+    u32 capacity;
+} TreeChildArray;
+
+// Parents with fewer children are walked instead of indexed
+#define TREE_CHILD_ARRAY_MIN 16
+
 typedef void (*TreeDeleteCallback)(NodeP* node);
+typedef void (*TreeCloneCallback)(NodeP* clone, NodeP* src);
 
 NodeP* TreeCreate(Tree* tree, NodeType rootType)
 {
@@ -31,8 +42,8 @@ NodeP* TreeCreate(Tree* tree, NodeType rootType)
         else Nalloc_Init(&tree->layerAllocs[i], 100);
     }
 
-    Array_Init(&tree->deletedButNotFreedNodes, sizeof(NodeP*), 25);
     Array_Init(&tree->deleteStack, sizeof(NodeP*), 100);
+    Hashmap_Init(&tree->childArrays, sizeof(NodeP*), sizeof(TreeChildArray*), 8);
 
     // member variables
     tree->depth = 1;
@@ -48,22 +59,122 @@ NodeP* TreeCreate(Tree* tree, NodeType rootType)
     root->clippedAncestor = NULL;
     root->childCount = 0;
     root->layer = 0;
+    root->allocLayer = 0;
     root->stateFlags = 0;
     NU_ApplyNodeDefaults(root);
     tree->root = root;
     return root;
 }
 
+static void TreeDropAllChildArrays(Tree* tree)
+{
+    HashmapIterator it = Hashmap_CreateIterator(&tree->childArrays);
+    void* key; void* value;
+    while (Hashmap_IteratorNext(&it, &key, &value)) {
+        TreeChildArray* array = *(TreeChildArray**)value;
+        free(array->children);
+        free(array);
+    }
+    Hashmap_Clear(&tree->childArrays);
+}
+
 void TreeFree(Tree* tree)
 {
+    TreeDropAllChildArrays(tree);
+    Hashmap_Free(&tree->childArrays);
     for (int i=0; i<tree->layerAllocsCapacity; i++) {
         Nalloc_Destroy(&tree->layerAllocs[i]);
     }
     free(tree->layerAllocs);
+    Array_Free(&tree->deleteStack);
     tree->depth = 0;
     tree->nodeCount = 0;
 }
 
+// ------------------------------
+// --- Indexed child access -----
+// ------------------------------
+static inline TreeChildArray* TreeGetChildArray(Tree* tree, NodeP* parent)
+{
+    if (tree->childArrays.itemCount == 0) return NULL;
+    TreeChildArray** found = Hashmap_Get(&tree->childArrays, &parent);
+    return found ? *found : NULL;
+}
+
+static void TreeChildArray_Reserve(TreeChildArray* array, u32 count)
+{
+    if (count <= array->capacity) return;
+    array->capacity = count * 2;
+    array->children = realloc(array->children, sizeof(NodeP*) * array->capacity);
+}
+
+static void TreeDropChildArray(Tree* tree, NodeP* parent)
+{
+    TreeChildArray* array = TreeGetChildArray(tree, parent);
+    if (array == NULL) return;
+    free(array->children);
+    free(array);
+    Hashmap_Delete(&tree->childArrays, &parent);
+}
+
+// Call after node was linked as parent's last child (childCount already incremented)
+static void TreeChildArray_Append(Tree* tree, NodeP* parent, NodeP* node)
+{
+    TreeChildArray* array = TreeGetChildArray(tree, parent);
+    if (array == NULL) return;
+    TreeChildArray_Reserve(array, parent->childCount);
+    array->children[parent->childCount - 1] = node;
+}
+
+// Call after node was unlinked from parent (childCount already decremented).
+// Parents dropping below TREE_CHILD_ARRAY_MIN lose their array, TreeChildren never
+// hands it out for them so it would go stale when the siblings are relinked
+static void TreeChildArray_Remove(Tree* tree, NodeP* parent, NodeP* node)
+{
+    TreeChildArray* array = TreeGetChildArray(tree, parent);
+    if (array == NULL) return;
+    if (parent->childCount < TREE_CHILD_ARRAY_MIN) {
+        TreeDropChildArray(tree, parent);
+        return;
+    }
+    u32 count = parent->childCount + 1;
+    for (u32 i=0; i<count; i++) {
+        if (array->children[i] != node) continue;
+        memmove(&array->children[i], &array->children[i + 1], sizeof(NodeP*) * (count - i - 1));
+        break;
+    }
+}
+
+// Returns parent's children in sibling order, building the array on first use.
+// Returns NULL for parents with few children
+static TreeChildArray* TreeChildren(Tree* tree, NodeP* parent)
+{
+    if (parent->childCount < TREE_CHILD_ARRAY_MIN) return NULL;
+    TreeChildArray* array = TreeGetChildArray(tree, parent);
+    if (array != NULL) return array;
+
+    array = malloc(sizeof(TreeChildArray));
+    array->children = NULL;
+    array->capacity = 0;
+    TreeChildArray_Reserve(array, parent->childCount);
+    u32 i = 0;
+    for (NodeP* child = parent->firstChild; child != NULL; child = child->nextSibling) {
+        array->children[i++] = child;
+    }
+    Hashmap_Set(&tree->childArrays, &parent, &array);
+    return array;
+}
+
+NodeP* TreeChildAt(Tree* tree, NodeP* parent, u32 index)
+{
+    if (index >= parent->childCount) return NULL;
+    TreeChildArray* array = TreeChildren(tree, parent);
+    if (array != NULL) return array->children[index];
+    NodeP* child = parent->firstChild;
+    for (u32 i=0; i<index; i++) child = child->nextSibling;
+    return child;
+}
+
 void TreeAddLayer(Tree* tree)
 {
     u32 newCapacity = tree->layerAllocsCapacity * 2;
@@ -76,8 +187,8 @@ void TreeAddLayer(Tree* tree)
 
 NodeP* TreeCreateNode(Tree* tree, NodeP* parent, NodeType type)
 {
-    // add additional layer allocator if necessary
-    if (parent->layer + 1 == tree->layerAllocsCapacity) {
+    // add additional layer allocators if necessary (reparenting can deepen a subtree)
+    while (parent->layer + 1 >= tree->layerAllocsCapacity) {
         TreeAddLayer(tree);
     }
 
@@ -90,12 +201,14 @@ NodeP* TreeCreateNode(Tree* tree, NodeP* parent, NodeType type)
     NodeP* newNode = Nalloc_Alloc(nalloc);
     newNode->type = type;
     newNode->parent = parent;
+    newNode->prevSibling = NULL;
     newNode->nextSibling = NULL;
     newNode->firstChild = NULL;
     newNode->lastChild = NULL;
     newNode->clippedAncestor = NULL;
     newNode->childCount = 0;
     newNode->layer = parent->layer + 1;
+    newNode->allocLayer = newNode->layer;
     newNode->stateFlags = 0;
     NU_ApplyNodeDefaults(newNode);
 
@@ -111,10 +224,82 @@ NodeP* TreeCreateNode(Tree* tree, NodeP* parent, NodeType type)
         parent->lastChild = newNode;
     }
     parent->childCount++;
+    TreeChildArray_Append(tree, parent, newNode);
 
     return newNode;
 }
 
+// Copies a node record into the layer allocator below parent and appends it to parent's children
+static NodeP* TreeCopyNode(Tree* tree, NodeP* src, NodeP* parent)
+{
+    while (parent->layer + 1 >= tree->layerAllocsCapacity) {
+        TreeAddLayer(tree);
+    }
+    if (parent->layer == tree->depth - 1) tree->depth++;
+    tree->nodeCount++;
+
+    NodeP* copy = Nalloc_Alloc(&tree->layerAllocs[parent->layer + 1]);
+    memcpy(copy, src, sizeof(NodeP));
+    copy->parent = parent;
+    copy->prevSibling = parent->lastChild;
+    copy->nextSibling = NULL;
+    copy->firstChild = NULL;
+    copy->lastChild = NULL;
+    copy->clippedAncestor = NULL;
+    copy->childCount = 0;
+    copy->layer = parent->layer + 1;
+    copy->allocLayer = copy->layer;
+    copy->windowID = parent->windowID;
+
+    if (parent->firstChild == NULL) parent->firstChild = copy;
+    else parent->lastChild->nextSibling = copy;
+    parent->lastChild = copy;
+    parent->childCount++;
+    TreeChildArray_Append(tree, parent, copy);
+    return copy;
+}
+
+// Clones src (and its descendants if deep) as the last child of newParent. Node records are
+// copied as is, so resolved styles carry over. cloneCB fixes up per node resources.
+// Window nodes are not cloned, and newParent must not be inside the cloned subtree
+NodeP* TreeCloneNode(Tree* tree, NodeP* src, NodeP* newParent, bool deep, TreeCloneCallback cloneCB)
+{
+    if (!src || !newParent || src->type == NU_WINDOW) return NULL;
+    if (deep) {
+        for (NodeP* ancestor = newParent; ancestor != NULL; ancestor = ancestor->parent) {
+            if (ancestor == src) return NULL;
+        }
+    }
+
+    NodeP* clone = TreeCopyNode(tree, src, newParent);
+    if (cloneCB != NULL) cloneCB(clone, src);
+    if (!deep) return clone;
+
+    // Stack of (source, clone) pairs whose children still need copying
+    Array stack; Array_Init(&stack, sizeof(NodeP*), 32);
+    Array_Push(&stack, &src);
+    Array_Push(&stack, &clone);
+    while (stack.size > 0) {
+        NodeP* cloneParent = *(NodeP**)Array_Get(&stack, stack.size - 1);
+        NodeP* srcParent = *(NodeP**)Array_Get(&stack, stack.size - 2);
+        stack.size -= 2;
+
+        // Copy all children first so sibling order is kept
+        NodeP* srcChild = srcParent->firstChild;
+        for (; srcChild != NULL; srcChild = srcChild->nextSibling) {
+            if (srcChild->type == NU_WINDOW) continue;
+            NodeP* cloneChild = TreeCopyNode(tree, srcChild, cloneParent);
+            if (cloneCB != NULL) cloneCB(cloneChild, srcChild);
+            if (srcChild->firstChild != NULL) {
+                Array_Push(&stack, &srcChild);
+                Array_Push(&stack, &cloneChild);
+            }
+        }
+    }
+    Array_Free(&stack);
+    return clone;
+}
+
 void TreeShiftNodeInParent(Tree* tree, NodeP* node, int index)
 {
     if (!node || !node->parent) return;
@@ -127,14 +312,20 @@ void TreeShiftNodeInParent(Tree* tree, NodeP* node, int index)
     if (index >= parent->childCount) index = parent->childCount - 1;
 
     // Find current index
+    TreeChildArray* array = TreeChildren(tree, parent);
     int currentIndex = 0;
-    NodeP* it = parent->firstChild;
-    while (it && it != node) {
-        it = it->nextSibling;
-        currentIndex++;
+    if (array != NULL) {
+        while (currentIndex < parent->childCount && array->children[currentIndex] != node) currentIndex++;
+        if (currentIndex == parent->childCount) return; // not found (shouldn't happen)
+    }
+    else {
+        NodeP* it = parent->firstChild;
+        while (it && it != node) {
+            it = it->nextSibling;
+            currentIndex++;
+        }
+        if (!it) return; // not found (shouldn't happen)
     }
-
-    if (!it) return;                 // not found (shouldn't happen)
     if (currentIndex == index) return;  // already in position
 
     // Detach from sibling chain 
@@ -147,24 +338,80 @@ void TreeShiftNodeInParent(Tree* tree, NodeP* node, int index)
     node->prevSibling = NULL;
     node->nextSibling = NULL;
 
-    // Reinsert at new index
-    if (index == 0) {
-        node->nextSibling = parent->firstChild;
-        parent->firstChild->prevSibling = node;
-        parent->firstChild = node;
+    // Find the sibling to insert before (NULL -> insert at the end)
+    NodeP* at;
+    if (array != NULL) {
+        if (currentIndex < index) {
+            memmove(&array->children[currentIndex], &array->children[currentIndex + 1], sizeof(NodeP*) * (index - currentIndex));
+        } else {
+            memmove(&array->children[index + 1], &array->children[index], sizeof(NodeP*) * (currentIndex - index));
+        }
+        array->children[index] = node;
+        at = (index + 1 < parent->childCount) ? array->children[index + 1] : NULL;
     }
     else {
-        NodeP* at = parent->firstChild;
+        at = parent->firstChild;
         for (int i=0; i<index; i++) { 
             at = at->nextSibling; 
         }
+    }
+
+    // Reinsert at new index
+    if (at == NULL) {
+        node->prevSibling = parent->lastChild;
+        parent->lastChild->nextSibling = node;
+        parent->lastChild = node;
+    }
+    else {
         node->prevSibling = at->prevSibling;
         node->nextSibling = at;
-        at->prevSibling->nextSibling = node;
+        if (at->prevSibling) at->prevSibling->nextSibling = node;
+        else parent->firstChild = node;
         at->prevSibling = node;
     }
+}
+
+// Relinks parent's children so that child i is the child previously at permutation[i].
+// Returns false (and changes nothing) if permutation is not a permutation of [0, childCount)
+bool TreeReorderChildren(Tree* tree, NodeP* parent, const int* permutation)
+{
+    u32 count = parent->childCount;
+    if (count <= 1 || permutation == NULL) return count <= 1;
+
+    // Children in their current order
+    TreeChildArray* array = TreeChildren(tree, parent);
+    NodeP** order = malloc(sizeof(NodeP*) * count);
+    if (array != NULL) memcpy(order, array->children, sizeof(NodeP*) * count);
+    else {
+        u32 i = 0;
+        for (NodeP* child = parent->firstChild; child != NULL; child = child->nextSibling) order[i++] = child;
+    }
 
-    if (index == parent->childCount - 1) parent->lastChild = node;
+    // Validate
+    u8* used = calloc(count, 1);
+    bool valid = true;
+    for (u32 i=0; i<count && valid; i++) {
+        int from = permutation[i];
+        if (from < 0 || (u32)from >= count || used[from]) valid = false;
+        else used[from] = 1;
+    }
+    free(used);
+    if (!valid) { free(order); return false; }
+
+    // Relink all siblings in one pass
+    NodeP* prev = NULL;
+    for (u32 i=0; i<count; i++) {
+        NodeP* child = order[permutation[i]];
+        child->prevSibling = prev;
+        if (prev) prev->nextSibling = child;
+        else parent->firstChild = child;
+        if (array != NULL) array->children[i] = child;
+        prev = child;
+    }
+    prev->nextSibling = NULL;
+    parent->lastChild = prev;
+    free(order);
+    return true;
 }
 
 void TreeReparentNode(Tree* tree, NodeP* node, NodeP* newParent)
@@ -181,6 +428,7 @@ void TreeReparentNode(Tree* tree, NodeP* node, NodeP* newParent)
     }
 
     NodeP* oldParent = node->parent;
+    int layerShift = (int)newParent->layer + 1 - (int)node->layer;
 
     // Detach from old parent's sibling chain
     if (node->prevSibling) node->prevSibling->nextSibling = node->nextSibling;
@@ -190,17 +438,28 @@ void TreeReparentNode(Tree* tree, NodeP* node, NodeP* newParent)
     else oldParent->lastChild = node->prevSibling;
 
     oldParent->childCount--;
+    TreeChildArray_Remove(tree, oldParent, node);
 
     // Attach to new parent as last child
     node->parent = newParent;
     node->prevSibling = newParent->lastChild;
     node->nextSibling = NULL;
     node->clippedAncestor = NULL;
-    node->layer = newParent->layer + 1;
     if (node->type != NU_WINDOW) {
         node->windowID = newParent->windowID;
     }
 
+    // The whole subtree moves by the same number of levels (records stay in their allocators)
+    if (layerShift != 0) {
+        DepthFirstSearch dfs = DepthFirstSearch_Create(node);
+        NodeP* descendant;
+        while (DepthFirstSearch_Next(&dfs, &descendant)) {
+            descendant->layer += layerShift;
+            if (descendant->layer >= tree->depth) tree->depth = descendant->layer + 1;
+        }
+        DepthFirstSearch_Free(&dfs);
+    }
+
     if (newParent->firstChild == NULL) {
         newParent->firstChild = node;
         newParent->lastChild = node;
@@ -210,94 +469,140 @@ void TreeReparentNode(Tree* tree, NodeP* node, NodeP* newParent)
         newParent->lastChild = node;
     }
     newParent->childCount++;
+    TreeChildArray_Append(tree, newParent, node);
 }
 
-void TreeDeleteLeaf(Tree* tree, NodeP* leaf, TreeDeleteCallback deleteCB)
+// Unlinks node (and so its subtree) from the tree in O(1). The subtree's nodes are torn down
+// and freed by TreeSweepDeleted, until then they stay readable but unreachable from the root
+void TreeDeleteNode(Tree* tree, NodeP* node)
 {
-    tree->nodeCount--;
+    NodeP* parent = node->parent;
+    if (parent == NULL || (node->stateFlags & STATE_FLAG_DELETED)) return;
 
-    // case 1: leaf node has no siblings
-    if (leaf->parent->childCount == 1) {
-        leaf->parent->firstChild = NULL; 
-        leaf->parent->lastChild = NULL; 
-        leaf->parent->childCount = 0;
-    }
-    // case 2: leaf is last child in parent
-    else if (leaf->nextSibling == NULL) {
-        leaf->parent->lastChild = leaf->prevSibling;
-        leaf->prevSibling->nextSibling = NULL;
-        leaf->parent->childCount--;
-    }
-    // case 3: leaf has next siblings in the chain
-    else {
-        // if leaf is first child
-        if (leaf == leaf->parent->firstChild) {
-            leaf->parent->firstChild = leaf->nextSibling;
-            leaf->nextSibling->prevSibling = NULL;
-        }
-        // leaf is in the middle
-        else {
-            leaf->prevSibling->nextSibling = leaf->nextSibling;
-            leaf->nextSibling->prevSibling = leaf->prevSibling;
-        }
-        leaf->parent->childCount--;
-    }
-    
-    if (deleteCB != NULL) deleteCB(leaf);
+    if (node->prevSibling) node->prevSibling->nextSibling = node->nextSibling;
+    else parent->firstChild = node->nextSibling;
+    if (node->nextSibling) node->nextSibling->prevSibling = node->prevSibling;
+    else parent->lastChild = node->prevSibling;
+    parent->childCount--;
+    TreeChildArray_Remove(tree, parent, node);
 
-    // Add to list of deleted but not freed nodes
-    Array_Push(&tree->deletedButNotFreedNodes, &leaf); 
-    leaf->stateFlags |= STATE_FLAG_DELETED;
+    node->parent = NULL;
+    node->prevSibling = NULL;
+    node->nextSibling = NULL;
+    node->stateFlags |= STATE_FLAG_DELETED;
+    Array_Push(&tree->deleteStack, &node);
 }
 
-void TreeDeleteNode(Tree* tree, NodeP* node, TreeDeleteCallback deleteCB)
+// True if node was deleted or is inside a deleted subtree that has not been swept yet
+static inline bool TreeNodeDetached(Tree* tree, NodeP* node)
 {
-    if (node->firstChild == NULL) {
-        TreeDeleteLeaf(tree, node, deleteCB);
-        return;
+    if (tree->deleteStack.size == 0) return false;
+    for (; node != NULL; node = node->parent) {
+        if (node->stateFlags & STATE_FLAG_DELETED) return true;
     }
+    return false;
+}
 
-    // push children only (NOT node itself)
-    NodeP* sib = node->firstChild;
-    while (sib != NULL) {
-        Array_Push(&tree->deleteStack, &sib);
-        sib = sib->nextSibling;
-    }
-
-    // detach subtree immediately
-    node->firstChild = NULL;
-    node->lastChild = NULL;
-    node->childCount = 0;
-
-    while (tree->deleteStack.size > 0) {
-
-        NodeP* cur = *(NodeP**)Array_Get(&tree->deleteStack, tree->deleteStack.size-1);
+// Tears down (deleteCB) and frees up to budget deleted nodes, all of them if budget is 0.
+// A node's children are detached and queued when it is freed. Once everything is swept,
+// allocator arrays emptied by the deletions are returned. Returns true when nothing is left
+bool TreeSweepDeleted(Tree* tree, u32 budget, TreeDeleteCallback deleteCB)
+{
+    u32 swept = 0;
+    while (tree->deleteStack.size > 0 && (budget == 0 || swept < budget)) {
+        NodeP* node = *(NodeP**)Array_Get(&tree->deleteStack, tree->deleteStack.size - 1);
         tree->deleteStack.size--;
 
-        // push children
-        NodeP* c = cur->firstChild;
-        while (c != NULL) {
-            Array_Push(&tree->deleteStack, &c);
-            c = c->nextSibling;
+        for (NodeP* child = node->firstChild; child != NULL; child = child->nextSibling) {
+            child->parent = NULL;
+            child->stateFlags |= STATE_FLAG_DELETED;
+            Array_Push(&tree->deleteStack, &child);
         }
-
-        if (deleteCB != NULL) deleteCB(cur);
-
-        // Add to list of deleted but not freed nodes
-        Array_Push(&tree->deletedButNotFreedNodes, &cur); cur->stateFlags |= STATE_FLAG_DELETED;
+        if (deleteCB != NULL) deleteCB(node);
+        TreeDropChildArray(tree, node);
+        Nalloc_Free(&tree->layerAllocs[node->allocLayer], node);
         tree->nodeCount--;
+        swept++;
     }
+    if (tree->deleteStack.size > 0) return false;
 
-    // finally unlink + delete node itself
-    TreeDeleteLeaf(tree, node, deleteCB);
+    for (u32 l=1; l<tree->layerAllocsCapacity; l++) {
+        Nalloc* nalloc = &tree->layerAllocs[l];
+        if (nalloc->freedSinceRelease >= nalloc->chunksPerArray) Nalloc_Release_Empty_Blocks(nalloc);
+    }
+    return true;
 }
 
-void TreeFreeDeleted(Tree* tree)
+static inline NodeP* TreeRemapNode(Hashmap* remap, NodeP* node)
 {
-    for (int i=0; i<tree->deletedButNotFreedNodes.size; i++) {
-        NodeP* deletedNode = *(NodeP**)Array_Get(&tree->deletedButNotFreedNodes, i);
-        Nalloc* nalloc = &tree->layerAllocs[deletedNode->layer];
-        Nalloc_Free(nalloc, deletedNode);
+    if (node == NULL) return NULL;
+    NodeP** found = Hashmap_Get(remap, &node);
+    return found ? *found : node;
+}
+
+// Moves every node into fresh layer allocators sized to fit, in level order (each level is
+// contiguous with siblings adjacent), then releases the old allocators. Deleted nodes must be
+// swept first. remap receives old NodeP* -> new NodeP* so callers can fix their own references
+void TreeCompact(Tree* tree, Hashmap* remap)
+{
+    // Collect nodes in breadth first order
+    Array order; Array_Init(&order, sizeof(NodeP*), tree->nodeCount);
+    Array_Push(&order, &tree->root);
+    for (u32 i=0; i<order.size; i++) {
+        NodeP* node = *(NodeP**)Array_Get(&order, i);
+        for (NodeP* child = node->firstChild; child != NULL; child = child->nextSibling) {
+            Array_Push(&order, &child);
+        }
+    }
+    NodeP* deepest = *(NodeP**)Array_Get(&order, order.size - 1);
+    u32 depth = deepest->layer + 1;
+
+    // Size each new allocator to its level
+    u32 capacity = 4;
+    while (capacity <= depth) capacity *= 2;
+    u32* levelCounts = calloc(capacity, sizeof(u32));
+    for (u32 i=0; i<order.size; i++) {
+        levelCounts[(*(NodeP**)Array_Get(&order, i))->layer]++;
+    }
+    Nalloc* layerAllocs = malloc(sizeof(Nalloc) * capacity);
+    for (u32 l=0; l<capacity; l++) {
+        if (l == 0) Nalloc_Init(&layerAllocs[l], 1);
+        else {
+            Nalloc_Init(&layerAllocs[l], levelCounts[l] + 16);
+            layerAllocs[l].chunksPerArray = 128;
+        }
+    }
+    free(levelCounts);
+
+    // Copy records (a fresh allocator hands out chunks in address order)
+    for (u32 i=0; i<order.size; i++) {
+        NodeP* node = *(NodeP**)Array_Get(&order, i);
+        NodeP* copy = Nalloc_Alloc(&layerAllocs[node->layer]);
+        memcpy(copy, node, sizeof(NodeP));
+        copy->allocLayer = copy->layer;
+        Hashmap_Set(remap, &node, &copy);
     }
-    Array_Clear(&tree->deletedButNotFreedNodes);
-}
\ No newline at end of file
+
+    // Relink copies
+    for (u32 i=0; i<order.size; i++) {
+        NodeP* copy = TreeRemapNode(remap, *(NodeP**)Array_Get(&order, i));
+        copy->parent = TreeRemapNode(remap, copy->parent);
+        copy->nextSibling = TreeRemapNode(remap, copy->nextSibling);
+        copy->prevSibling = TreeRemapNode(remap, copy->prevSibling);
+        copy->firstChild = TreeRemapNode(remap, copy->firstChild);
+        copy->lastChild = TreeRemapNode(remap, copy->lastChild);
+        copy->clippedAncestor = TreeRemapNode(remap, copy->clippedAncestor);
+    }
+    Array_Free(&order);
+
+    // Child arrays rebuild on demand, old allocators return their memory
+    TreeDropAllChildArrays(tree);
+    for (u32 l=0; l<tree->layerAllocsCapacity; l++) {
+        Nalloc_Destroy(&tree->layerAllocs[l]);
+    }
+    free(tree->layerAllocs);
+    tree->layerAllocs = layerAllocs;
+    tree->layerAllocsCapacity = capacity;
+    tree->depth = depth;
+    tree->root = TreeRemapNode(remap, tree->root);
+}
@@ -2,11 +2,13 @@
 #include <window/nu_window_manager_structs.h>
 #include <window/cursor.h>
 
-void InitGlew(WindowManager* winManager)
+void InitGlew(WindowManager* winManager, int width, int height)
 {
     // Create NU_Window
     NU_Window win;
-    win.window = SDL_CreateWindow("Window", 1000, 800, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    win.window = SDL_CreateWindow("Window", width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    win.width = 0;
+    win.height = 0;
 
     // Init gl context
     GUI.gl_ctx = SDL_GL_CreateContext(win.window);
@@ -25,29 +27,45 @@ void InitGlew(WindowManager* winManager)
     glClearDepth(0.0);
 }
 
+// Headless root window (no SDL window, no GL context)
+void InitHeadless(WindowManager* winManager, int width, int height)
+{
+    NU_Window win;
+    win.window = NULL;
+    win.width = width;
+    win.height = height;
+    winManager->rootWindowID = Container_Add(&winManager->windows, &win);
+}
+
 void CreateSubwindow(WindowManager* winManager, NodeP* node)
 {
     // Create NU_Window
     NU_Window win;
-    win.window = SDL_CreateWindow("window", 500, 400, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    win.window = GUI.headless ? NULL : SDL_CreateWindow("window", 500, 400, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    win.width = 500;
+    win.height = 400;
 
     // Init drawlist
     NU_WindowDrawlist* list = &win.drawlist;
     Array_Init(&list->drawNodes, sizeof(NodeP*), 512);
     Array_Init(&list->clippedDrawNodes, sizeof(NodeP*), 64);
+    Array_Init(&list->scrollCacheNodes, sizeof(NodeP*), 4);
+    Array_Init(&list->layerNodes, sizeof(NodeP*), 4);
 
     // Add NU_Window to Window Manager
     node->windowID = Container_Add(&winManager->windows, &win);
     Array_Push(&winManager->windowNodes, &node);
 }
 
-void WindowManager_Init(WindowManager* winManager)
+void WindowManager_Init(WindowManager* winManager, int rootWidth, int rootHeight)
 {
     winManager->windows = Container_Create(sizeof(NU_Window));
     Array_Init(&winManager->windowNodes, sizeof(NodeP*), 8);
     Array_Init(&winManager->absoluteRootNodes, sizeof(NodeP*), 8);
     Hashmap_Init(&winManager->clipMap, sizeof(NodeP*), sizeof(NU_ClipBounds), 16);
-    InitGlew(winManager);
+    Array_Init(&winManager->occluders, sizeof(NU_Occluder), 32);
+    if (GUI.headless) InitHeadless(winManager, rootWidth, rootHeight);
+    else InitGlew(winManager, rootWidth, rootHeight);
     winManager->hoveredWindowID = -1;
 }
 
@@ -57,11 +75,14 @@ void WindowManager_Free(WindowManager* winManager)
         NU_Window* win = Container_GetAt(&winManager->windows, i);
         Array_Free(&win->drawlist.drawNodes);
         Array_Free(&win->drawlist.clippedDrawNodes);
+        Array_Free(&win->drawlist.scrollCacheNodes);
+        Array_Free(&win->drawlist.layerNodes);
     }
     Container_Free(&winManager->windows);
     Array_Free(&winManager->windowNodes);
     Array_Free(&winManager->absoluteRootNodes);
     Hashmap_Free(&winManager->clipMap);
+    Array_Free(&winManager->occluders);
     winManager->hoveredWindowID = -1;
 }
 
@@ -82,6 +103,17 @@ SDL_Window* GetSDL_Window(WindowManager* winManager, int windowID)
     return win->window;
 }
 
+void GetWindowSize(WindowManager* winManager, int windowID, int* w, int* h)
+{
+    NU_Window* win = Container_Get(&winManager->windows, windowID);
+    if (win->window != NULL) {
+        SDL_GetWindowSize(win->window, w, h);
+        return;
+    }
+    *w = win->width;
+    *h = win->height;
+}
+
 NU_WindowDrawlist* GetDrawlist(WindowManager* winManager, int windowID)
 {
     NU_Window* win = Container_Get(&winManager->windows, windowID);
@@ -90,11 +122,10 @@ NU_WindowDrawlist* GetDrawlist(WindowManager* winManager, int windowID)
 
 void AssignRootWindow(WindowManager* winManager, NodeP* rootNode)
 {
-    SDL_Window* window = GetSDL_Window(winManager, winManager->rootWindowID);
-    SDL_ShowWindow(window);
+    if (!GUI.headless) SDL_ShowWindow(GetSDL_Window(winManager, winManager->rootWindowID));
 
     int winW, winH;
-    SDL_GetWindowSize(window, &winW, &winH);
+    GetWindowSize(winManager, winManager->rootWindowID, &winW, &winH);
     rootNode->node.width = (float)winW;
     rootNode->node.height = (float)winH;
     rootNode->node.minWidth = winW;
@@ -108,8 +139,10 @@ void AssignRootWindow(WindowManager* winManager, NodeP* rootNode)
     NU_WindowDrawlist* list = GetDrawlist(winManager, winManager->rootWindowID);
     Array_Init(&list->drawNodes, sizeof(NodeP*), 512);
     Array_Init(&list->clippedDrawNodes, sizeof(NodeP*), 64);
+    Array_Init(&list->scrollCacheNodes, sizeof(NodeP*), 4);
+    Array_Init(&list->layerNodes, sizeof(NodeP*), 4);
 
-    NU_Draw_Init();
+    if (!GUI.headless) NU_Draw_Init();
 }
 
 void GetLocalMouseCoords(WindowManager* winManager, float* outX, float* outY)
@@ -157,4 +190,16 @@ inline void SetNodeDrawlist_Clipped(WindowManager* winManager, NodeP* node)
 {
     NU_WindowDrawlist* list = GetDrawlist(winManager, node->windowID);
     Array_Push(&list->clippedDrawNodes, &node);
+}
+
+inline void SetNodeDrawlist_ScrollCache(WindowManager* winManager, NodeP* node)
+{
+    NU_WindowDrawlist* list = GetDrawlist(winManager, node->windowID);
+    Array_Push(&list->scrollCacheNodes, &node);
+}
+
+inline void SetNodeDrawlist_Layer(WindowManager* winManager, NodeP* node)
+{
+    NU_WindowDrawlist* list = GetDrawlist(winManager, node->windowID);
+    Array_Push(&list->layerNodes, &node);
 }   
\ No newline at end of file
@@ -7,11 +7,22 @@ typedef struct NU_WindowDrawlist
 {
     Array drawNodes;
     Array clippedDrawNodes;
+    Array scrollCacheNodes; // scroll nodes whose content is composited from tiles
+    Array layerNodes;       // promoted nodes whose descendants are composited from a layer
 } NU_WindowDrawlist;
 
+// Opaque area of a drawn node, used to cull nodes hidden behind it
+typedef struct NU_Occluder
+{
+    NU_ClipBounds bounds;
+    float z;
+    float area;
+} NU_Occluder;
+
 typedef struct NU_Window
 {
-    SDL_Window* window;
+    SDL_Window* window; // NULL -> headless window
+    int width, height;  // headless windows only
     NU_WindowDrawlist drawlist;
 } NU_Window;
 
@@ -22,6 +33,7 @@ typedef struct WindowManager
     Array windowNodes;
     Array absoluteRootNodes;
     Hashmap clipMap;
+    Array occluders;
     int hoveredWindowID;
     int rootWindowID;
 } WindowManager;
\ No newline at end of file
@@ -6,7 +6,12 @@
 // --- Nodus UI functions ---
 // --------------------------
 __declspec(dllexport) int NU_Create_Gui(const char* xml_filepath, const char* css_filepath) {
-    return NU_Internal_Create_Gui(xml_filepath, css_filepath);
+    return NU_Internal_Create_Gui(xml_filepath, css_filepath, false, 1000, 800);
+}
+
+__declspec(dllexport) int NU_Create_Gui_Headless(const char* xml_filepath, const char* css_filepath, int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    return NU_Internal_Create_Gui(xml_filepath, css_filepath, true, width, height);
 }
 
 __declspec(dllexport) void NU_Quit(void) {
@@ -14,26 +19,38 @@ __declspec(dllexport) void NU_Quit(void) {
 }
 
 __declspec(dllexport) int NU_Running(void) {
-    if (!GUI.running) return 0;
+    if (!GUI.running || GUI.headless) return 0;
 
     SDL_Event event;
     while (SDL_PollEvent(&event)) {}
 
-    if (GUI.awaiting_redraw) 
+    // Layout, hover, drawing and resize events wait for the outermost NU_End_Update
+    if (GUI.updateDepth == 0)
     {
-        NU_Layout();
-        NU_Mouse_Hover();
-        NU_Draw();
-        CheckForResizeEvents();
-    }
+        // Scrolled content moved under the mouse (may request a full redraw)
+        if (GUI.awaiting_scroll_composite && !GUI.awaiting_redraw) NU_Mouse_Hover();
 
-    // Safely unregister deleted nodes from iterated hashmaps
-    // and free node memory
-    for (int i=0; i<GUI.tree.deletedButNotFreedNodes.size; i++) {
-        NodeP* node = *(NodeP**)Array_Get(&GUI.tree.deletedButNotFreedNodes, i);
-        NU_Unregister_All_Iterated_Events(node);
+        if (GUI.awaiting_redraw || GUI.layoutDirtyRoots.itemCount > 0) 
+        {
+            if (GUI.awaiting_redraw) NU_Layout();
+            else NU_Layout_Contained();
+            GUI.awaiting_redraw = false;
+
+            // Hover styles (and mouse in/out callbacks) that change layout are laid out before drawing
+            NU_Mouse_Hover();
+            if (GUI.awaiting_redraw) NU_Layout();
+            else if (GUI.layoutDirtyRoots.itemCount > 0) NU_Layout_Contained();
+            NU_Draw();
+            CheckForResizeEvents();
+        }
+        else if (GUI.awaiting_scroll_composite) 
+        {
+            NU_Draw();
+        }
     }
-    TreeFreeDeleted(&GUI.tree);
+
+    // Tear down deleted nodes outside of event iteration, a budget per frame
+    NU_Sweep_Deleted_Nodes(NU_SWEEP_BUDGET);
 
     // Wait for next event, with timeout to save CPU
     SDL_WaitEventTimeout(&event, GetFrametime());
@@ -43,12 +60,40 @@ __declspec(dllexport) int NU_Running(void) {
 
 __declspec(dllexport) void NU_Render() 
 {
+    // Headless -> the next NU_Render_To_Framebuffer lays out again
+    if (GUI.headless) {
+        GUI.awaiting_redraw = true;
+        return;
+    }
     SDL_Event e;
     SDL_zero(e);
     e.type = GUI.SDL_CUSTOM_RENDER_EVENT;
+    e.user.code = NU_RENDER_EVENT_NODES_CHANGED;
     SDL_PushEvent(&e);   
 }
 
+__declspec(dllexport) int NU_Render_To_Framebuffer(Node* windowNode, NU_Framebuffer* framebuffer)
+{
+    return NU_Internal_Render_To_Framebuffer(windowNode, framebuffer);
+}
+
+__declspec(dllexport) NU_Framebuffer* NU_Create_Framebuffer(int width, int height)
+{
+    return NU_Framebuffer_Create(width, height);
+}
+
+__declspec(dllexport) const uint32_t* NU_Framebuffer_Pixels(NU_Framebuffer* framebuffer, int* width, int* height)
+{
+    if (width) *width = framebuffer->width;
+    if (height) *height = framebuffer->height;
+    return framebuffer->pixels;
+}
+
+__declspec(dllexport) void NU_Free_Framebuffer(NU_Framebuffer* framebuffer)
+{
+    NU_Framebuffer_Free(framebuffer);
+}
+
 // -----------------------
 // --- Error functions ---
 // -----------------------
@@ -66,6 +111,7 @@ __declspec(dllexport) const char* NU_GetNextError() {
 __declspec(dllexport) void NU_Set_Window_Fullscreen(Node* node) {
     NodeP* nodeP = NODEP_OF(node);
     SDL_Window* window = GetSDL_Window(&GUI.winManager, nodeP->windowID);
+    if (window == NULL) return; // Headless
     Uint32 flags = SDL_GetWindowFlags(window);
     if (flags & SDL_WINDOW_FULLSCREEN) return;
     SDL_SetWindowFullscreen(window, true);
@@ -84,6 +130,7 @@ __declspec(dllexport) void NU_Set_Window_Fullscreen(Node* node) {
 __declspec(dllexport) void NU_Set_Window_Windowed(Node* node) {
     NodeP* nodeP = NODEP_OF(node);
     SDL_Window* window = GetSDL_Window(&GUI.winManager, nodeP->windowID);
+    if (window == NULL) return; // Headless
     Uint32 flags = SDL_GetWindowFlags(window);
     if (!(flags & SDL_WINDOW_FULLSCREEN)) return;
     SDL_SetWindowFullscreen(window, false);
@@ -164,14 +211,8 @@ __declspec(dllexport) Node* NU_PARENT(Node* node) {
 __declspec(dllexport) Node* NU_CHILD(Node* node, u32 childIndex) {
     NodeP* nodeP = NODEP_OF(node);
     if (nodeP == NULL || childIndex >= nodeP->childCount) return NULL;
-    NodeP* child = nodeP->firstChild;
-    u32 i = 0;
-    while(child != NULL) {
-        if (i == childIndex) return &child->node;
-        i++;
-        child = child->nextSibling;
-    }
-    return NULL;
+    NodeP* child = TreeChildAt(&GUI.tree, nodeP, childIndex);
+    return child ? &child->node : NULL;
 }
 
 __declspec(dllexport) int NU_CHILD_COUNT(Node* node) {
@@ -183,6 +224,8 @@ __declspec(dllexport) Node* NU_CREATE_NODE(Node* parent, NodeType type) {
     if (parent == NULL || type == NU_WINDOW) return NULL; // Nodus doesn't yet support window creation
     NodeP* parentP = NODEP_OF(parent);
     NodeP* node = TreeCreateNode(&GUI.tree, parentP, type);
+    NodeIndex_Add(&GUI.nodeIndex, node);
+    NU_Scroll_Cache_Invalidate(parentP);
 
     if (type == NU_INPUT) {
         InputText inputText;
@@ -190,24 +233,63 @@ __declspec(dllexport) Node* NU_CREATE_NODE(Node* parent, NodeType type) {
         node->typeData.input.textInputHandle = Container_Add(&GUI.textInputs, &inputText);
     }
 
-    NU_Apply_Stylesheet_To_Node(node, &GUI.stylesheet);
+    NU_Request_Restyle(node);
     return &node->node;
 }
 
+__declspec(dllexport) Node* NU_Clone_Node(Node* src, Node* newParent, int deep) {
+    if (src == NULL || newParent == NULL) return NULL;
+    NodeP* clone = TreeCloneNode(&GUI.tree, NODEP_OF(src), NODEP_OF(newParent), deep != 0, NU_Clone_Node_Resources);
+    if (clone == NULL) return NULL;
+    NU_Scroll_Cache_Invalidate(clone->parent);
+    GUI.awaiting_redraw = true;
+    return &clone->node;
+}
+
 __declspec(dllexport) void NU_DELETE_NODE(Node* node) {
     NodeP* nodeP = NODEP_OF(node);
-    return TreeDeleteNode(&GUI.tree, nodeP, NU_DissociateNode);
+    NU_Internal_Delete_Node(nodeP);
 }
 
 __declspec(dllexport) void NU_SHIFT_NODE_IN_PARENT(Node* node, int index) {
     NodeP* nodeP = NODEP_OF(node);
     TreeShiftNodeInParent(&GUI.tree, nodeP, index);
+    NodeIndex_Place(&GUI.nodeIndex, nodeP);
+    NU_Scroll_Cache_Invalidate(nodeP->parent);
+}
+
+__declspec(dllexport) int NU_Reorder_Children(Node* parent, const int* permutation) {
+    NodeP* parentP = NODEP_OF(parent);
+    if (!TreeReorderChildren(&GUI.tree, parentP, permutation)) return 0;
+    NodeIndex_Place_Children(&GUI.nodeIndex, parentP);
+    NU_Scroll_Cache_Invalidate(parentP);
+    GUI.awaiting_redraw = true;
+    return 1;
 }
 
 __declspec(dllexport) void NU_REPARENT_NODE(Node* node, Node* newParent) {
     NodeP* nodeP = NODEP_OF(node);
     NodeP* newParentP = NODEP_OF(newParent);
+    NU_Scroll_Cache_Invalidate(nodeP->parent);
     TreeReparentNode(&GUI.tree, nodeP, newParentP);
+    NodeIndex_Place(&GUI.nodeIndex, nodeP);
+    NU_Canvas_Sync_Layers(nodeP);
+    NU_Scroll_Cache_Invalidate(newParentP);
+}
+
+__declspec(dllexport) NU_Handle NU_Get_Handle(Node* node) {
+    if (node == NULL) return (NU_Handle){ 0, 0 };
+    return NodeHandles_Get(&GUI.nodeHandles, NODEP_OF(node));
+}
+
+__declspec(dllexport) Node* NU_Resolve_Handle(NU_Handle handle) {
+    NodeP* node = NodeHandles_Resolve(&GUI.nodeHandles, handle);
+    if (node == NULL || TreeNodeDetached(&GUI.tree, node)) return NULL;
+    return &node->node;
+}
+
+__declspec(dllexport) void NU_Compact_Nodes(void) {
+    NU_Internal_Compact_Nodes();
 }
 
 __declspec(dllexport) float NU_NODE_SCROLL(Node* node) {
@@ -229,7 +311,7 @@ __declspec(dllexport) void NU_SET_INPUT_TEXT_CONTENT(Node* node, const char* tex
     InputText* inputText = Container_Get(&GUI.textInputs, nodeP->typeData.input.textInputHandle);
     InputText_SetText(inputText, nodeP, font, text);
     TriggerOnInputChangedEvent(nodeP, "");
-    GUI.awaiting_redraw = true;
+    NU_Request_Layout(nodeP);
 }
 
 __declspec(dllexport) void NU_FOCUS_ON_INPUT(Node* node) {
@@ -285,11 +367,13 @@ __declspec(dllexport) Node* NU_HOVERED_NODE() {
 __declspec(dllexport) void NU_HIDE(Node* node) {
     NodeP* nodeP = NODEP_OF(node);
     nodeP->layoutFlags |= HIDDEN;
+    NU_Scroll_Cache_Invalidate(nodeP);
 }
 
 __declspec(dllexport) void NU_SHOW(Node* node) {
     NodeP* nodeP = NODEP_OF(node);
     nodeP->layoutFlags &= ~HIDDEN;
+    NU_Scroll_Cache_Invalidate(nodeP);
 }
 
 __declspec(dllexport) int NU_IS_SHOWN(Node* node) {
@@ -301,21 +385,15 @@ __declspec(dllexport) Node* NU_Get_Node_By_Id(const char* id) {
     void* found = Stringmap_Get(&GUI.id_node_map, id);
     if (found == NULL) return NULL;
     NodeP* node = *(NodeP**)found;
+    if (TreeNodeDetached(&GUI.tree, node)) return NULL;
     return &node->node;
 }
 
 __declspec(dllexport) NU_Nodelist NU_Get_Nodes_By_Class(const char* class) {
-    
     NU_Nodelist_Internal result;
     NU_Nodelist_Init(&result, 8);
-    DepthFirstSearch dfs = DepthFirstSearch_Create(GUI.tree.root);
-    NodeP* node;
-    while(DepthFirstSearch_Next(&dfs, &node)) {
-        if (node->class != NULL && strcmp(class, node->class) == 0) {
-            NU_Nodelist_Push(&result, &node->node);
-        }
-    }
-    DepthFirstSearch_Free(&dfs);
+    char* interned = Stringset_Get(&GUI.class_string_set, class);
+    NodeIndex_Query_Class(&GUI.nodeIndex, &GUI.tree, interned, NULL, &result);
     return result.nodelist;
 }
 
@@ -323,28 +401,15 @@ __declspec(dllexport) NU_Nodelist NU_Get_Descendents_With_Class(Node* node, cons
     NodeP* nodeP = NODEP_OF(node);
     NU_Nodelist_Internal result;
     NU_Nodelist_Init(&result, 8);
-    DepthFirstSearch dfs = DepthFirstSearch_Create(nodeP);
-    NodeP* currNode;
-    while(DepthFirstSearch_Next(&dfs, &currNode)) {
-        if (currNode->class != NULL && strcmp(class, currNode->class) == 0) {
-            NU_Nodelist_Push(&result, &currNode->node);
-        }
-    }
-    DepthFirstSearch_Free(&dfs);
+    char* interned = Stringset_Get(&GUI.class_string_set, class);
+    NodeIndex_Query_Class(&GUI.nodeIndex, &GUI.tree, interned, nodeP, &result);
     return result.nodelist;
 }
 
 __declspec(dllexport) NU_Nodelist NU_Get_Nodes_By_Tag(NodeType type) {
     NU_Nodelist_Internal result;
     NU_Nodelist_Init(&result, 8);
-    DepthFirstSearch dfs = DepthFirstSearch_Create(GUI.tree.root);
-    NodeP* node;
-    while(DepthFirstSearch_Next(&dfs, &node)) {
-        if (node->type == type) {
-            NU_Nodelist_Push(&result, &node->node);
-        }
-    }
-    DepthFirstSearch_Free(&dfs);
+    NodeIndex_Query_Type(&GUI.nodeIndex, &GUI.tree, type, NULL, &result);
     return result.nodelist;
 }
 
@@ -389,12 +454,65 @@ __declspec(dllexport) void NU_Nodelist_Free(NU_Nodelist* nodelist) {
     nodelist->count = 0;
 }
 
+__declspec(dllexport) NU_Query* NU_Watch_Class(const char* class) {
+    if (class == NULL) return NULL;
+    // Interned even when no node has the class yet, so NU_Set_Class keeps it
+    char* interned = Stringset_Get(&GUI.class_string_set, class);
+    if (interned == NULL) interned = Stringset_Add(&GUI.class_string_set, class);
+    return NodeIndex_Watch_Class(&GUI.nodeIndex, &GUI.tree, interned);
+}
+
+__declspec(dllexport) NU_Query* NU_Watch_Tag(NodeType type) {
+    return NodeIndex_Watch_Type(&GUI.nodeIndex, &GUI.tree, type);
+}
+
+__declspec(dllexport) void NU_Unwatch(NU_Query* query) {
+    if (query == NULL) return;
+    NodeIndex_Unwatch(&GUI.nodeIndex, query);
+}
+
+__declspec(dllexport) void NU_Begin_Update(void) {
+    NU_Internal_Begin_Update();
+}
+
+__declspec(dllexport) void NU_End_Update(void) {
+    NU_Internal_End_Update();
+}
+
+__declspec(dllexport) void NU_Set_Text(Node* node, const char* text) {
+    NU_Internal_Set_Text(NODEP_OF(node), text, text ? (u32)strlen(text) : 0);
+}
+
+__declspec(dllexport) void NU_Set_Text_Len(Node* node, const char* text, uint32_t len) {
+    NU_Internal_Set_Text(NODEP_OF(node), text, len);
+}
+
+__declspec(dllexport) int NU_Set_Virtual_Rows(Node* container, uint32_t rowCount, NU_Row_Height_Callback heightCB, NU_Row_Bind_Callback bindCB, void* args) {
+    if (container == NULL) return 0;
+    NodeP* containerP = NODEP_OF(container);
+    if (bindCB == NULL) {
+        VirtualRows_End(containerP);
+        return 1;
+    }
+    return VirtualRows_Set(containerP, rowCount, heightCB, bindCB, args);
+}
+
+__declspec(dllexport) int NU_Set_Virtual_Row_Count(Node* container, uint32_t rowCount) {
+    if (container == NULL) return 0;
+    return VirtualRows_Set_Count(NODEP_OF(container), rowCount);
+}
+
+__declspec(dllexport) int NU_Refresh_Virtual_Rows(Node* container, int reestimateHeights) {
+    if (container == NULL) return 0;
+    return VirtualRows_Refresh(NODEP_OF(container), reestimateHeights != 0);
+}
+
 __declspec(dllexport) void NU_Set_Class(Node* node, const char* class) {
     NodeP* nodeP = NODEP_OF(node);
     if (class == nodeP->class) return;
 
     char* prevNodeClass = nodeP->class;
-    nodeP->class = NULL;
+    char* newClass = NULL;
 
     // Look for class in gui class string set
     char* gui_class_get = Stringset_Get(&GUI.class_string_set, class);
@@ -403,22 +521,39 @@ __declspec(dllexport) void NU_Set_Class(Node* node, const char* class) {
 
         // If found in the stylesheet -> add it to the gui class set
         if (style_class_get) {
-            nodeP->class = Stringset_Add(&GUI.class_string_set, class);
+            newClass = Stringset_Add(&GUI.class_string_set, class);
         }
     } 
     else {
-        nodeP->class = gui_class_get; 
+        newClass = gui_class_get; 
     }
+    NodeIndex_Set_Class(&GUI.nodeIndex, nodeP, newClass);
 
     // Update styling
-    NU_Apply_Stylesheet_To_Node(nodeP, &GUI.stylesheet);
-    if (nodeP == GUI.scroll_mouse_down_node) {
-        NU_Apply_Pseudo_Style_To_Node(nodeP, &GUI.stylesheet, PSEUDO_PRESS);
-    } else if (nodeP == GUI.hovered_node) {
-        NU_Apply_Pseudo_Style_To_Node(nodeP, &GUI.stylesheet, PSEUDO_HOVER);
-    }
+    NU_Request_Restyle(nodeP);
+    NU_Request_Layout(nodeP);
+}
 
-    GUI.awaiting_redraw = true;
+// -----------------------
+// --- Image functions ---
+// -----------------------
+__declspec(dllexport) int NU_Load_Image(const char* filepath)
+{
+    return ImageResourceManager_LoadImage(&GUI.imageResourceManager, filepath);
+}
+
+__declspec(dllexport) void NU_Release_Image(int imageHandle)
+{
+    ImageResourceManager_Release(&GUI.imageResourceManager, imageHandle);
+}
+
+__declspec(dllexport) void NU_Set_Node_Image(Node* node, int imageHandle)
+{
+    NodeP* nodeP = NODEP_OF(node);
+    if (nodeP->type == NU_WINDOW || nodeP->type == NU_CANVAS || nodeP->type == NU_INPUT) return;
+    ImageResourceManager_SetNodeImage(&GUI.imageResourceManager, nodeP, imageHandle);
+    nodeP->overrideStyleFlags |= PROPERTY_FLAG_IMAGE;
+    NU_Request_Layout(nodeP);
 }
 
 // -----------------------
@@ -443,7 +578,57 @@ __declspec(dllexport) int64_t NU_Get_Canvas_Ctx(Node* canvasNode)
 
 __declspec(dllexport) void NU_Clear_Canvas(int contextID) 
 {
-    NU_Internal_Clear_Canvas(contextID);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Clear_Canvas(ctx);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Canvas_Begin(int contextID) 
+{
+    NU_Canvas_Begin_Session(contextID);
+}
+
+__declspec(dllexport) void NU_Set_Canvas_Double_Buffered(int contextID, int enabled) 
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Set_Canvas_Double_Buffered(ctx, enabled != 0);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Canvas_Commit(int contextID) 
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Canvas_Commit(ctx);
+    if (ctx == canvasSessionCtx) NU_Canvas_End_Session();
+    else NU_Canvas_Release(ctx);
+}
+
+__declspec(dllexport) int NU_Canvas_Push_Transform(int contextID, float a, float b, float c, float d, float e, float f)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return 0;
+    int transformID = NU_Internal_Canvas_Push_Transform(ctx, a, b, c, d, e, f);
+    NU_Canvas_Done(ctx);
+    return transformID;
+}
+
+__declspec(dllexport) void NU_Canvas_Pop_Transform(int contextID)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Canvas_Pop_Transform(ctx);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Canvas_Set_Transform(int contextID, int transformID, float a, float b, float c, float d, float e, float f)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Canvas_Set_Transform(ctx, transformID, a, b, c, d, e, f);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) NU_RGB NU_RGB_From_Hex(const char* hex)
@@ -466,7 +651,10 @@ __declspec(dllexport) void NU_Border_Rect(
     NU_RGB border_col,
     NU_RGB fill_col) 
 {
-    NU_Internal_Border_Rect(contextID, x, y, w, h, thickness, border_col, fill_col);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Border_Rect(ctx, x, y, w, h, thickness, border_col, fill_col);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Triangle(
@@ -478,7 +666,10 @@ __declspec(dllexport) void NU_Triangle(
     NU_RGB border_col,
     NU_RGB fill_col)
 {
-    NU_Internal_Triangle(contextID, x1, y1, x2, y2, x3, y3, thickness, border_col, fill_col);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Triangle(ctx, x1, y1, x2, y2, x3, y3, thickness, border_col, fill_col);
+    NU_Canvas_Done(ctx);
 } 
 
 __declspec(dllexport) void NU_Vline(
@@ -487,7 +678,10 @@ __declspec(dllexport) void NU_Vline(
     float thickness,
     NU_RGB col) 
 {
-    NU_Internal_Vline(contextID, x, y, height, thickness, col);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Vline(ctx, x, y, height, thickness, col);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Hline(
@@ -496,7 +690,10 @@ __declspec(dllexport) void NU_Hline(
     float thickness,
     NU_RGB col) 
 {
-    NU_Internal_Hline(contextID, x, y, width, thickness, col);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Hline(ctx, x, y, width, thickness, col);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Line(
@@ -505,7 +702,10 @@ __declspec(dllexport) void NU_Line(
     float thickness,
     NU_RGB col) 
 {
-    NU_Internal_Line(contextID, x1, y1, x2, y2, thickness, col);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Line(ctx, x1, y1, x2, y2, thickness, col);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Dashed_Line(
@@ -516,20 +716,71 @@ __declspec(dllexport) void NU_Dashed_Line(
     u32 dash_pattern_len,
     NU_RGB col) 
 {
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
     NU_Internal_Dashed_Line(
-        contextID, 
+        ctx, 
         x1, y1, x2, y2, 
         thickness, 
         dash_pattern,
         dash_pattern_len,
         col);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Polyline(
+    int contextID,
+    const float* xy, u32 count,
+    float thickness,
+    NU_RGB col)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Polyline(ctx, xy, count, thickness, col);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Set_Canvas_Decimation(int contextID, int enabled)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Set_Canvas_Decimation(ctx, enabled != 0);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Points(
+    int contextID,
+    const float* xy, u32 count,
+    float radius,
+    NU_RGB col)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Points(ctx, xy, count, radius, col);
+    NU_Canvas_Done(ctx);
+}
+
+__declspec(dllexport) void NU_Rects(
+    int contextID,
+    const NU_Rect* rects, u32 count,
+    float thickness,
+    NU_RGB border_col,
+    NU_RGB fill_col)
+{
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Rects(ctx, rects, count, thickness, border_col, fill_col);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Set_Canvas_Font(
     int contextID,
     const char* font_name)
 {
-    NU_Internal_Set_Canvas_Font(contextID, font_name);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Set_Canvas_Font(ctx, font_name);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) void NU_Text(
@@ -537,7 +788,10 @@ __declspec(dllexport) void NU_Text(
     float x, float y, float wrapWidth,
     NU_RGB col, const char* string)
 {
-    NU_Internal_Text(contextID, x, y, wrapWidth, col, string);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return;
+    NU_Internal_Text(ctx, x, y, wrapWidth, col, string);
+    NU_Canvas_Done(ctx);
 }
 
 __declspec(dllexport) float NU_Text_Height(
@@ -545,18 +799,30 @@ __declspec(dllexport) float NU_Text_Height(
     float wrapWidth,
     const char* string)
 {
-    return NU_Internal_Text_Height(contextID, wrapWidth, string);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return 0.0f;
+    float height = NU_Internal_Text_Height(ctx, wrapWidth, string);
+    NU_Canvas_Done(ctx);
+    return height;
 }
 
 __declspec(dllexport) float NU_Text_Width(
     int contextID,
     const char* string)
 {
-    return NU_Internal_Text_Width(contextID, string);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return 0.0f;
+    float width = NU_Internal_Text_Width(ctx, string);
+    NU_Canvas_Done(ctx);
+    return width;
 }
 
 __declspec(dllexport) float NU_Text_Line_Height(
     int contextID)
 {
-    return NU_Internal_Text_Line_Height(contextID);
+    NU_Canvas_Context* ctx = NU_Canvas_Use(contextID);
+    if (ctx == NULL) return 0.0f;
+    float height = NU_Internal_Text_Line_Height(ctx);
+    NU_Canvas_Done(ctx);
+    return height;
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+# Builds and runs every tests\*.c as a standalone console program in tests\bin (unity build of
+# src\z_nodus.c, no dll). Run from the repository root, exits non-zero if any test fails
+$srcInclude = "src"
+$sdlLib = "src\libraries\SDL3\lib" 
+$sdlInclude = "src\libraries\SDL3\include"
+$glewInclude = "src\libraries\glew\include"
+$glewLib = "src\libraries\glew\lib"
+$freetypeInclude = "src\libraries\freetype\include"
+$freetypeLib = "src\libraries\freetype\lib"
+New-Item -ItemType Directory -Force -Path "tests\bin" | Out-Null
+$failed = 0
+Get-ChildItem "tests\*.c" | ForEach-Object {
+    clang -std=c99 -O1 -fopenmp $_.FullName `
+    -I"$srcInclude" `
+    -I"$glewInclude" `
+    -I"$sdlInclude" `
+    -I"$freetypeInclude" `
+    -L"$glewLib" `
+    -L"$sdlLib" `
+    -L"$freetypeLib" `
+    -lglew32 -lSDL3 -lopengl32 -lgdi32 -lfreetype -ladvapi32 `
+    -o "tests\bin\$($_.BaseName).exe" -Wno-deprecated-declarations
+    if ($LASTEXITCODE -ne 0) { $failed++; return }
+    & "tests\bin\$($_.BaseName).exe"
+    if ($LASTEXITCODE -ne 0) { $failed++ }
+}
+exit $failed
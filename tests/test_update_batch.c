@@ -0,0 +1,50 @@
+// Restyles deferred by NU_Begin_Update must survive a layout inside the batch: a node restyled,
+// laid out and deleted before NU_End_Update has to leave the pending set, or the end of the
+// update reads the freed node. Runs headless, exits non-zero on failure.
+// Usage (from the repository root): test_update_batch
+#include "z_nodus.c"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what)
+{
+    if (condition) return;
+    fprintf(stderr, "test_update_batch: %s\n", what);
+    failures++;
+}
+
+int main(void)
+{
+    if (!NU_Create_Gui_Headless("tests/assets/update.xml", "tests/assets/update.css", 320, 240)) {
+        fprintf(stderr, "test_update_batch: could not create the gui\n");
+        return 1;
+    }
+    Node* window = NU_Get_Node_By_Id("window");
+    NU_Framebuffer* fb = NU_Create_Framebuffer(320, 240);
+    Check(NU_Render_To_Framebuffer(window, fb) == 1, "first frame failed");
+
+    NU_Begin_Update();
+    Node* target = NU_Get_Node_By_Id("target");
+    NU_Set_Class(target, "b");
+    Check(NODEP_OF(target)->stateFlags & STATE_FLAG_STYLE_PENDING, "restyle not deferred");
+
+    // Mid-batch renders keep the last frame, a layout forced anyway keeps the restyle pending
+    Check(NU_Render_To_Framebuffer(window, fb) == 1, "mid-update render lost the last frame");
+    NU_Layout();
+    Check(NODEP_OF(target)->stateFlags & STATE_FLAG_STYLE_PENDING, "layout cleared the pending restyle");
+
+    // Sweeping the deleted node must take it out of the pending set
+    NU_DELETE_NODE(target);
+    NU_Compact_Nodes();
+    Check(GUI.pendingStyleNodes.itemCount == 0, "deleted node left in the pending restyles");
+    NU_End_Update();
+
+    Check(NU_Get_Node_By_Id("target") == NULL, "deleted node still has its id");
+    window = NU_Get_Node_By_Id("window"); // moved by the compaction
+    Check(NU_Render_To_Framebuffer(window, fb) == 1, "frame after the update failed");
+
+    NU_Free_Framebuffer(fb);
+    NU_Quit();
+    if (failures == 0) printf("test_update_batch: ok\n");
+    return failures == 0 ? 0 : 1;
+}